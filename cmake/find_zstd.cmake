@@ -0,0 +1,18 @@
+# - Find the "zstd" library
+#
+
+find_path ( ZSTD_INCLUDE_DIRS NAMES zstd.h )
+find_library ( ZSTD_LIBRARIES NAMES zstd )
+
+# Handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if all listed variables are TRUE.
+include ( FindPackageHandleStandardArgs )
+find_package_handle_standard_args ( ZSTD DEFAULT_MSG ZSTD_LIBRARIES ZSTD_INCLUDE_DIRS )
+
+if ( ZSTD_FOUND )
+  MESSAGE( STATUS "Zstd includes: ${ZSTD_INCLUDE_DIRS}" )
+  MESSAGE( STATUS "Zstd libraries: ${ZSTD_LIBRARIES}" )
+  get_filename_component( ZSTD_LIBRARY_DIRS ${ZSTD_LIBRARIES} DIRECTORY)
+else ( ZSTD_FOUND )
+  message( STATUS "Zstd library not found" )
+endif ( ZSTD_FOUND )
+
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Splitting of container files (JSON lines files, tar archives) into records processed as documents of their own
+/// \file containerFile.hpp
+#ifndef _STRUS_UTILITIES_CONTAINER_FILE_HPP_INCLUDED
+#define _STRUS_UTILITIES_CONTAINER_FILE_HPP_INCLUDED
+#include "strus/base/stdint.h"
+#include <string>
+#include <vector>
+#include <cstdio>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Type of a container file
+enum ContainerType
+{
+	ContainerNone,		///< not a container, the file is a document of its own
+	ContainerJsonLines,	///< JSON lines file (extension .jsonl or .ndjson), every non empty line is a document
+	ContainerTar		///< tar archive (extension .tar), every regular file in the archive is a document
+};
+
+/// \brief Get the type of a container file by its extension
+/// \param[in] path path of the file
+/// \return the container type or ContainerNone if the file is not a container
+ContainerType containerFileType( const std::string& path);
+
+/// \brief Reference to a record of a container file
+/// \note A record is passed as work item in the form "<path of container>/<offset>+<size>" through the file crawler
+struct ContainerRecord
+{
+	std::string path;	///< path of the container file
+	uint64_t offset;	///< start of the record in bytes
+	uint64_t size;		///< size of the record in bytes
+
+	ContainerRecord()
+		:path(),offset(0),size(0){}
+};
+
+/// \brief Build the work item string referring to a record of a container file
+/// \param[in] path path of the container file
+/// \param[in] offset start of the record in bytes
+/// \param[in] size size of the record in bytes
+/// \return the work item
+std::string containerRecordItem( const std::string& path, uint64_t offset, uint64_t size);
+
+/// \brief Parse a work item referring to a record of a container file
+/// \param[out] record the record parsed
+/// \param[in] item the work item
+/// \return true if the item refers to a record, false if it is the path of a file
+/// \note Only call it for items of a crawler splitting containers: the path of a file "0+10" in a directory named "x.jsonl" has the syntax of a record item too
+bool parseContainerRecordItem( ContainerRecord& record, const std::string& item);
+
+/// \brief Reads the index of the records of a container file incrementally
+class ContainerScanner
+{
+public:
+	/// \brief Constructor, opens the file
+	/// \param[in] path path of the container file
+	/// \param[in] type type of the container
+	/// \note Check error() for success
+	ContainerScanner( const std::string& path, ContainerType type);
+	~ContainerScanner();
+
+	/// \brief Fetch the next records of the container
+	/// \param[out] items where to append the work items referring to the records fetched
+	/// \param[in] maxNofRecords maximum number of records to fetch
+	/// \return false if the end of the container has been reached or on error
+	bool next( std::vector<std::string>& items, std::size_t maxNofRecords);
+
+	/// \brief Path of the container file
+	const std::string& path() const		{return m_path;}
+	/// \brief System error code (errno) of the last operation or 0 on success, EINVAL for a malformed container
+	int error() const			{return m_errno;}
+
+private:
+	ContainerScanner( const ContainerScanner&){}	//... non copyable
+	void operator=( const ContainerScanner&){}	//... non copyable
+
+	bool nextJsonLines( std::vector<std::string>& items, std::size_t maxNofRecords);
+	bool nextTar( std::vector<std::string>& items, std::size_t maxNofRecords);
+
+private:
+	std::string m_path;
+	ContainerType m_type;
+	FILE* m_file;
+	uint64_t m_pos;			///< file position of the next record to read
+	uint64_t m_recordStart;		///< start of the current line (JSON lines)
+	bool m_recordEmpty;		///< true if the current line has no non space characters yet (JSON lines)
+	bool m_eof;
+	int m_errno;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Stream decompressing gzip or zstd compressed input, optionally in a background thread
+/// \file decompressStream.hpp
+#ifndef _STRUS_UTILITIES_DECOMPRESS_STREAM_HPP_INCLUDED
+#define _STRUS_UTILITIES_DECOMPRESS_STREAM_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "strus/base/stdint.h"
+#include "strus/reference.hpp"
+#include <string>
+#include <deque>
+#include <cstdio>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Compression of an input detected by its magic bytes
+enum CompressionType
+{
+	CompressionNone,	///< not compressed
+	CompressionGzip,	///< gzip (RFC 1952), also multiple members concatenated
+	CompressionZstd		///< zstd frames
+};
+
+/// \brief Number of bytes needed to detect the compression of an input
+enum {CompressionMagicSize=4};
+
+/// \brief Detect the compression of an input by its magic bytes
+/// \param[in] hdr first bytes of the input
+/// \param[in] hdrsize number of bytes in hdr
+/// \return the compression type detected
+CompressionType detectCompression( const char* hdr, std::size_t hdrsize);
+
+/// \brief Forward declaration
+class Decoder;
+
+/// \brief Stream reading compressed data from a file and returning the data decompressed
+class DecompressStream
+{
+public:
+	/// \brief Constructor
+	/// \param[in] file file positioned at the start of the compressed data (with ownership)
+	/// \param[in] size size of the compressed data in bytes, the rest of the file if it is smaller
+	/// \param[in] type compression of the data
+	/// \param[in] background true, if the data should be decompressed ahead in a thread of its own overlapping the processing of the data returned
+	/// \note Check error() for success, ENOTSUP if the compression is not supported by this build
+	DecompressStream( FILE* file, uint64_t size, CompressionType type, bool background);
+	~DecompressStream();
+
+	/// \brief Read decompressed data
+	/// \param[out] buf where to write the data read
+	/// \param[in] bufsize maximum number of bytes to read
+	/// \return the number of bytes read, less than bufsize at the end of the data or on error
+	std::size_t read( char* buf, std::size_t bufsize);
+
+	/// \brief System error code (errno) of the last operation or 0 on success, EINVAL for corrupt compressed data
+	int error() const;
+
+private:
+	DecompressStream( const DecompressStream&){}	//... non copyable
+	void operator=( const DecompressStream&){}	//... non copyable
+
+	void decoderThreadMain();
+
+private:
+	enum {BlockSize=1<<16, MaxNofBlocks=8};
+
+	Decoder* m_decoder;
+	std::deque<std::string> m_blocks;		///< blocks decompressed by the background thread and not read yet
+	std::size_t m_blockpos;				///< number of bytes already read of the first block
+	mutable strus::mutex m_mutex;
+	strus::condition_variable m_cond_notEmpty;
+	strus::condition_variable m_cond_notFull;
+	bool m_finished;				///< true, if the background thread has decompressed all data
+	bool m_terminated;				///< true, if the background thread has to stop
+	int m_errno;					///< error of the background thread, reported after the data read before
+	strus::Reference<strus::thread> m_thread;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache of the document classes detected per directory and file extension
+/// \file documentClassCache.hpp
+#ifndef _STRUS_UTILITIES_DOCUMENT_CLASS_CACHE_HPP_INCLUDED
+#define _STRUS_UTILITIES_DOCUMENT_CLASS_CACHE_HPP_INCLUDED
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <map>
+#include <ostream>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Forward declaration
+class TextProcessorInterface;
+/// \brief Forward declaration
+class DocumentClassDetectorInterface;
+/// \brief Forward declaration
+class ProgramOptions;
+
+/// \brief Cache of the document classes detected per directory and file extension, for skipping the detection of files in directories with many files of the same type
+/// \note The class of a directory and extension is used without detection after it has been detected for a number of files in a row.
+///	Every N-th file resolved by the cache is detected nevertheless to validate the cached class. The cache is thread safe.
+/// \remark Usage: if get returns false, detect the document class and report the result with put or invalidate
+class DocumentClassCache
+{
+public:
+	/// \brief Constructor
+	/// \param[in] stableCount_ number of files in a row detected with the same class before the class is taken from the cache
+	/// \param[in] sampleRate_ every sampleRate_-th file resolved by the cache is detected to validate the class cached, 0 for no validation
+	DocumentClassCache( int stableCount_, int sampleRate_);
+
+	/// \brief Get the document class of a file from the cache
+	/// \param[out] dclass the document class cached
+	/// \param[in] filename path of the file
+	/// \return true if the class was taken from the cache, false if the file has to be detected
+	bool get( analyzer::DocumentClass& dclass, const std::string& filename);
+
+	/// \brief Report the document class detected for a file
+	/// \param[in] filename path of the file
+	/// \param[in] dclass the document class detected
+	void put( const std::string& filename, const analyzer::DocumentClass& dclass);
+
+	/// \brief Report a failed detection of the document class of a file
+	/// \param[in] filename path of the file
+	void invalidate( const std::string& filename);
+
+	/// \brief Get the number of files resolved by the cache
+	unsigned int nofHits() const		{return m_nofHits;}
+	/// \brief Get the number of files detected
+	unsigned int nofDetections() const	{return m_nofDetections;}
+
+private:
+	static std::string key( const std::string& filename);
+
+	struct Entry
+	{
+		analyzer::DocumentClass dclass;
+		int count;		///< number of files in a row detected with this class
+		int hits;		///< number of files resolved with this class since it is stable
+
+		Entry()
+			:dclass(),count(0),hits(0){}
+	};
+
+	strus::mutex m_mutex;
+	std::map<std::string,Entry> m_map;
+	int m_stableCount;
+	int m_sampleRate;
+	unsigned int m_nofHits;
+	unsigned int m_nofDetections;
+};
+
+/// \brief Create the document class cache configured with the program options --detectcache and --detectsample
+/// \param[in] opt program options
+/// \return the cache or NULL if option --detectcache is not specified
+/// \note Throws on invalid option values
+DocumentClassCache* createDocumentClassCache( const ProgramOptions& opt);
+
+/// \brief Print the usage of the program options --detectcache and --detectsample
+/// \param[out] out where to print the usage to
+void printDocumentClassCacheUsage( std::ostream& out);
+
+/// \brief Get the document class of a file from the cache
+/// \param[in] cache the cache or NULL if there is no cache
+/// \param[out] dclass the document class cached
+/// \param[in] filename path of the file
+/// \return true if the class was taken from the cache, false if the file has to be detected
+bool getCachedDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename);
+
+/// \brief Detect the document class of a file and report the result to the cache
+/// \param[in] cache the cache or NULL if there is no cache
+/// \param[out] dclass the document class detected
+/// \param[in] filename path of the file
+/// \param[in] textproc text processor detecting the document class
+/// \param[in] content the start of the file content
+/// \param[in] contentsize size of content in bytes
+/// \param[in] isComplete true if content is the whole file
+/// \return true on success, false if the document class could not be detected
+bool detectDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename,
+				const TextProcessorInterface* textproc, const char* content, std::size_t contentsize, bool isComplete);
+
+/// \brief Detect the document class of a file and report the result to the cache
+/// \param[in] cache the cache or NULL if there is no cache
+/// \param[out] dclass the document class detected
+/// \param[in] filename path of the file
+/// \param[in] detector document class detector
+/// \param[in] content the start of the file content
+/// \param[in] contentsize size of content in bytes
+/// \param[in] isComplete true if content is the whole file
+/// \return true on success, false if the document class could not be detected
+bool detectDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename,
+				const DocumentClassDetectorInterface* detector, const char* content, std::size_t contentsize, bool isComplete);
+
+}//namespace
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Input stream for reading a document from a file or from a record of a container file, decompressing gzip or zstd compressed input
+/// \file documentInputStream.hpp
+#ifndef _STRUS_UTILITIES_DOCUMENT_INPUT_STREAM_HPP_INCLUDED
+#define _STRUS_UTILITIES_DOCUMENT_INPUT_STREAM_HPP_INCLUDED
+#include "strus/base/inputStream.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/stdint.h"
+#include "private/containerFile.hpp"
+#include "private/decompressStream.hpp"
+#include <string>
+#include <cstdio>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Input stream with the interface of strus::InputStream for reading a document from a file or from a record of a container file
+/// \note The work items referring to records of container files are built by the container file crawler (see containerFile.hpp)
+/// \note Compressed input is detected by its magic bytes and decompressed transparently, in a background thread if it is big enough to be worth it
+class DocumentInputStream
+{
+public:
+	/// \brief Constructor, opens the file or seeks to the start of the record
+	/// \param[in] item path of the file or work item referring to a record of a container file
+	/// \param[in] containerItems true if the item may refer to a record of a container file (items fetched from a crawler splitting containers), false if it is always the path of a file
+	/// \note Check error() for success
+	DocumentInputStream( const std::string& item, bool containerItems);
+	~DocumentInputStream();
+
+	/// \brief Read data without consuming it
+	/// \param[out] buf where to write the data read
+	/// \param[in] bufsize maximum number of bytes to read
+	/// \return the number of bytes read
+	std::size_t readAhead( char* buf, std::size_t bufsize);
+
+	/// \brief Read data
+	/// \param[out] buf where to write the data read
+	/// \param[in] bufsize maximum number of bytes to read
+	/// \return the number of bytes read, less than bufsize at the end of the document or on error
+	std::size_t read( char* buf, std::size_t bufsize);
+
+	/// \brief System error code (errno) of the last operation or 0 on success
+	int error() const;
+
+private:
+	DocumentInputStream( const DocumentInputStream&){}	//... non copyable
+	void operator=( const DocumentInputStream&){}		//... non copyable
+
+	std::size_t readRecord( char* buf, std::size_t bufsize);
+	std::size_t readSource( char* buf, std::size_t bufsize);
+	void openDecompressStream( uint64_t size, CompressionType compression);
+
+	/// \brief Minimum size of compressed data in bytes for decompressing it in a background thread
+	enum {BackgroundDecompressMinSize=1<<20};
+
+private:
+	strus::local_ptr<strus::InputStream> m_input;	///< input stream if the item is a file
+	FILE* m_file;					///< container file if the item is a record, passed to the decompress stream if compressed
+	strus::local_ptr<DecompressStream> m_decompress;	///< stream decompressing the file or the record if it is compressed
+	uint64_t m_remaining;				///< number of bytes of the record left to read
+	std::string m_ahead;				///< data of the record or decompressed read ahead and not consumed yet
+	int m_errno;
+};
+
+}}//namespace
+#endif
+
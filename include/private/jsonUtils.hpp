@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Helper functions for writing JSON reports
+/// \file jsonUtils.hpp
+#ifndef _STRUS_UTILITIES_JSON_UTILS_HPP_INCLUDED
+#define _STRUS_UTILITIES_JSON_UTILS_HPP_INCLUDED
+#include <string>
+#include <cstdio>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Print a string as quoted JSON string with quotes, backslashes and control characters escaped
+/// \param[in] out file to print to
+/// \param[in] str string to print
+void printJsonString( FILE* out, const std::string& str);
+
+}}//namespace
+#endif
+
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapped file for reading input files without copying them into buffers
+/// \file mappedFile.hpp
+#ifndef _STRUS_UTILITIES_MAPPED_FILE_HPP_INCLUDED
+#define _STRUS_UTILITIES_MAPPED_FILE_HPP_INCLUDED
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Read only view of a whole file mapped into memory, advised for sequential access
+class MappedFile
+{
+public:
+	/// \brief Constructor, maps the file
+	/// \param[in] filename path of the file to map
+	/// \note Check error() for success
+	explicit MappedFile( const std::string& filename);
+	~MappedFile();
+
+	/// \brief Pointer to the contents of the file
+	/// \note May be NULL for an empty file
+	const char* ptr() const		{return m_ptr;}
+	/// \brief Size of the file in bytes
+	std::size_t size() const	{return m_size;}
+	/// \brief System error code (errno) of the last operation or 0 on success
+	int error() const		{return m_errno;}
+
+private:
+	MappedFile( const MappedFile&){}	//... non copyable
+	void operator=( const MappedFile&){}	//... non copyable
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+	int m_errno;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Buffer handing out work items to threads and returning their results in the order of the items
+/// \file orderedResultBuffer.hpp
+#ifndef _STRUS_UTILITIES_ORDERED_RESULT_BUFFER_HPP_INCLUDED
+#define _STRUS_UTILITIES_ORDERED_RESULT_BUFFER_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <map>
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+namespace utils {
+
+/// \brief Hands out the indices of the items to process to the worker threads and returns their results in the order of the items
+/// \note The number of results buffered is bounded, a thread is blocked before fetching an item too far ahead of the result output
+class OrderedResultBuffer
+{
+public:
+	/// \brief Constructor
+	/// \param[in] nofItems_ number of items to process
+	/// \param[in] maxNofPending_ maximum number of items fetched ahead of the next result to output
+	OrderedResultBuffer( std::size_t nofItems_, std::size_t maxNofPending_);
+
+	/// \brief Get the index of the next item to process, wait if too many results are pending
+	/// \param[out] itemidx index of the item
+	/// \return false if there are no items left or the processing has been terminated
+	bool fetch( std::size_t& itemidx);
+
+	/// \brief Push the result of an item
+	/// \param[in] itemidx index of the item as returned by fetch
+	/// \param[in] content the output of the item
+	/// \param[in] error the error message if processing the item failed, empty if it succeeded
+	/// \note Data written by the worker before the push is visible to the thread popping the result
+	void push( std::size_t itemidx, const std::string& content, const std::string& error);
+
+	/// \brief Get the result of the next item in input order, wait till it is available
+	/// \param[out] content the output of the item
+	/// \param[out] error the error message if processing the item failed, empty if it succeeded
+	/// \return false if all results have been returned or the processing has been terminated
+	bool pop( std::string& content, std::string& error);
+
+	/// \brief Stop the processing, wakes up all threads waiting
+	void terminate();
+
+private:
+	struct Result
+	{
+		std::string content;
+		std::string error;
+	};
+	typedef std::map<std::size_t,Result> ResultMap;
+
+	std::size_t m_nofItems;
+	std::size_t m_maxNofPending;
+	std::size_t m_nextFetch;		///< index of the next item to process
+	std::size_t m_nextPop;			///< index of the next result to output
+	ResultMap m_results;			///< results not yet output
+	bool m_terminated;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cond_fetch;
+	strus::condition_variable m_cond_pop;
+};
+
+}}//namespace
+#endif
+
@@ -12,10 +12,12 @@
 #include "strus/analyzer/documentClass.hpp"
 #include "strus/storage/index.hpp"
 #include "strus/base/stdint.h"
+#include "strus/reference.hpp"
 #include <string>
 #include <vector>
 #include <set>
 #include <map>
+#include <cstddef>
 
 /// \brief strus toplevel namespace
 namespace strus {
@@ -32,6 +34,8 @@ class QueryInterface;
 class QueryAnalyzerInstanceInterface;
 /// \brief Forward declaration
 class ErrorBufferInterface;
+/// \brief Forward declaration
+class QueryPlan;
 
 /// \brief Load a query from source (query language)
 /// \param[in,out] query query interface to instrument
@@ -52,6 +56,69 @@ bool loadQuery(
 		const std::string& source,
 		ErrorBufferInterface* errorhnd);
 
+/// \brief Cache of parsed queries (query plans) for loadQuery
+/// \note Thread safe, one cache can be shared by all threads loading queries
+class QueryPlanCacheInterface
+{
+public:
+	virtual ~QueryPlanCacheInterface(){}
+
+	/// \brief Number of queries loaded with a query plan found in the cache
+	virtual unsigned int nofHits() const=0;
+	/// \brief Number of queries loaded with a query plan parsed and inserted into the cache
+	virtual unsigned int nofMisses() const=0;
+	/// \brief Number of queries loaded without the cache, because their source contains elements not handled by it
+	virtual unsigned int nofBypassed() const=0;
+
+	/// \brief Get the indices of the tokens with literal values of sources with a shape
+	/// \param[in] shape key of the shape of a source
+	/// \param[out] slots indices of the tokens with literal values in ascending order
+	/// \return false if the shape is not known
+	virtual bool getLiteralSlots( const std::string& shape, std::vector<int>& slots) const=0;
+
+	/// \brief Get a plan and mark it as most recently used, counts a hit if found
+	/// \param[in] key key of the plan
+	/// \return the plan or an empty reference if not found
+	virtual Reference<QueryPlan> get( const std::string& key)=0;
+
+	/// \brief Insert a plan with the literal slots of its shape, counts a miss
+	/// \param[in] shape key of the shape of the source of the plan
+	/// \param[in] key key of the plan
+	/// \param[in] plan the plan to insert
+	virtual void put( const std::string& shape, const std::string& key, const Reference<QueryPlan>& plan)=0;
+
+	/// \brief Count a query loaded without the cache
+	virtual void bypass()=0;
+};
+
+/// \brief Create a cache of parsed queries for loadQuery
+/// \param[in] maxNofPlans maximum number of query plans kept, the least recently used plan is dropped if the cache is full
+/// \param[in,out] errorhnd buffer for reporting errors (exceptions)
+/// \return the cache (with ownership) or NULL on failure
+QueryPlanCacheInterface* createQueryPlanCache( std::size_t maxNofPlans, ErrorBufferInterface* errorhnd);
+
+/// \brief Load a query from source (query language) with the query plan cached for sources with the same structure
+/// \note Sources with the same structure differ only in the values of query fields and metadata restrictions.
+///	The query plan of a source found in the cache is instantiated with its values without parsing the source.
+/// \param[in,out] query query interface to instrument
+/// \param[in] analyzer program for analyzing text segments in the query
+/// \param[in] selectionFeatureSet default selection feature set
+/// \param[in] weightingFeatureSet default weighting feature set
+/// \param[in] qproc query processor interface for info about objects loaded
+/// \param[in] source source string (not a file name!) to parse
+/// \param[in,out] cache cache of query plans or NULL, if the query should be loaded without
+/// \param[in,out] errorhnd buffer for reporting errors (exceptions)
+/// \return true on success, false on failure
+bool loadQuery(
+		QueryInterface& query,
+		const QueryAnalyzerInstanceInterface* analyzer,
+		const std::string& selectionFeatureSet,
+		const std::string& weightingFeatureSet,
+		const QueryProcessorInterface* qproc,
+		const std::string& source,
+		QueryPlanCacheInterface* cache,
+		ErrorBufferInterface* errorhnd);
+
 /// \brief Scan a source for the next program segment in a source that contains multiple programs.
 ///		The programs are separated by "\r\n.\r\n" or "\n.\n".
 ///		No escaping of this sequence possible.
@@ -17,7 +17,19 @@ class FileCrawlerInterface
 {
 public:
 	virtual ~FileCrawlerInterface(){}
+
+	/// \brief Fetch the next chunk of files to process
+	/// \return the list of files or an empty list if there is nothing left to process
 	virtual std::vector<std::string> fetch()=0;
+
+	/// \brief Fetch the next chunk of files to process for a specific worker
+	/// \param[in] worker index of the worker thread fetching (starting with 0), used by crawlers scheduling chunks to workers
+	/// \return the list of files or an empty list if there is nothing left to process
+	/// \note The default implementation ignores the worker and calls fetch()
+	virtual std::vector<std::string> fetch( int)
+	{
+		return fetch();
+	}
 };
 
 }//namespace
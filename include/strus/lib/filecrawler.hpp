@@ -9,8 +9,10 @@
 /// \file filecrawler.hpp
 #ifndef _STRUS_UTILITIES_LIB_FILECRAWLER_HPP_INCLUDED
 #define _STRUS_UTILITIES_LIB_FILECRAWLER_HPP_INCLUDED
+#include "strus/base/stdint.h"
 #include <string>
 #include <vector>
+#include <set>
 
 /// \brief strus toplevel namespace
 namespace strus
@@ -38,6 +40,50 @@ FileCrawlerInterface* createFileCrawlerInterface( const std::string& path, int c
 /// \return the file crawler interface (with ownership)
 FileCrawlerInterface* createFileCrawlerInterface( const std::vector<std::string>& path, int chunkSize, const std::string& extension, ErrorBufferInterface* errorhnd);
 
+/// \brief Create an interface for loading files in chunks balanced by size, scheduled to per worker queues with work stealing
+/// \param[in] path path where to load files from
+/// \param[in] chunkSize maximum number of files per chunk loaded
+/// \param[in] chunkBytes maximum total size in bytes of the files in a chunk, 0 for no limit
+/// \param[in] nofWorkers number of workers fetching chunks with their index (FileCrawlerInterface::fetch(int))
+/// \param[in] extension extension of the files to load, empty if no restriction on the extension given
+/// \param[in] errorhnd error buffer interface for exceptions thrown
+/// \return the file crawler interface (with ownership)
+/// \note The files are not processed in the order they are found
+FileCrawlerInterface* createFileCrawlerInterface_workstealing( const std::vector<std::string>& path, int chunkSize, uint64_t chunkBytes, int nofWorkers, const std::string& extension, ErrorBufferInterface* errorhnd);
+
+/// \brief Create an interface for loading files in chunks, reading the directories in a background thread while the chunks are processed
+/// \param[in] path path where to load files from
+/// \param[in] chunkSize maximum number of files per chunk loaded
+/// \param[in] maxNofChunks maximum number of chunks buffered (lookahead of the directory reader)
+/// \param[in] extension extension of the files to load, empty if no restriction on the extension given
+/// \param[in] errorhnd error buffer interface for exceptions thrown
+/// \return the file crawler interface (with ownership)
+FileCrawlerInterface* createFileCrawlerInterface_streaming( const std::vector<std::string>& path, int chunkSize, int maxNofChunks, const std::string& extension, ErrorBufferInterface* errorhnd);
+
+/// \brief Create an interface for loading files in chunks from another file crawler, skipping the files of a set
+/// \param[in] crawler file crawler to fetch the chunks from (with ownership, also in case of an error)
+/// \param[in] skipFiles set of files to skip, e.g. the files already processed by a run interrupted
+/// \param[in] errorhnd error buffer interface for exceptions thrown
+/// \return the file crawler interface (with ownership)
+FileCrawlerInterface* createFileCrawlerInterface_skip( FileCrawlerInterface* crawler, const std::set<std::string>& skipFiles, ErrorBufferInterface* errorhnd);
+
+/// \brief Create an interface for loading files in chunks from another file crawler, splitting container files into chunks of records processed as documents of their own
+/// \param[in] crawler file crawler to fetch the chunks from (with ownership, also in case of an error)
+/// \param[in] chunkSize maximum number of records per chunk
+/// \param[in] errorhnd error buffer interface for exceptions thrown
+/// \return the file crawler interface (with ownership)
+/// \note Containers are JSON lines files (extension .jsonl or .ndjson) and tar archives (extension .tar). The records are passed as work items "<container path>/<offset>+<size>" to read with the document input stream of the utilities
+FileCrawlerInterface* createFileCrawlerInterface_container( FileCrawlerInterface* crawler, int chunkSize, ErrorBufferInterface* errorhnd);
+
+/// \brief Create an interface for loading a deterministic random sample of the files of another file crawler, stratified over its chunks
+/// \param[in] crawler file crawler to fetch the chunks from (with ownership, also in case of an error)
+/// \param[in] rootpath path crawled by 'crawler', the selection depends only on the file paths relative to it
+/// \param[in] rate fraction of the files to select from every chunk (0.0 < rate <= 1.0), a fractional part of the number of files to select is rounded up with its probability
+/// \param[in] seed seed of the selection, the same seed selects the same files for the same chunks
+/// \param[in] errorhnd error buffer interface for exceptions thrown
+/// \return the file crawler interface (with ownership)
+FileCrawlerInterface* createFileCrawlerInterface_sample( FileCrawlerInterface* crawler, const std::string& rootpath, double rate, unsigned int seed, ErrorBufferInterface* errorhnd);
+
 }//namespace
 #endif
 
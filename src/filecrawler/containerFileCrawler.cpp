@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "containerFileCrawler.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+#include <cstring>
+
+using namespace strus;
+
+ContainerFileCrawler::ContainerFileCrawler(
+		FileCrawlerInterface* crawler_,
+		std::size_t chunkSize_,
+		ErrorBufferInterface* errorhnd_)
+	:m_errorhnd(errorhnd_)
+	,m_chunkSize(chunkSize_ ? chunkSize_ : 1)
+	,m_containers()
+	,m_scanner()
+	,m_nofFetching(0)
+	,m_eof(false)
+	,m_crawler(crawler_)
+{}
+
+bool ContainerFileCrawler::nextRecords( std::vector<std::string>& items)
+{
+	while (items.empty())
+	{
+		if (!m_scanner.get())
+		{
+			if (m_containers.empty()) return false;
+			std::string path;
+			path.swap( m_containers.front());
+			m_containers.pop_front();
+			m_scanner.reset( new utils::ContainerScanner( path, utils::containerFileType( path)));
+		}
+		if (!m_scanner->next( items, m_chunkSize))
+		{
+			if (m_scanner->error())
+			{
+				// A broken container is reported and skipped like an unreadable directory of the crawler:
+				std::cerr << string_format( _TXT( "failed to read records of container file '%s': %s"), m_scanner->path().c_str(), ::strerror( m_scanner->error())) << std::endl;
+				std::cerr.flush();
+			}
+			m_scanner.reset();
+		}
+	}
+	return true;
+}
+
+std::vector<std::string> ContainerFileCrawler::fetchItems( int worker)
+{
+	std::vector<std::string> rt;
+	strus::unique_lock lock( m_mutex);
+	for (;;)
+	{
+		if (nextRecords( rt)) return rt;
+		if (m_eof)
+		{
+			// Other workers may still get containers from the wrapped crawler,
+			// so we have to wait for them before we signal the end of the input:
+			if (m_nofFetching == 0) return rt;
+			m_cond_fetched.wait( lock);
+			continue;
+		}
+		++m_nofFetching;
+		lock.unlock();
+		std::vector<std::string> files;
+		try
+		{
+			files = worker < 0 ? m_crawler->fetch() : m_crawler->fetch( worker);
+		}
+		catch (...)
+		{
+			lock.lock();
+			--m_nofFetching;
+			m_cond_fetched.notify_all();
+			throw;
+		}
+		lock.lock();
+		--m_nofFetching;
+		if (files.empty())
+		{
+			m_eof = true;
+		}
+		else
+		{
+			// Pass the plain files as they are and queue the containers to split:
+			std::vector<std::string>::iterator fi = files.begin(), fe = files.end();
+			for (; fi != fe; ++fi)
+			{
+				if (utils::containerFileType( *fi) == utils::ContainerNone)
+				{
+					rt.push_back( std::string());
+					rt.back().swap( *fi);
+				}
+				else
+				{
+					m_containers.push_back( std::string());
+					m_containers.back().swap( *fi);
+				}
+			}
+		}
+		m_cond_fetched.notify_all();
+		if (!rt.empty()) return rt;
+	}
+}
+
+std::vector<std::string> ContainerFileCrawler::fetch()
+{
+	try
+	{
+		return fetchItems( -1);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+std::vector<std::string> ContainerFileCrawler::fetch( int worker)
+{
+	try
+	{
+		return fetchItems( worker);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
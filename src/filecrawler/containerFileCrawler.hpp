@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_CONTAINER_FILE_CRAWLER_HPP_INCLUDED
+#define _STRUS_INSERTER_CONTAINER_FILE_CRAWLER_HPP_INCLUDED
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileCrawlerInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/thread.hpp"
+#include "private/containerFile.hpp"
+#include <vector>
+#include <string>
+#include <deque>
+
+namespace strus {
+
+/// \brief File crawler passing the chunks of another crawler with the container files (JSON lines files, tar archives) split into chunks of records
+/// \note The records of a container are distributed over all workers fetching. They are passed as work items referring to the container file and a range of bytes, read with utils::DocumentInputStream
+class ContainerFileCrawler
+	:public FileCrawlerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] crawler_ crawler to fetch the chunks from (with ownership)
+	/// \param[in] chunkSize_ maximum number of records per chunk
+	/// \param[in] errorhnd_ error buffer interface
+	ContainerFileCrawler(
+			FileCrawlerInterface* crawler_,
+			std::size_t chunkSize_,
+			ErrorBufferInterface* errorhnd_);
+
+	virtual ~ContainerFileCrawler(){}
+
+	virtual std::vector<std::string> fetch();
+	virtual std::vector<std::string> fetch( int worker);
+
+private:
+	bool nextRecords( std::vector<std::string>& items);
+	std::vector<std::string> fetchItems( int worker);
+
+private:
+	ErrorBufferInterface* m_errorhnd;
+	std::size_t m_chunkSize;
+	std::deque<std::string> m_containers;			///< container files waiting to be split
+	strus::local_ptr<utils::ContainerScanner> m_scanner;	///< scanner of the container file currently split
+	strus::mutex m_mutex;
+	strus::condition_variable m_cond_fetched;		///< signaled when a fetch of the wrapped crawler has been completed
+	int m_nofFetching;					///< number of fetches of the wrapped crawler in progress
+	bool m_eof;						///< true, if the wrapped crawler has no more files
+	strus::local_ptr<FileCrawlerInterface> m_crawler;	///< declared last, so that it takes ownership only if nothing else can throw
+};
+
+}//namespace
+#endif
+
@@ -9,6 +9,11 @@
 #include "strus/lib/filecrawler.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "fileCrawler.hpp"
+#include "workStealingFileCrawler.hpp"
+#include "streamingFileCrawler.hpp"
+#include "skipFileCrawler.hpp"
+#include "containerFileCrawler.hpp"
+#include "sampleFileCrawler.hpp"
 #include "private/internationalization.hpp"
 #include "strus/base/dll_tags.hpp"
 #include "private/errorUtils.hpp"
@@ -45,3 +50,83 @@ DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface( const std::v
 	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
 }
 
+DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface_workstealing( const std::vector<std::string>& path, int chunkSize, uint64_t chunkBytes, int nofWorkers, const std::string& extension, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		if (!g_intl_initialized)
+		{
+			strus::initMessageTextDomain();
+			g_intl_initialized = true;
+		}
+		return new WorkStealingFileCrawler( path, chunkSize, chunkBytes, nofWorkers, extension, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
+}
+
+DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface_streaming( const std::vector<std::string>& path, int chunkSize, int maxNofChunks, const std::string& extension, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		if (!g_intl_initialized)
+		{
+			strus::initMessageTextDomain();
+			g_intl_initialized = true;
+		}
+		return new StreamingFileCrawler( path, chunkSize, maxNofChunks, extension, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
+}
+
+
+DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface_skip( FileCrawlerInterface* crawler, const std::set<std::string>& skipFiles, ErrorBufferInterface* errorhnd)
+{
+	strus::local_ptr<FileCrawlerInterface> crawlerref( crawler);
+	try
+	{
+		if (!g_intl_initialized)
+		{
+			strus::initMessageTextDomain();
+			g_intl_initialized = true;
+		}
+		FileCrawlerInterface* rt = new SkipFileCrawler( crawler, skipFiles, errorhnd);
+		crawlerref.release();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
+}
+
+DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface_container( FileCrawlerInterface* crawler, int chunkSize, ErrorBufferInterface* errorhnd)
+{
+	strus::local_ptr<FileCrawlerInterface> crawlerref( crawler);
+	try
+	{
+		if (!g_intl_initialized)
+		{
+			strus::initMessageTextDomain();
+			g_intl_initialized = true;
+		}
+		FileCrawlerInterface* rt = new ContainerFileCrawler( crawler, chunkSize, errorhnd);
+		crawlerref.release();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
+}
+
+DLL_PUBLIC FileCrawlerInterface* strus::createFileCrawlerInterface_sample( FileCrawlerInterface* crawler, const std::string& rootpath, double rate, unsigned int seed, ErrorBufferInterface* errorhnd)
+{
+	strus::local_ptr<FileCrawlerInterface> crawlerref( crawler);
+	try
+	{
+		if (!g_intl_initialized)
+		{
+			strus::initMessageTextDomain();
+			g_intl_initialized = true;
+		}
+		if (rate <= 0.0 || rate > 1.0) throw std::runtime_error( _TXT("sample rate must be greater than 0.0 and not greater than 1.0"));
+		FileCrawlerInterface* rt = new SampleFileCrawler( crawler, rootpath, rate, seed, errorhnd);
+		crawlerref.release();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("cannot create file crawler: %s"), *errorhnd, 0);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "sampleFileCrawler.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include <algorithm>
+#include <utility>
+
+using namespace strus;
+
+SampleFileCrawler::SampleFileCrawler(
+		FileCrawlerInterface* crawler_,
+		const std::string& rootpath_,
+		double rate_,
+		unsigned int seed_,
+		ErrorBufferInterface* errorhnd_)
+	:m_errorhnd(errorhnd_)
+	,m_rootpath(rootpath_)
+	,m_rate(rate_)
+	,m_seed(seed_)
+	,m_crawler(crawler_)
+{}
+
+std::size_t SampleFileCrawler::relativePathStart( const std::string& item) const
+{
+	std::size_t rootsize = m_rootpath.size();
+	if (rootsize == 0 || item.size() < rootsize || 0!=item.compare( 0, rootsize, m_rootpath)) return 0;
+	if (item.size() > rootsize && item[ rootsize] != '/' && m_rootpath[ rootsize-1] != '/') return 0;
+	while (rootsize < item.size() && item[ rootsize] == '/') ++rootsize;
+	return rootsize;
+}
+
+uint64_t SampleFileCrawler::hash( const std::string& item) const
+{
+	// FNV-1a of the item relative to the root path started with the seed, followed by the finalizer of splitmix64 for mixing the bits:
+	uint64_t hh = 14695981039346656037ULL ^ ((uint64_t)m_seed * 0x9E3779B97F4A7C15ULL);
+	std::string::const_iterator ci = item.begin() + relativePathStart( item), ce = item.end();
+	for (; ci != ce; ++ci)
+	{
+		hh ^= (unsigned char)*ci;
+		hh *= 1099511628211ULL;
+	}
+	hh ^= hh >> 30;
+	hh *= 0xBF58476D1CE4E5B9ULL;
+	hh ^= hh >> 27;
+	hh *= 0x94D049BB133111EBULL;
+	hh ^= hh >> 31;
+	return hh;
+}
+
+void SampleFileCrawler::select( std::vector<std::string>& files) const
+{
+	if (files.empty()) return;
+
+	// Evaluate the number of files to select from this chunk, the fraction is rounded up with its probability
+	// decided by a hash value independent from the ones used for the selection:
+	double expected = m_rate * files.size();
+	std::size_t nofSelected = (std::size_t)expected;
+	double fraction = expected - nofSelected;
+	if (fraction > 0.0)
+	{
+		std::string chunkkey( files[0]);
+		chunkkey.push_back( '\0');
+		if ((double)(hash( chunkkey) >> 11) / (double)((uint64_t)1 << 53) < fraction)
+		{
+			++nofSelected;
+		}
+	}
+	if (nofSelected >= files.size()) return;
+
+	// Select the files with the smallest hash values, keeping the order of the files in the chunk:
+	std::vector<std::pair<uint64_t,std::size_t> > ranks;
+	ranks.reserve( files.size());
+	std::vector<std::string>::const_iterator fi = files.begin(), fe = files.end();
+	for (std::size_t fidx=0; fi != fe; ++fi,++fidx)
+	{
+		ranks.push_back( std::pair<uint64_t,std::size_t>( hash( *fi), fidx));
+	}
+	std::vector<bool> selected( files.size(), false);
+	if (nofSelected)
+	{
+		std::nth_element( ranks.begin(), ranks.begin() + (nofSelected-1), ranks.end());
+		std::vector<std::pair<uint64_t,std::size_t> >::const_iterator ri = ranks.begin(), re = ranks.begin() + nofSelected;
+		for (; ri != re; ++ri) selected[ ri->second] = true;
+	}
+	std::vector<std::string>::iterator ri = files.begin(), wi = files.begin(), re = files.end();
+	for (std::size_t fidx=0; ri != re; ++ri,++fidx)
+	{
+		if (selected[ fidx])
+		{
+			if (wi != ri) wi->swap( *ri);
+			++wi;
+		}
+	}
+	files.erase( wi, files.end());
+}
+
+std::vector<std::string> SampleFileCrawler::fetch()
+{
+	try
+	{
+		// Continue with the next chunk if no file of a chunk is selected,
+		// because an empty chunk signals the end of the files to process:
+		std::vector<std::string> rt;
+		do
+		{
+			rt = m_crawler->fetch();
+			if (rt.empty()) break;
+			select( rt);
+		}
+		while (rt.empty());
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+std::vector<std::string> SampleFileCrawler::fetch( int worker)
+{
+	try
+	{
+		std::vector<std::string> rt;
+		do
+		{
+			rt = m_crawler->fetch( worker);
+			if (rt.empty()) break;
+			select( rt);
+		}
+		while (rt.empty());
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_SAMPLE_FILE_CRAWLER_HPP_INCLUDED
+#define _STRUS_INSERTER_SAMPLE_FILE_CRAWLER_HPP_INCLUDED
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileCrawlerInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/stdint.h"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief File crawler passing a deterministic random sample of the files of the chunks of another crawler
+/// \note The sample is stratified over the chunks: every chunk contributes its share of files, selected by a hash of the seed and the file path relative to the root path crawled
+class SampleFileCrawler
+	:public FileCrawlerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] crawler_ crawler to fetch the chunks from (with ownership)
+	/// \param[in] rootpath_ path crawled, stripped from the file paths for the selection, so that the sample does not depend on the location of the files
+	/// \param[in] rate_ fraction of files to select (0.0 < rate_ <= 1.0)
+	/// \param[in] seed_ seed of the selection, the same seed selects the same files for the same chunks
+	/// \param[in] errorhnd_ error buffer interface
+	SampleFileCrawler(
+			FileCrawlerInterface* crawler_,
+			const std::string& rootpath_,
+			double rate_,
+			unsigned int seed_,
+			ErrorBufferInterface* errorhnd_);
+
+	virtual ~SampleFileCrawler(){}
+
+	virtual std::vector<std::string> fetch();
+	virtual std::vector<std::string> fetch( int worker);
+
+private:
+	void select( std::vector<std::string>& files) const;
+	std::size_t relativePathStart( const std::string& item) const;
+	uint64_t hash( const std::string& item) const;
+
+private:
+	ErrorBufferInterface* m_errorhnd;
+	std::string m_rootpath;
+	double m_rate;
+	unsigned int m_seed;
+	strus::local_ptr<FileCrawlerInterface> m_crawler;	///< declared last, so that it takes ownership only if nothing else can throw
+};
+
+}//namespace
+#endif
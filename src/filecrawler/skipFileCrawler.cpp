@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "skipFileCrawler.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+
+using namespace strus;
+
+SkipFileCrawler::SkipFileCrawler(
+		FileCrawlerInterface* crawler_,
+		const std::set<std::string>& skipFiles_,
+		ErrorBufferInterface* errorhnd_)
+	:m_errorhnd(errorhnd_)
+	,m_skipFiles(skipFiles_)
+	,m_crawler(crawler_)
+{}
+
+void SkipFileCrawler::filter( std::vector<std::string>& files) const
+{
+	std::vector<std::string>::iterator ri = files.begin(), wi = files.begin(), re = files.end();
+	for (; ri != re; ++ri)
+	{
+		if (m_skipFiles.find( *ri) == m_skipFiles.end())
+		{
+			if (wi != ri) wi->swap( *ri);
+			++wi;
+		}
+	}
+	files.erase( wi, files.end());
+}
+
+std::vector<std::string> SkipFileCrawler::fetch()
+{
+	try
+	{
+		// Continue with the next chunk if all files of a chunk are skipped,
+		// because an empty chunk signals the end of the files to process:
+		std::vector<std::string> rt;
+		do
+		{
+			rt = m_crawler->fetch();
+			if (rt.empty()) break;
+			filter( rt);
+		}
+		while (rt.empty());
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+std::vector<std::string> SkipFileCrawler::fetch( int worker)
+{
+	try
+	{
+		std::vector<std::string> rt;
+		do
+		{
+			rt = m_crawler->fetch( worker);
+			if (rt.empty()) break;
+			filter( rt);
+		}
+		while (rt.empty());
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
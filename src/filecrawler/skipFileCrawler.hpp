@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_SKIP_FILE_CRAWLER_HPP_INCLUDED
+#define _STRUS_INSERTER_SKIP_FILE_CRAWLER_HPP_INCLUDED
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileCrawlerInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include <vector>
+#include <string>
+#include <set>
+
+namespace strus {
+
+/// \brief File crawler passing the chunks of another crawler without the files of a set to skip (e.g. the files already processed by a run interrupted)
+class SkipFileCrawler
+	:public FileCrawlerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] crawler_ crawler to fetch the chunks from (with ownership)
+	/// \param[in] skipFiles_ set of files to skip
+	/// \param[in] errorhnd_ error buffer interface
+	SkipFileCrawler(
+			FileCrawlerInterface* crawler_,
+			const std::set<std::string>& skipFiles_,
+			ErrorBufferInterface* errorhnd_);
+
+	virtual ~SkipFileCrawler(){}
+
+	virtual std::vector<std::string> fetch();
+	virtual std::vector<std::string> fetch( int worker);
+
+private:
+	void filter( std::vector<std::string>& files) const;
+
+private:
+	ErrorBufferInterface* m_errorhnd;
+	std::set<std::string> m_skipFiles;
+	strus::local_ptr<FileCrawlerInterface> m_crawler;	///< declared last, so that it takes ownership only if nothing else can throw
+};
+
+}//namespace
+#endif
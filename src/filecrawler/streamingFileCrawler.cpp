@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "streamingFileCrawler.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+
+using namespace strus;
+
+StreamingFileCrawler::StreamingFileCrawler(
+		const std::vector<std::string>& path_,
+		std::size_t chunkSize_,
+		std::size_t maxNofChunks_,
+		const std::string& extension_,
+		ErrorBufferInterface* errorhnd_)
+
+	:m_errorhnd(errorhnd_)
+	,m_path(path_)
+	,m_chunkSize(chunkSize_ ? chunkSize_ : 1)
+	,m_maxNofChunks(maxNofChunks_ ? maxNofChunks_ : 1)
+	,m_extension(extension_)
+	,m_chunk()
+	,m_chunkque()
+	,m_finished(false)
+	,m_terminated(false)
+	,m_error()
+	,m_thread()
+{
+	m_thread.reset( new strus::thread( &StreamingFileCrawler::crawlerThreadMain, this));
+}
+
+StreamingFileCrawler::~StreamingFileCrawler()
+{
+	{
+		strus::scoped_lock lock( m_chunkque_mutex);
+		m_terminated = true;
+	}
+	m_cond_notFull.notify_all();
+	m_thread->join();
+}
+
+void StreamingFileCrawler::crawlerThreadMain()
+{
+	try
+	{
+		std::vector<std::string>::const_iterator pi = m_path.begin(), pe = m_path.end();
+		for (; pi != pe; ++pi)
+		{
+			if (strus::isDir( *pi))
+			{
+				crawlDirectory( *pi);
+			}
+			else
+			{
+				addFile( *pi);
+			}
+		}
+		flushChunk();
+	}
+	catch (const std::bad_alloc&)
+	{
+		strus::scoped_lock lock( m_chunkque_mutex);
+		m_error = _TXT("memory allocation error collecting files to process");
+	}
+	catch (const std::exception& err)
+	{
+		strus::scoped_lock lock( m_chunkque_mutex);
+		m_error = string_format( _TXT("error collecting files to process: %s"), err.what());
+	}
+	{
+		strus::scoped_lock lock( m_chunkque_mutex);
+		m_finished = true;
+	}
+	m_cond_notEmpty.notify_all();
+}
+
+void StreamingFileCrawler::crawlDirectory( const std::string& dir)
+{
+	// Depth first traversal with an explicit stack of directories to visit,
+	// the files of a directory are passed before its subdirectories are read:
+	std::vector<std::string> dirstack;
+	dirstack.push_back( dir);
+	while (!dirstack.empty())
+	{
+		std::string curdir;
+		curdir.swap( dirstack.back());
+		dirstack.pop_back();
+
+		std::vector<std::string> files;
+		unsigned int ec = strus::readDirFiles( curdir, m_extension, files);
+		if (ec)
+		{
+			std::cerr << string_format( _TXT( "could not read directory to process '%s' (errno %u)"), curdir.c_str(), ec) << std::endl;
+			std::cerr.flush();
+			continue;
+		}
+		std::vector<std::string>::const_iterator fi = files.begin(), fe = files.end();
+		for (; fi != fe; ++fi)
+		{
+			std::string fullpath = strus::joinFilePath( curdir, *fi);
+			if (fullpath.empty()) throw std::bad_alloc();
+			addFile( fullpath);
+		}
+		std::vector<std::string> subdirs;
+		ec = strus::readDirSubDirs( curdir, subdirs);
+		if (ec)
+		{
+			std::cerr << string_format( _TXT( "could not read subdirectories to process '%s' (errno %u)"), curdir.c_str(), ec) << std::endl;
+			std::cerr.flush();
+			continue;
+		}
+		// Push in reverse order to visit the subdirectories in the order they were read:
+		std::vector<std::string>::const_reverse_iterator di = subdirs.rbegin(), de = subdirs.rend();
+		for (; di != de; ++di)
+		{
+			std::string subdir = strus::joinFilePath( curdir, *di);
+			if (strus::isDir( subdir))
+			{
+				dirstack.push_back( subdir);
+			}
+		}
+	}
+}
+
+void StreamingFileCrawler::addFile( const std::string& path)
+{
+	m_chunk.push_back( path);
+	if (m_chunk.size() >= m_chunkSize)
+	{
+		flushChunk();
+	}
+}
+
+void StreamingFileCrawler::flushChunk()
+{
+	if (!m_chunk.empty())
+	{
+		pushChunk( m_chunk);
+		m_chunk.clear();
+	}
+}
+
+void StreamingFileCrawler::pushChunk( std::vector<std::string>& files)
+{
+	{
+		strus::unique_lock lock( m_chunkque_mutex);
+		while (m_chunkque.size() >= m_maxNofChunks && !m_terminated)
+		{
+			m_cond_notFull.wait( lock);
+		}
+		if (m_terminated) throw std::runtime_error( _TXT("file crawler terminated"));
+		m_chunkque.push_back( std::vector<std::string>());
+		m_chunkque.back().swap( files);
+	}
+	m_cond_notEmpty.notify_one();
+}
+
+std::vector<std::string> StreamingFileCrawler::fetch()
+{
+	try
+	{
+		std::vector<std::string> rt;
+		{
+			strus::unique_lock lock( m_chunkque_mutex);
+			while (m_chunkque.empty() && !m_finished)
+			{
+				m_cond_notEmpty.wait( lock);
+			}
+			if (m_chunkque.empty())
+			{
+				if (!m_error.empty())
+				{
+					std::string errmsg;
+					errmsg.swap( m_error);
+					throw std::runtime_error( errmsg);
+					//... the error of the crawler thread is reported once in the context of the thread fetching
+				}
+				return rt;
+			}
+			rt.swap( m_chunkque.front());
+			m_chunkque.pop_front();
+		}
+		m_cond_notFull.notify_one();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
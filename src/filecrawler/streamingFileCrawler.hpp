@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_STREAMING_FILE_CRAWLER_HPP_INCLUDED
+#define _STRUS_INSERTER_STREAMING_FILE_CRAWLER_HPP_INCLUDED
+#include "strus/base/fileio.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileCrawlerInterface.hpp"
+#include "strus/reference.hpp"
+#include <vector>
+#include <string>
+#include <deque>
+
+namespace strus {
+
+/// \brief File crawler reading the directories in a background thread and passing the chunks of files found through a bounded queue
+/// \note Processing starts as soon as the first chunk is available and the memory used does not depend on the number of files to process
+class StreamingFileCrawler
+	:public FileCrawlerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] path_ list of files or directories to process
+	/// \param[in] chunkSize_ maximum number of files per chunk
+	/// \param[in] maxNofChunks_ maximum number of chunks buffered before the crawler thread waits for the chunks to be fetched
+	/// \param[in] extension_ extension of the files to process, empty for all files
+	/// \param[in] errorhnd_ error buffer interface
+	StreamingFileCrawler(
+			const std::vector<std::string>& path_,
+			std::size_t chunkSize_,
+			std::size_t maxNofChunks_,
+			const std::string& extension_,
+			ErrorBufferInterface* errorhnd_);
+
+	virtual ~StreamingFileCrawler();
+
+	virtual std::vector<std::string> fetch();
+
+private:
+	void crawlerThreadMain();
+	void crawlDirectory( const std::string& dir);
+	void addFile( const std::string& path);
+	void flushChunk();
+	void pushChunk( std::vector<std::string>& files);
+
+private:
+	ErrorBufferInterface* m_errorhnd;
+	std::vector<std::string> m_path;
+	std::size_t m_chunkSize;
+	std::size_t m_maxNofChunks;
+	std::string m_extension;
+
+	std::vector<std::string> m_chunk;			///< chunk currently built by the crawler thread
+	std::deque<std::vector<std::string> > m_chunkque;	///< chunks ready to be fetched
+	strus::mutex m_chunkque_mutex;
+	strus::condition_variable m_cond_notEmpty;
+	strus::condition_variable m_cond_notFull;
+	bool m_finished;					///< true, if the crawler thread has finished
+	bool m_terminated;					///< true, if the crawler thread has to stop
+	std::string m_error;					///< error of the crawler thread, reported by the next fetch
+	strus::Reference<strus::thread> m_thread;
+};
+
+}//namespace
+#endif
+
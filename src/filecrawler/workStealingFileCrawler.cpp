@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "workStealingFileCrawler.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+using namespace strus;
+
+WorkStealingFileCrawler::WorkStealingFileCrawler(
+		const std::vector<std::string>& path_,
+		std::size_t chunkSize_,
+		uint64_t chunkBytes_,
+		int nofWorkers_,
+		const std::string& extension_,
+		ErrorBufferInterface* errorhnd_)
+
+	:m_errorhnd(errorhnd_)
+	,m_chunkSize(chunkSize_ ? chunkSize_ : 1)
+	,m_chunkBytes(chunkBytes_)
+	,m_extension(extension_)
+	,m_chunks()
+	,m_workerQueues()
+{
+	int wi = 0, we = nofWorkers_ > 0 ? nofWorkers_ : 1;
+	for (; wi != we; ++wi)
+	{
+		m_workerQueues.push_back( new WorkerQueue());
+	}
+	m_chunks.push_back( Chunk());
+	std::vector<std::string>::const_iterator pi = path_.begin(), pe = path_.end();
+	for (; pi != pe; ++pi)
+	{
+		if (strus::isDir( *pi))
+		{
+			collectFilesToProcess( *pi);
+		}
+		else
+		{
+			addFile( *pi);
+		}
+	}
+	distributeChunks();
+}
+
+WorkStealingFileCrawler::~WorkStealingFileCrawler()
+{
+}
+
+void WorkStealingFileCrawler::addFile( const std::string& path)
+{
+	uint64_t filesize = 0;
+	struct stat st;
+	if (0==::stat( path.c_str(), &st))
+	{
+		filesize = st.st_size;
+	}
+	// ... files we cannot stat are counted with size 0, errors are reported when they are read
+	Chunk* chunk = &m_chunks.back();
+	if (!chunk->files.empty()
+		&& (chunk->files.size() >= m_chunkSize
+			|| (m_chunkBytes && chunk->bytes + filesize > m_chunkBytes)))
+	{
+		m_chunks.push_back( Chunk());
+		chunk = &m_chunks.back();
+	}
+	chunk->files.push_back( path);
+	chunk->bytes += filesize;
+}
+
+void WorkStealingFileCrawler::collectFilesToProcess( const std::string& dir)
+{
+	try
+	{
+		std::vector<std::string> files;
+		unsigned int ec = strus::readDirFiles( dir, m_extension, files);
+		if (ec)
+		{
+			std::cerr << string_format( _TXT( "could not read directory to process '%s' (errno %u)"), dir.c_str(), ec) << std::endl;
+			std::cerr.flush();
+		}
+		else
+		{
+			std::vector<std::string>::const_iterator fi = files.begin(), fe = files.end();
+			for (; fi != fe; ++fi)
+			{
+				std::string fullpath = strus::joinFilePath( dir, *fi);
+				if (fullpath.empty()) throw std::bad_alloc();
+				addFile( fullpath);
+			}
+			std::vector<std::string> subdirs;
+			ec = strus::readDirSubDirs( dir, subdirs);
+			if (ec)
+			{
+				std::cerr << string_format( _TXT( "could not read subdirectories to process '%s' (errno %u)"), dir.c_str(), ec) << std::endl;
+				std::cerr.flush();
+			}
+			else
+			{
+				std::vector<std::string>::const_iterator di = subdirs.begin(), de = subdirs.end();
+				for (; di != de; ++di)
+				{
+					std::string subdir = strus::joinFilePath( dir, *di);
+					if (strus::isDir( subdir))
+					{
+						collectFilesToProcess( subdir);
+					}
+				}
+			}
+		}
+	}
+	CATCH_ERROR_MAP( _TXT("error collecting files to process: %s"), *m_errorhnd);
+}
+
+namespace {
+struct ChunkRef
+{
+	std::size_t idx;
+	uint64_t bytes;
+
+	ChunkRef( std::size_t idx_, uint64_t bytes_)
+		:idx(idx_),bytes(bytes_){}
+	ChunkRef( const ChunkRef& o)
+		:idx(o.idx),bytes(o.bytes){}
+
+	bool operator < (const ChunkRef& o) const
+	{
+		// ... descending order of size, stable for equal sizes
+		return (bytes == o.bytes) ? idx < o.idx : bytes > o.bytes;
+	}
+};
+}//anonymous namespace
+
+void WorkStealingFileCrawler::distributeChunks()
+{
+	// Assign the biggest chunks first, each to the worker with the least bytes assigned.
+	// Every worker queue is then ordered descending by size, the workers start with
+	// their biggest chunks and thieves take the small ones from the back:
+	std::vector<ChunkRef> order;
+	order.reserve( m_chunks.size());
+	std::size_t ci = 0, ce = m_chunks.size();
+	for (; ci != ce; ++ci)
+	{
+		if (!m_chunks[ ci].files.empty())
+		{
+			order.push_back( ChunkRef( ci, m_chunks[ ci].bytes));
+		}
+	}
+	std::sort( order.begin(), order.end());
+
+	std::vector<ChunkRef>::const_iterator oi = order.begin(), oe = order.end();
+	for (; oi != oe; ++oi)
+	{
+		std::vector<WorkerQueueReference>::iterator
+			wi = m_workerQueues.begin(), we = m_workerQueues.end(), wmin = wi;
+		for (++wi; wi != we; ++wi)
+		{
+			if ((*wi)->bytes < (*wmin)->bytes) wmin = wi;
+		}
+		(*wmin)->chunks.push_back( Chunk());
+		(*wmin)->chunks.back().files.swap( m_chunks[ oi->idx].files);
+		(*wmin)->chunks.back().bytes = oi->bytes;
+		(*wmin)->bytes += oi->bytes;
+	}
+	m_chunks.clear();
+}
+
+bool WorkStealingFileCrawler::popFront( WorkerQueue& que, std::vector<std::string>& files)
+{
+	strus::scoped_lock lock( que.mutex);
+	if (que.chunks.empty()) return false;
+	files.swap( que.chunks.front().files);
+	que.bytes -= que.chunks.front().bytes;
+	que.chunks.pop_front();
+	return true;
+}
+
+bool WorkStealingFileCrawler::stealBack( std::vector<std::string>& files)
+{
+	for (;;)
+	{
+		// Select the victim with the most bytes left:
+		WorkerQueue* victim = 0;
+		uint64_t victimBytes = 0;
+		std::vector<WorkerQueueReference>::iterator
+			wi = m_workerQueues.begin(), we = m_workerQueues.end();
+		for (; wi != we; ++wi)
+		{
+			strus::scoped_lock lock( (*wi)->mutex);
+			if (!(*wi)->chunks.empty() && (!victim || (*wi)->bytes > victimBytes))
+			{
+				victim = wi->get();
+				victimBytes = (*wi)->bytes;
+			}
+		}
+		if (!victim) return false;
+
+		strus::scoped_lock lock( victim->mutex);
+		if (victim->chunks.empty()) continue;
+		//... the victim got empty in the meantime, select another one
+		files.swap( victim->chunks.back().files);
+		victim->bytes -= victim->chunks.back().bytes;
+		victim->chunks.pop_back();
+		return true;
+	}
+}
+
+std::vector<std::string> WorkStealingFileCrawler::fetch( int worker)
+{
+	try
+	{
+		std::vector<std::string> rt;
+		if (worker >= 0 && worker < (int)m_workerQueues.size())
+		{
+			if (popFront( *m_workerQueues[ worker], rt)) return rt;
+		}
+		stealBack( rt);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error fetching files to process: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+std::vector<std::string> WorkStealingFileCrawler::fetch()
+{
+	return fetch( -1);
+}
+
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_WORK_STEALING_FILE_CRAWLER_HPP_INCLUDED
+#define _STRUS_INSERTER_WORK_STEALING_FILE_CRAWLER_HPP_INCLUDED
+#include "strus/base/fileio.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/stdint.h"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileCrawlerInterface.hpp"
+#include "strus/reference.hpp"
+#include <vector>
+#include <string>
+#include <deque>
+
+namespace strus {
+
+/// \brief File crawler building chunks of files balanced by their size and scheduling them to per worker queues with work stealing
+class WorkStealingFileCrawler
+	:public FileCrawlerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] path_ list of files or directories to process
+	/// \param[in] chunkSize_ maximum number of files per chunk
+	/// \param[in] chunkBytes_ maximum total size of the files in a chunk in bytes (a single file bigger than this makes up a chunk of its own)
+	/// \param[in] nofWorkers_ number of worker threads fetching chunks
+	/// \param[in] extension_ extension of the files to process, empty for all files
+	/// \param[in] errorhnd_ error buffer interface
+	WorkStealingFileCrawler(
+			const std::vector<std::string>& path_,
+			std::size_t chunkSize_,
+			uint64_t chunkBytes_,
+			int nofWorkers_,
+			const std::string& extension_,
+			ErrorBufferInterface* errorhnd_);
+
+	virtual ~WorkStealingFileCrawler();
+
+	virtual std::vector<std::string> fetch();
+	virtual std::vector<std::string> fetch( int worker);
+
+private:
+	struct Chunk
+	{
+		Chunk( const Chunk& o)
+			:files(o.files),bytes(o.bytes){}
+		Chunk()
+			:files(),bytes(0){}
+
+		std::vector<std::string> files;
+		uint64_t bytes;
+	};
+
+	struct WorkerQueue
+	{
+		WorkerQueue()
+			:chunks(),bytes(0){}
+
+		std::deque<Chunk> chunks;
+		uint64_t bytes;
+		strus::mutex mutex;
+	};
+	typedef strus::Reference<WorkerQueue> WorkerQueueReference;
+
+	void collectFilesToProcess( const std::string& dir);
+	void addFile( const std::string& path);
+	void distributeChunks();
+	bool popFront( WorkerQueue& que, std::vector<std::string>& files);
+	bool stealBack( std::vector<std::string>& files);
+
+private:
+	ErrorBufferInterface* m_errorhnd;
+	std::size_t m_chunkSize;
+	uint64_t m_chunkBytes;
+	std::string m_extension;
+
+	std::vector<Chunk> m_chunks;
+	std::vector<WorkerQueueReference> m_workerQueues;
+};
+
+}//namespace
+#endif
+
@@ -31,6 +31,7 @@
 #include "private/errorUtils.hpp"
 #include "metadataExpression.hpp"
 #include "termExpression.hpp"
+#include "queryPlan.hpp"
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -89,7 +90,7 @@ static const char* g_tokens[] = {
 	"\\;",
 	"\\~",
 	"\\^",
-	"\\*"
+	"\\*",
 	"<-",
 	"[/][^;,{} ]*",
 	NULL
@@ -129,7 +130,8 @@ static const char* g_errtokens[] = {
 };
 static const char* g_eolncomment = "#";
 
-static const char* tokenName( const ProgramLexem& cur)
+template <class Lexem>
+static const char* tokenName( const Lexem& cur)
 {
 	switch (cur.type())
 	{
@@ -210,7 +212,191 @@ struct QueryDescriptors
 };
 
 
-static std::string parseVariableRef( ProgramLexer& lexer)
+/// \brief Token of a query source scanned for the lookup of its query plan in a cache
+struct QueryToken
+{
+	ProgramLexem::Type type;	///< ProgramLexem::Token, ProgramLexem::SQString or ProgramLexem::DQString
+	int id;				///< token identifier (enum Tokens) if type is ProgramLexem::Token
+	std::string value;
+	const char* pos;		///< start of the token in the source
+
+	QueryToken( ProgramLexem::Type type_, int id_, const std::string& value_, const char* pos_)
+		:type(type_),id(id_),value(value_),pos(pos_){}
+	QueryToken( const QueryToken& o)
+		:type(o.type),id(o.id),value(o.value),pos(o.pos){}
+
+	bool isValue() const
+	{
+		return type != ProgramLexem::Token || id == TokIdentifier || id == TokInteger || id == TokFloat;
+	}
+};
+
+static bool isAlpha( char ch)
+{
+	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+}
+
+static bool isDigit( char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+/// \brief Scan the tokens of a query source without regular expressions.
+/// \note Only handles the subset of the query language needed for simple queries (identifiers, unsigned numbers, strings without escaping, brackets, colons, commas, compare operators, feature weights, etc.)
+/// \param[out] tokens the tokens scanned
+/// \param[out] shape the sequence of tokens with the values (identifiers, numbers, strings) replaced by their type
+/// \param[in] source source to scan
+/// \return false if the source contains anything else (comments, signs, escaped characters, etc.), that has to be scanned by the ProgramLexer
+static bool scanQueryTokens( std::vector<QueryToken>& tokens, std::string& shape, const std::string& source)
+{
+	char const* si = source.c_str();
+	char const* se = si + source.size();
+	while (si != se)
+	{
+		const char* start = si;
+		if (*si == ' ' || *si == '\t' || *si == '\r' || *si == '\n')
+		{
+			++si;
+			continue;
+		}
+		else if (isAlpha( *si))
+		{
+			for (++si; si != se && (isAlpha( *si) || isDigit( *si)); ++si){}
+			tokens.push_back( QueryToken( ProgramLexem::Token, TokIdentifier, std::string( start, si), start));
+			shape.push_back( 'i');
+		}
+		else if (isDigit( *si))
+		{
+			for (++si; si != se && isDigit( *si); ++si){}
+			bool isFloat = (si != se && *si == '.');
+			if (isFloat)
+			{
+				for (++si; si != se && isDigit( *si); ++si){}
+			}
+			if (si != se && (isAlpha( *si) || *si == '.')) return false;
+			tokens.push_back( QueryToken( ProgramLexem::Token, isFloat ? TokFloat : TokInteger, std::string( start, si), start));
+			shape.push_back( isFloat ? 'f' : 'n');
+		}
+		else if (*si == '\'' || *si == '"')
+		{
+			char quote = *si;
+			for (++si; si != se && *si != quote; ++si)
+			{
+				if (*si == '\\' || *si == '\n' || *si == '\r') return false;
+			}
+			if (si == se) return false;
+			++si;
+			ProgramLexem::Type type = (quote == '"') ? ProgramLexem::DQString : ProgramLexem::SQString;
+			tokens.push_back( QueryToken( type, 0, std::string( start+1, si-1), start));
+			shape.push_back( quote == '"' ? 'd' : 's');
+		}
+		else
+		{
+			int id;
+			switch (*si)
+			{
+				case '(': id = TokOpenOvalBracket; break;
+				case ')': id = TokCloseOvalBracket; break;
+				case ',': id = TokComma; break;
+				case ':': id = TokColon; break;
+				case '~': id = TokTilde; break;
+				case '|': id = TokOr; break;
+				case '^': id = TokExp; break;
+				case '*': id = TokAsterisk; break;
+				case '=': id = (si+1 != se && si[1] == '=') ? TokCompareEqual : TokAssign; break;
+				case '>': id = (si+1 != se && si[1] == '=') ? TokCompareGreaterEqual : TokCompareGreater; break;
+				case '<': id = (si+1 != se && si[1] == '=') ? TokCompareLessEqual : TokCompareLess; break;
+				case '!': if (si+1 != se && si[1] == '=') {id = TokCompareNotEqual; break;} return false;
+				default: return false;
+			}
+			si += (id == TokCompareEqual || id == TokCompareGreaterEqual || id == TokCompareLessEqual || id == TokCompareNotEqual) ? 2 : 1;
+			tokens.push_back( QueryToken( ProgramLexem::Token, id, std::string( start, si), start));
+			shape.append( start, si);
+		}
+		shape.push_back( ' ');
+	}
+	return true;
+}
+
+/// \brief Lexem of the QueryTokenLexer with the methods of ProgramLexem used by the query parser
+class QueryTokenLexem
+{
+public:
+	QueryTokenLexem()
+		:m_token(0){}
+	explicit QueryTokenLexem( const QueryToken* token_)
+		:m_token(token_){}
+
+	ProgramLexem::Type type() const		{return m_token ? m_token->type : ProgramLexem::Eof;}
+	int id() const				{return m_token ? m_token->id : 0;}
+	bool isEof() const			{return !m_token;}
+	bool isToken( int id_) const		{return m_token && m_token->type == ProgramLexem::Token && m_token->id == id_;}
+	bool isString() const			{return m_token && (m_token->type == ProgramLexem::SQString || m_token->type == ProgramLexem::DQString);}
+	const std::string& value() const	{static const std::string empty; return m_token ? m_token->value : empty;}
+
+private:
+	const QueryToken* m_token;
+};
+
+/// \brief Lexer on a list of tokens scanned with scanQueryTokens, with the methods of ProgramLexer used by the query parser
+class QueryTokenLexer
+{
+public:
+	QueryTokenLexer( const std::vector<QueryToken>& tokens_, const char* end_)
+		:m_tokens(tokens_),m_end(end_),m_idx(-1),m_cur(){}
+
+	const QueryTokenLexem& current() const
+	{
+		return m_cur;
+	}
+	const QueryTokenLexem& next()
+	{
+		if (m_idx < (int)m_tokens.size()) ++m_idx;
+		m_cur = m_idx < (int)m_tokens.size() ? QueryTokenLexem( &m_tokens[ m_idx]) : QueryTokenLexem();
+		return m_cur;
+	}
+	bool consumeToken( int id)
+	{
+		if (!m_cur.isToken( id)) return false;
+		next();
+		return true;
+	}
+	const char* currentpos() const
+	{
+		return m_idx >= 0 && m_idx < (int)m_tokens.size() ? m_tokens[ m_idx].pos : m_end;
+	}
+	void skipto( const char* pos)
+	{
+		m_idx = 0;
+		for (; m_idx < (int)m_tokens.size() && m_tokens[ m_idx].pos < pos; ++m_idx){}
+		m_cur = m_idx < (int)m_tokens.size() ? QueryTokenLexem( &m_tokens[ m_idx]) : QueryTokenLexem();
+	}
+	/// \brief Index of the current token
+	int index() const
+	{
+		return m_idx;
+	}
+
+private:
+	const std::vector<QueryToken>& m_tokens;
+	const char* m_end;
+	int m_idx;
+	QueryTokenLexem m_cur;
+};
+
+/// \brief Index of the token with the current value referenced in the query plan, -1 if the value is stored in the plan
+static int lexemSlot( const ProgramLexer&)
+{
+	return -1;
+}
+
+static int lexemSlot( const QueryTokenLexer& lexer)
+{
+	return lexer.index();
+}
+
+template <class Lexer>
+static std::string parseVariableRef( Lexer& lexer)
 {
 	std::string rt;
 	if (lexer.current().isToken(TokAssign))
@@ -221,7 +407,8 @@ static std::string parseVariableRef( ProgramLexer& lexer)
 	return rt;
 }
 
-static bool isQueryStructureExpression( ProgramLexer& lexer)
+template <class Lexer>
+static bool isQueryStructureExpression( Lexer& lexer)
 {
 	bool rt = false;
 	const char* curpos = lexer.currentpos();
@@ -234,7 +421,8 @@ static bool isQueryStructureExpression( ProgramLexer& lexer)
 	return rt;
 }
 
-static bool isCompareOperator( MetaDataRestrictionInterface::CompareOperator& opr, ProgramLexer& lexer)
+template <class Lexer>
+static bool isCompareOperator( MetaDataRestrictionInterface::CompareOperator& opr, Lexer& lexer)
 {
 	if (lexer.current().isToken(TokAssign))
 	{
@@ -277,7 +465,8 @@ static bool isCompareOperator( MetaDataRestrictionInterface::CompareOperator& op
 	}
 }
 
-static bool isQueryMetaDataExpression( ProgramLexer& lexer)
+template <class Lexer>
+static bool isQueryMetaDataExpression( Lexer& lexer)
 {
 	bool rt = false;
 	const char* curpos = lexer.currentpos();
@@ -305,12 +494,14 @@ static MetaDataRestrictionInterface::CompareOperator invertCompareOperator( cons
 	throw std::runtime_error( _TXT("unknown metadata compare operator"));
 }
 
+template <class Lexer>
 static void parseMetaDataExpression( 
-		MetaDataExpression& metadataExpression,
-		ProgramLexer& lexer)
+		QueryPlan& plan,
+		Lexer& lexer)
 {
 	std::string fieldName;
 	std::vector<std::string> values;
+	std::vector<int> slots;
 	MetaDataRestrictionInterface::CompareOperator opr;
 	if (lexer.current().isToken(TokIdentifier))
 	{
@@ -328,11 +519,13 @@ static void parseMetaDataExpression(
 				throw strus::runtime_error( _TXT("metadata value expected instead of %s"), tokenName( lexer.current()));
 			}
 			values.push_back( lexer.current().value());
+			slots.push_back( lexemSlot( lexer));
 		} while (lexer.next().isToken(TokComma));
 	}
 	else if (lexer.current().isString() || lexer.current().isToken(TokInteger) || lexer.current().isToken(TokFloat))
 	{
 		values.push_back( lexer.current().value());
+		slots.push_back( lexemSlot( lexer));
 		lexer.next();
 
 		while (lexer.current().isToken(TokComma))
@@ -343,6 +536,7 @@ static void parseMetaDataExpression(
 				throw strus::runtime_error( _TXT("metadata value expected instead of %s"), tokenName( lexer.current()));
 			}
 			values.push_back( lexer.current().value());
+			slots.push_back( lexemSlot( lexer));
 			lexer.next();
 		}
 		if (!isCompareOperator( opr, lexer))
@@ -357,21 +551,22 @@ static void parseMetaDataExpression(
 		opr = invertCompareOperator( opr);
 	}
 	std::vector<std::string>::const_iterator vi = values.begin(), ve = values.end();
-	for (; vi != ve; ++vi)
+	std::vector<int>::const_iterator li = slots.begin();
+	for (; vi != ve; ++vi,++li)
 	{
-		metadataExpression.pushCompare( opr, fieldName, *vi);
+		plan.pushMetaDataCompare( opr, fieldName, *vi, *li);
 	}
 	if (values.size() > 1)
 	{
-		metadataExpression.pushOperator( MetaDataExpression::OperatorOR, values.size());
+		plan.pushMetaDataOr( values.size());
 	}
 }
 
+template <class Lexer>
 static void parseQueryTermExpression(
-		TermExpression& termExpression,
-		TermExpression& selectedTermExpression,
+		QueryPlan& plan,
 		QueryDescriptors& qdescr,
-		ProgramLexer& lexer)
+		Lexer& lexer)
 {
 	bool isSelection = true;
 	if (lexer.current().isToken( TokTilde))
@@ -380,11 +575,13 @@ static void parseQueryTermExpression(
 		isSelection = false;
 	}
 	std::string field;
+	int fieldSlot = -1;
 	std::string fieldType;
 
 	if (lexer.current().isString() || lexer.current().isToken(TokIdentifier))
 	{
 		field = lexer.current().value();
+		fieldSlot = lexemSlot( lexer);
 		if (lexer.next().isToken(TokColon))
 		{
 			if (lexer.next().isToken(TokIdentifier))
@@ -423,23 +620,19 @@ static void parseQueryTermExpression(
 	{
 		throw strus::runtime_error( _TXT("query field type '%s' not defined in analyzer configuration"), fieldType.c_str());
 	}
-	if (isSelection)
-	{
-		selectedTermExpression.pushField( fieldType, field);
-	}
-	termExpression.pushField( fieldType, field);
+	plan.pushTermField( fieldType, field, fieldSlot, isSelection);
 	std::string variableName = parseVariableRef( lexer);
 	if (!variableName.empty())
 	{
-		termExpression.attachVariable( variableName);
+		plan.attachTermVariable( variableName);
 	}
 }
 
+template <class Lexer>
 static void parseQueryStructureExpression(
-		TermExpression& termExpression,
-		TermExpression& selectedTermExpression,
+		QueryPlan& plan,
 		QueryDescriptors& qdescr,
-		ProgramLexer& lexer)
+		Lexer& lexer)
 {
 	if (!lexer.current().isToken(TokIdentifier))
 	{
@@ -461,11 +654,11 @@ static void parseQueryStructureExpression(
 			argc++;
 			if (isQueryStructureExpression(lexer))
 			{
-				parseQueryStructureExpression( termExpression, selectedTermExpression, qdescr, lexer);
+				parseQueryStructureExpression( plan, qdescr, lexer);
 			}
 			else
 			{
-				parseQueryTermExpression( termExpression, selectedTermExpression, qdescr, lexer);
+				parseQueryTermExpression( plan, qdescr, lexer);
 			}
 		} while (lexer.consumeToken(TokComma));
 	}
@@ -507,88 +700,149 @@ static void parseQueryStructureExpression(
 	}
 	lexer.next();
 	std::string variableName = parseVariableRef( lexer);
-	termExpression.pushExpression( functionName, argc, range, cardinality);
+	plan.pushTermOperator( functionName, argc, range, cardinality);
 	if (!variableName.empty())
 	{
-		termExpression.attachVariable( variableName);
+		plan.attachTermVariable( variableName);
 	}
 }
 
-
-DLL_PUBLIC bool strus::loadQuery(
-		QueryInterface& query,
+/// \brief Parse a query source into a plan
+template <class Lexer>
+static void parseQuery(
+		QueryPlan& plan,
 		const QueryAnalyzerInstanceInterface* analyzer,
-		const std::string& selectionFeatureSet,
-		const std::string& weightingFeatureSet,
-		const QueryProcessorInterface* queryproc,
-		const std::string& source,
-		ErrorBufferInterface* errorhnd)
+		Lexer& lexer)
 {
-	ProgramLexer lexer( source.c_str(), g_eolncomment, g_tokens, g_errtokens, errorhnd);
-	try
-	{
-		QueryDescriptors qdescr( analyzer->queryFieldTypes(), analyzer->queryTermTypes());
-		qdescr.selectionFeatureSet = selectionFeatureSet;
-		qdescr.weightingFeatureSet = weightingFeatureSet;
+	QueryDescriptors qdescr( analyzer->queryFieldTypes(), analyzer->queryTermTypes());
+	qdescr.selectionFeatureSet = plan.selectionFeatureSet();
+	qdescr.weightingFeatureSet = plan.weightingFeatureSet();
+	plan.defineSelection( qdescr.defaultSelectionTermPart, qdescr.defaultSelectionJoin);
 
-		QueryAnalyzerStruct queryAnalyzerStruct;
-		std::set<std::string>::const_iterator si = qdescr.fieldset.begin(), se = qdescr.fieldset.end();
-		for (; si != se; ++si)
+	lexer.next();
+	while (!lexer.current().isEof())
+	{
+		// Parse query section:
+		if (isQueryMetaDataExpression( lexer))
 		{
-			// Group elements in one field implicitely as sequence:
-			queryAnalyzerStruct.autoGroupBy( *si, "sequence_imm", 0, 0, QueryAnalyzerContextInterface::GroupAll, false/*group single*/);
+			parseMetaDataExpression( plan, lexer);
 		}
-		MetaDataExpression metaDataExpression( analyzer, errorhnd);
-		TermExpression termExpression( &queryAnalyzerStruct, analyzer, errorhnd);
-		TermExpression selectedTermExpression( &queryAnalyzerStruct, analyzer, errorhnd);
-
-		lexer.next();
-		while (!lexer.current().isEof())
+		else
 		{
-			// Parse query section:
-			if (isQueryMetaDataExpression( lexer))
+			if (isQueryStructureExpression( lexer))
 			{
-				parseMetaDataExpression( metaDataExpression, lexer);
+				parseQueryStructureExpression( plan, qdescr, lexer);
 			}
 			else
 			{
-				if (isQueryStructureExpression( lexer))
+				parseQueryTermExpression( plan, qdescr, lexer);
+			}
+			double featureWeight = 1.0;
+			if (lexer.current().isToken( TokAsterisk))
+			{
+				lexer.next();
+				if (lexer.current().isToken(TokInteger) || lexer.current().isToken(TokFloat))
 				{
-					parseQueryStructureExpression( termExpression, selectedTermExpression, qdescr, lexer);
+					featureWeight = numstring_conv::todouble( lexer.current().value());
 				}
 				else
 				{
-					parseQueryTermExpression( termExpression, selectedTermExpression, qdescr, lexer);
+					throw std::runtime_error( _TXT("feature weight expected after term expression and following asterisk '*'"));
 				}
-				double featureWeight = 1.0;
-				if (lexer.current().isToken( TokAsterisk))
-				{
-					lexer.next();
-					if (lexer.current().isToken(TokInteger) || lexer.current().isToken(TokFloat))
-					{
-						featureWeight = numstring_conv::todouble( lexer.current().value());
-					}
-					else
-					{
-						throw std::runtime_error( _TXT("feature weight expected after term expression and following asterisk '*'"));
-					}
-				}
-				termExpression.assignFeature( qdescr.weightingFeatureSet, featureWeight);
 			}
+			plan.assignTermFeature( featureWeight);
 		}
+	}
+}
+
+/// \brief Build a query from a plan
+/// \param[in] tokens tokens of the source with the values referenced by the plan or NULL if the plan has all values inlined
+/// \param[out] queryModified set to true before the first change of the query
+static void instantiateQueryPlan(
+		QueryInterface& query,
+		const QueryPlan& plan,
+		const std::vector<QueryToken>* tokens,
+		const QueryAnalyzerInstanceInterface* analyzer,
+		const QueryProcessorInterface* queryproc,
+		ErrorBufferInterface* errorhnd,
+		bool& queryModified)
+{
+	QueryAnalyzerStruct queryAnalyzerStruct;
+	std::vector<std::string> fieldTypes = analyzer->queryFieldTypes();
+	std::set<std::string> fieldset( fieldTypes.begin(), fieldTypes.end());
+	std::set<std::string>::const_iterator si = fieldset.begin(), se = fieldset.end();
+	for (; si != se; ++si)
+	{
+		// Group elements in one field implicitely as sequence:
+		queryAnalyzerStruct.autoGroupBy( *si, "sequence_imm", 0, 0, QueryAnalyzerContextInterface::GroupAll, false/*group single*/);
+	}
+	MetaDataExpression metaDataExpression( analyzer, errorhnd);
+	TermExpression termExpression( &queryAnalyzerStruct, analyzer, errorhnd);
+	TermExpression selectedTermExpression( &queryAnalyzerStruct, analyzer, errorhnd);
+
+	std::vector<QueryPlanInstruction>::const_iterator ii = plan.instructions().begin(), ie = plan.instructions().end();
+	for (; ii != ie; ++ii)
+	{
+		const std::string& value = (ii->slot >= 0 && tokens) ? (*tokens)[ ii->slot].value : ii->value;
+		switch (ii->opcode)
 		{
-			// Define selection term expression
-			unsigned int argc = selectedTermExpression.nofExpressionsDefined();
-			unsigned int cardinality = std::min( argc, (unsigned int)(qdescr.defaultSelectionTermPart * argc + 1));
-			selectedTermExpression.pushExpression( qdescr.defaultSelectionJoin, argc, 0/*range*/, cardinality);
-			selectedTermExpression.assignFeature( qdescr.selectionFeatureSet, 1.0);
+			case QueryPlanInstruction::MetaDataCompare:
+				metaDataExpression.pushCompare( ii->cmpop, ii->name, value);
+				break;
+			case QueryPlanInstruction::MetaDataOr:
+				metaDataExpression.pushOperator( MetaDataExpression::OperatorOR, ii->argc);
+				break;
+			case QueryPlanInstruction::TermField:
+				if (ii->selection)
+				{
+					selectedTermExpression.pushField( ii->name, value);
+				}
+				termExpression.pushField( ii->name, value);
+				break;
+			case QueryPlanInstruction::TermOperator:
+				termExpression.pushExpression( ii->name, ii->argc, ii->range, ii->cardinality);
+				break;
+			case QueryPlanInstruction::TermVariable:
+				termExpression.attachVariable( ii->name);
+				break;
+			case QueryPlanInstruction::TermFeature:
+				termExpression.assignFeature( plan.weightingFeatureSet(), ii->weight);
+				break;
 		}
-		metaDataExpression.analyze();
-		metaDataExpression.translate( query);
-		termExpression.analyze();
-		termExpression.translate( query, queryproc);
-		selectedTermExpression.analyze();
-		selectedTermExpression.translate( query, queryproc);
+	}
+	{
+		// Define selection term expression
+		unsigned int argc = selectedTermExpression.nofExpressionsDefined();
+		unsigned int cardinality = std::min( argc, (unsigned int)(plan.defaultSelectionTermPart() * argc + 1));
+		selectedTermExpression.pushExpression( plan.defaultSelectionJoin(), argc, 0/*range*/, cardinality);
+		selectedTermExpression.assignFeature( plan.selectionFeatureSet(), 1.0);
+	}
+	metaDataExpression.analyze();
+	termExpression.analyze();
+	selectedTermExpression.analyze();
+
+	queryModified = true;
+	metaDataExpression.translate( query);
+	termExpression.translate( query, queryproc);
+	selectedTermExpression.translate( query, queryproc);
+}
+
+DLL_PUBLIC bool strus::loadQuery(
+		QueryInterface& query,
+		const QueryAnalyzerInstanceInterface* analyzer,
+		const std::string& selectionFeatureSet,
+		const std::string& weightingFeatureSet,
+		const QueryProcessorInterface* queryproc,
+		const std::string& source,
+		ErrorBufferInterface* errorhnd)
+{
+	ProgramLexer lexer( source.c_str(), g_eolncomment, g_tokens, g_errtokens, errorhnd);
+	try
+	{
+		QueryPlan plan( selectionFeatureSet, weightingFeatureSet);
+		parseQuery( plan, analyzer, lexer);
+		bool queryModified = false;
+		instantiateQueryPlan( query, plan, 0/*tokens*/, analyzer, queryproc, errorhnd, queryModified);
 		return true;
 	}
 	catch (const std::bad_alloc&)
@@ -603,6 +857,112 @@ DLL_PUBLIC bool strus::loadQuery(
 	}
 }
 
+static void appendKeyList( std::string& key, const std::vector<std::string>& list)
+{
+	std::vector<std::string>::const_iterator li = list.begin(), le = list.end();
+	for (; li != le; ++li)
+	{
+		key.append( *li);
+		key.push_back( '\1');
+	}
+	key.push_back( '\n');
+}
+
+/// \brief Key of the shape of a source in the cache
+/// \note The analyzer is identified by the query field and term types it defines, because the parser depends only on them
+static std::string queryShapeKey( const QueryAnalyzerInstanceInterface* analyzer, const std::string& selectionFeatureSet, const std::string& weightingFeatureSet, const std::string& shape)
+{
+	std::string rt;
+	appendKeyList( rt, analyzer->queryFieldTypes());
+	appendKeyList( rt, analyzer->queryTermTypes());
+	rt.append( selectionFeatureSet);
+	rt.push_back( '\n');
+	rt.append( weightingFeatureSet);
+	rt.push_back( '\n');
+	rt.append( shape);
+	return rt;
+}
+
+/// \brief Key of a plan in the cache: the shape of the source with the values of all tokens not referenced as literal values
+static std::string queryPlanKey( const std::string& shapekey, const std::vector<QueryToken>& tokens, const std::vector<int>& literalSlots)
+{
+	std::string rt( shapekey);
+	std::vector<int>::const_iterator li = literalSlots.begin(), le = literalSlots.end();
+	std::vector<QueryToken>::const_iterator ti = tokens.begin(), te = tokens.end();
+	for (int tidx=0; ti != te; ++ti,++tidx)
+	{
+		if (!ti->isValue()) continue;
+		for (; li != le && *li < tidx; ++li){}
+		if (li != le && *li == tidx) continue;
+		rt.push_back( '\1');
+		rt.append( ti->value);
+	}
+	return rt;
+}
+
+DLL_PUBLIC bool strus::loadQuery(
+		QueryInterface& query,
+		const QueryAnalyzerInstanceInterface* analyzer,
+		const std::string& selectionFeatureSet,
+		const std::string& weightingFeatureSet,
+		const QueryProcessorInterface* queryproc,
+		const std::string& source,
+		QueryPlanCacheInterface* cache,
+		ErrorBufferInterface* errorhnd)
+{
+	if (!cache)
+	{
+		return strus::loadQuery( query, analyzer, selectionFeatureSet, weightingFeatureSet, queryproc, source, errorhnd);
+	}
+	bool queryModified = false;
+	try
+	{
+		std::vector<QueryToken> tokens;
+		std::string shape;
+		if (!scanQueryTokens( tokens, shape, source))
+		{
+			// Sources with syntax not covered by the scanner (comments, floating point numbers, escapes, etc.) are parsed without cache:
+			cache->bypass();
+			return strus::loadQuery( query, analyzer, selectionFeatureSet, weightingFeatureSet, queryproc, source, errorhnd);
+		}
+		std::string shapekey( queryShapeKey( analyzer, selectionFeatureSet, weightingFeatureSet, shape));
+
+		Reference<QueryPlan> plan;
+		std::vector<int> literalSlots;
+		if (cache->getLiteralSlots( shapekey, literalSlots))
+		{
+			plan = cache->get( queryPlanKey( shapekey, tokens, literalSlots));
+		}
+		if (!plan.get())
+		{
+			plan.reset( new QueryPlan( selectionFeatureSet, weightingFeatureSet));
+			QueryTokenLexer lexer( tokens, source.c_str() + source.size());
+			parseQuery( *plan, analyzer, lexer);
+			cache->put( shapekey, queryPlanKey( shapekey, tokens, plan->literalSlots()), plan);
+		}
+		instantiateQueryPlan( query, *plan, &tokens, analyzer, queryproc, errorhnd, queryModified);
+		return true;
+	}
+	catch (const std::bad_alloc&)
+	{
+		if (queryModified)
+		{
+			errorhnd->report( ErrorCodeOutOfMem, _TXT("out or memory loading query"));
+			return false;
+		}
+	}
+	catch (const std::runtime_error& e)
+	{
+		if (queryModified)
+		{
+			errorhnd->report( ErrorCodeRuntimeError, _TXT("error loading query: %s"), e.what());
+			return false;
+		}
+	}
+	// Errors before the query has been touched are reported with the location in the source by the parser without cache:
+	return strus::loadQuery( query, analyzer, selectionFeatureSet, weightingFeatureSet, queryproc, source, errorhnd);
+}
+
 
 DLL_PUBLIC bool strus::scanNextProgram(
 		std::string& segment,
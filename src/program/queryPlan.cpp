@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryPlan.hpp"
+#include <algorithm>
+
+using namespace strus;
+
+void QueryPlan::addLiteralSlot( int slot)
+{
+	if (slot < 0) return;
+	std::vector<int>::iterator si = std::lower_bound( m_literalSlots.begin(), m_literalSlots.end(), slot);
+	if (si == m_literalSlots.end() || *si != slot)
+	{
+		m_literalSlots.insert( si, slot);
+	}
+}
+
+void QueryPlan::pushMetaDataCompare( const MetaDataRestrictionInterface::CompareOperator& cmpop, const std::string& fieldName, const std::string& value, int slot)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::MetaDataCompare);
+	instr.cmpop = cmpop;
+	instr.name = fieldName;
+	if (slot < 0) instr.value = value;
+	instr.slot = slot;
+	m_instructions.push_back( instr);
+	addLiteralSlot( slot);
+}
+
+void QueryPlan::pushMetaDataOr( unsigned int argc)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::MetaDataOr);
+	instr.argc = argc;
+	m_instructions.push_back( instr);
+}
+
+void QueryPlan::pushTermField( const std::string& fieldType, const std::string& value, int slot, bool selection)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::TermField);
+	instr.name = fieldType;
+	if (slot < 0) instr.value = value;
+	instr.slot = slot;
+	instr.selection = selection;
+	m_instructions.push_back( instr);
+	addLiteralSlot( slot);
+}
+
+void QueryPlan::pushTermOperator( const std::string& name, unsigned int argc, int range, unsigned int cardinality)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::TermOperator);
+	instr.name = name;
+	instr.argc = argc;
+	instr.range = range;
+	instr.cardinality = cardinality;
+	m_instructions.push_back( instr);
+}
+
+void QueryPlan::attachTermVariable( const std::string& name)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::TermVariable);
+	instr.name = name;
+	m_instructions.push_back( instr);
+}
+
+void QueryPlan::assignTermFeature( double weight)
+{
+	QueryPlanInstruction instr( QueryPlanInstruction::TermFeature);
+	instr.weight = weight;
+	m_instructions.push_back( instr);
+}
+
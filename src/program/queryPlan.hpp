@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_UTILITIES_QUERY_PLAN_HPP_INCLUDED
+#define _STRUS_UTILITIES_QUERY_PLAN_HPP_INCLUDED
+#include "strus/metaDataRestrictionInterface.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief One step of building a query from its parsed source
+struct QueryPlanInstruction
+{
+	enum Opcode
+	{
+		MetaDataCompare,	///< metadata restriction condition (MetaDataExpression::pushCompare)
+		MetaDataOr,		///< join of the last 'argc' metadata conditions with OR (MetaDataExpression::pushOperator)
+		TermField,		///< query field (TermExpression::pushField), part of the selection if 'selection' is set
+		TermOperator,		///< query structure expression (TermExpression::pushExpression)
+		TermVariable,		///< variable attached to the last term expression (TermExpression::attachVariable)
+		TermFeature		///< last term expression declared as weighting feature (TermExpression::assignFeature)
+	};
+
+	Opcode opcode;
+	std::string name;		///< field type, operator name, variable name or metadata element name
+	std::string value;		///< literal value, if not referenced by 'slot'
+	int slot;			///< index of the token with the literal value in the source or -1 if the value is in 'value'
+	bool selection;
+	unsigned int argc;
+	int range;
+	unsigned int cardinality;
+	double weight;
+	MetaDataRestrictionInterface::CompareOperator cmpop;
+
+	explicit QueryPlanInstruction( Opcode opcode_)
+		:opcode(opcode_),name(),value(),slot(-1),selection(false),argc(0),range(0),cardinality(0),weight(0.0)
+		,cmpop(MetaDataRestrictionInterface::CompareEqual){}
+};
+
+/// \brief Parsed query with the literal values (query fields and metadata values) referenced by the index of their token in the source
+/// \note Instantiating a plan with the tokens of another source with the same structure builds the query of this source without parsing it
+class QueryPlan
+{
+public:
+	/// \brief Constructor
+	/// \param[in] selectionFeatureSet_ feature set used for document selection
+	/// \param[in] weightingFeatureSet_ feature set used for document weighting
+	QueryPlan( const std::string& selectionFeatureSet_, const std::string& weightingFeatureSet_)
+		:m_selectionFeatureSet(selectionFeatureSet_),m_weightingFeatureSet(weightingFeatureSet_)
+		,m_defaultSelectionTermPart(1.0),m_defaultSelectionJoin()
+		,m_instructions(),m_literalSlots(){}
+
+	/// \brief Define how the selection expression is built from the selected query fields
+	/// \param[in] termPart part of the selection terms required in the selection expression
+	/// \param[in] join operator joining the terms of the selection expression
+	void defineSelection( float termPart, const std::string& join)
+	{
+		m_defaultSelectionTermPart = termPart;
+		m_defaultSelectionJoin = join;
+	}
+
+	void pushMetaDataCompare( const MetaDataRestrictionInterface::CompareOperator& cmpop, const std::string& fieldName, const std::string& value, int slot);
+	void pushMetaDataOr( unsigned int argc);
+	void pushTermField( const std::string& fieldType, const std::string& value, int slot, bool selection);
+	void pushTermOperator( const std::string& name, unsigned int argc, int range, unsigned int cardinality);
+	void attachTermVariable( const std::string& name);
+	void assignTermFeature( double weight);
+
+	const std::string& selectionFeatureSet() const		{return m_selectionFeatureSet;}
+	const std::string& weightingFeatureSet() const		{return m_weightingFeatureSet;}
+	float defaultSelectionTermPart() const			{return m_defaultSelectionTermPart;}
+	const std::string& defaultSelectionJoin() const		{return m_defaultSelectionJoin;}
+	const std::vector<QueryPlanInstruction>& instructions() const	{return m_instructions;}
+	/// \brief Indices of the tokens with literal values in ascending order
+	const std::vector<int>& literalSlots() const		{return m_literalSlots;}
+
+private:
+	void addLiteralSlot( int slot);
+
+private:
+	std::string m_selectionFeatureSet;
+	std::string m_weightingFeatureSet;
+	float m_defaultSelectionTermPart;
+	std::string m_defaultSelectionJoin;
+	std::vector<QueryPlanInstruction> m_instructions;
+	std::vector<int> m_literalSlots;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryPlanCache.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/dll_tags.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+
+using namespace strus;
+
+QueryPlanCache::QueryPlanCache( std::size_t maxNofPlans_)
+	:m_maxNofPlans(maxNofPlans_ ? maxNofPlans_ : 1),m_entries(),m_entryMap(),m_shapeMap()
+	,m_nofHits(0),m_nofMisses(0),m_nofBypassed(0)
+{}
+
+unsigned int QueryPlanCache::nofHits() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_nofHits;
+}
+
+unsigned int QueryPlanCache::nofMisses() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_nofMisses;
+}
+
+unsigned int QueryPlanCache::nofBypassed() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_nofBypassed;
+}
+
+bool QueryPlanCache::getLiteralSlots( const std::string& shape, std::vector<int>& slots) const
+{
+	strus::scoped_lock lock( m_mutex);
+	ShapeMap::const_iterator si = m_shapeMap.find( shape);
+	if (si == m_shapeMap.end()) return false;
+	slots = si->second;
+	return true;
+}
+
+Reference<QueryPlan> QueryPlanCache::get( const std::string& key)
+{
+	strus::scoped_lock lock( m_mutex);
+	EntryMap::iterator mi = m_entryMap.find( key);
+	if (mi == m_entryMap.end()) return Reference<QueryPlan>();
+	++m_nofHits;
+	m_entries.splice( m_entries.begin(), m_entries, mi->second);
+	return mi->second->plan;
+}
+
+void QueryPlanCache::put( const std::string& shape, const std::string& key, const Reference<QueryPlan>& plan)
+{
+	strus::scoped_lock lock( m_mutex);
+	++m_nofMisses;
+	if (m_shapeMap.size() >= 4 * m_maxNofPlans)
+	{
+		// The shapes are only a hint for building the key, they are dropped all together when there are too many:
+		m_shapeMap.clear();
+	}
+	m_shapeMap[ shape] = plan->literalSlots();
+
+	EntryMap::iterator mi = m_entryMap.find( key);
+	if (mi != m_entryMap.end())
+	{
+		// Inserted by another thread parsing a query with the same plan:
+		m_entries.splice( m_entries.begin(), m_entries, mi->second);
+		return;
+	}
+	m_entries.push_front( Entry( key, plan));
+	m_entryMap[ key] = m_entries.begin();
+	if (m_entryMap.size() > m_maxNofPlans)
+	{
+		m_entryMap.erase( m_entries.back().key);
+		m_entries.pop_back();
+	}
+}
+
+void QueryPlanCache::bypass()
+{
+	strus::scoped_lock lock( m_mutex);
+	++m_nofBypassed;
+}
+
+DLL_PUBLIC QueryPlanCacheInterface* strus::createQueryPlanCache( std::size_t maxNofPlans, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		return new QueryPlanCache( maxNofPlans);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating query plan cache: %s"), *errorhnd, 0);
+}
+
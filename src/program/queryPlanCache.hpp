@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_UTILITIES_QUERY_PLAN_CACHE_HPP_INCLUDED
+#define _STRUS_UTILITIES_QUERY_PLAN_CACHE_HPP_INCLUDED
+#include "private/programLoader.hpp"
+#include "queryPlan.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/thread.hpp"
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Implementation of the cache of parsed queries with least recently used eviction
+/// \note Plans are looked up in two steps: The shape of a source (the sequence of its tokens with the values abstracted) determines which tokens hold literal values.
+///	The plan is then found with the shape and the values of all other tokens (field types, operators, variables, etc.).
+class QueryPlanCache
+	:public QueryPlanCacheInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofPlans_ maximum number of query plans kept
+	explicit QueryPlanCache( std::size_t maxNofPlans_);
+	virtual ~QueryPlanCache(){}
+
+	virtual unsigned int nofHits() const;
+	virtual unsigned int nofMisses() const;
+	virtual unsigned int nofBypassed() const;
+
+	virtual bool getLiteralSlots( const std::string& shape, std::vector<int>& slots) const;
+	virtual Reference<QueryPlan> get( const std::string& key);
+	virtual void put( const std::string& shape, const std::string& key, const Reference<QueryPlan>& plan);
+	virtual void bypass();
+
+private:
+	struct Entry
+	{
+		std::string key;
+		Reference<QueryPlan> plan;
+
+		Entry( const std::string& key_, const Reference<QueryPlan>& plan_)
+			:key(key_),plan(plan_){}
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string,EntryList::iterator> EntryMap;
+	typedef std::map<std::string,std::vector<int> > ShapeMap;
+
+	std::size_t m_maxNofPlans;
+	EntryList m_entries;			///< plans ordered from the most recently to the least recently used
+	EntryMap m_entryMap;			///< map of the keys to the plans
+	ShapeMap m_shapeMap;			///< map of the shapes to the indices of their tokens with literal values
+	unsigned int m_nofHits;
+	unsigned int m_nofMisses;
+	unsigned int m_nofBypassed;
+	mutable strus::mutex m_mutex;
+};
+
+}//namespace
+#endif
+
@@ -37,13 +37,13 @@
 #include "strus/base/cmdLineOpt.hpp"
 #include "strus/base/string_format.hpp"
 #include "strus/base/string_conv.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/programOptions.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
 #include "private/documentAnalyzer.hpp"
+#include "private/documentInputStream.hpp"
 #include "private/programLoader.hpp"
 #include <iostream>
 #include <fstream>
@@ -381,7 +381,7 @@ static void analyzeDocument(
 	if (!analyzerContext.get()) throw std::runtime_error( _TXT("failed to create document analyzer context"));
 
 	// Process the document:
-	strus::InputStream input( docpath);
+	strus::utils::DocumentInputStream input( docpath, false/*containerItems*/);
 	enum {AnalyzerBufSize=8192};
 	char buf[ AnalyzerBufSize];
 	bool eof = false;
@@ -934,7 +934,7 @@ int main( int argc, const char* argv[])
 		// Detect document content type if not explicitely defined:
 		if (!documentClass.defined() && docpathIsFile)
 		{
-			strus::InputStream input( docpath);
+			strus::utils::DocumentInputStream input( docpath, false/*containerItems*/);
 			char hdrbuf[ 4096];
 			std::size_t hdrsize = input.readAhead( hdrbuf, sizeof( hdrbuf));
 			if (input.error())
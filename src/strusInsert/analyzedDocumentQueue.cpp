@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "analyzedDocumentQueue.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+
+AnalyzedDocumentQueue::AnalyzedDocumentQueue( std::size_t maxNofBatches_, std::size_t batchSize_)
+	:m_ring( maxNofBatches_ ? maxNofBatches_ : 1)
+	,m_head(0),m_size(0)
+	,m_batchSize(batchSize_ ? batchSize_ : 1)
+	,m_closed(false)
+{}
+
+void AnalyzedDocumentQueue::push( AnalyzedDocumentBatch& batch)
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		while (m_size >= m_ring.size() && !m_closed)
+		{
+			m_cond_notFull.wait( lock);
+		}
+		if (m_closed) throw std::runtime_error( _TXT("push to closed queue of analyzed documents"));
+		AnalyzedDocumentBatch& slot = m_ring[ (m_head + m_size) % m_ring.size()];
+		slot.swap( batch);
+		++m_size;
+	}
+	batch.clear();
+	m_cond_notEmpty.notify_one();
+}
+
+bool AnalyzedDocumentQueue::pop( AnalyzedDocumentBatch& batch)
+{
+	batch.clear();
+	{
+		strus::unique_lock lock( m_mutex);
+		while (m_size == 0 && !m_closed)
+		{
+			m_cond_notEmpty.wait( lock);
+		}
+		if (m_size == 0) return false;
+		m_ring[ m_head].swap( batch);
+		m_head = (m_head + 1) % m_ring.size();
+		--m_size;
+	}
+	m_cond_notFull.notify_one();
+	return true;
+}
+
+void AnalyzedDocumentQueue::close()
+{
+	{
+		strus::scoped_lock lock( m_mutex);
+		m_closed = true;
+	}
+	m_cond_notEmpty.notify_all();
+	m_cond_notFull.notify_all();
+}
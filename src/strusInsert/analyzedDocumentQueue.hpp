@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_ANALYZED_DOCUMENT_QUEUE_HPP_INCLUDED
+#define _STRUS_INSERTER_ANALYZED_DOCUMENT_QUEUE_HPP_INCLUDED
+#include "strus/analyzer/document.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Document analyzed with the name of the file it was read from
+struct AnalyzedDocument
+{
+	std::string filename;
+	analyzer::Document doc;
+
+	AnalyzedDocument()
+		:filename(),doc(){}
+	explicit AnalyzedDocument( const std::string& filename_)
+		:filename(filename_),doc(){}
+	AnalyzedDocument( const AnalyzedDocument& o)
+		:filename(o.filename),doc(o.doc){}
+};
+
+/// \brief Batch of analyzed documents passed from an analyzer thread to an indexer thread
+/// \note Clearing the batch does not destroy the documents, they are reused with the memory they allocated by the next documents analyzed into the batch
+class AnalyzedDocumentBatch
+{
+public:
+	typedef std::vector<AnalyzedDocument>::const_iterator const_iterator;
+
+	AnalyzedDocumentBatch()
+		:m_ar(),m_size(0){}
+
+	/// \brief Get the next document to fill, appended to the batch
+	AnalyzedDocument& next()
+	{
+		if (m_size == m_ar.size()) m_ar.push_back( AnalyzedDocument());
+		return m_ar[ m_size++];
+	}
+	/// \brief Remove the last document from the batch (if the document returned by next was not filled)
+	void pop_back()
+	{
+		if (m_size) --m_size;
+	}
+	void clear()
+	{
+		m_size = 0;
+	}
+	void swap( AnalyzedDocumentBatch& o)
+	{
+		m_ar.swap( o.m_ar);
+		std::size_t tmp = m_size; m_size = o.m_size; o.m_size = tmp;
+	}
+
+	std::size_t size() const		{return m_size;}
+	bool empty() const			{return m_size == 0;}
+	const_iterator begin() const		{return m_ar.begin();}
+	const_iterator end() const		{return m_ar.begin() + m_size;}
+
+private:
+	std::vector<AnalyzedDocument> m_ar;
+	std::size_t m_size;
+};
+
+/// \brief Bounded ring buffer of batches of analyzed documents between the analyzer and the indexer threads of strusInsert
+/// \note The batches are swapped in and out of the slots of the ring, so the documents of a batch are reused after it has been processed
+class AnalyzedDocumentQueue
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofBatches_ maximum number of batches buffered before an analyzer thread is blocked
+	/// \param[in] batchSize_ number of documents per batch
+	AnalyzedDocumentQueue( std::size_t maxNofBatches_, std::size_t batchSize_);
+
+	/// \brief Get the number of documents an analyzer thread should collect before pushing them as batch
+	std::size_t batchSize() const
+	{
+		return m_batchSize;
+	}
+
+	/// \brief Push a batch of analyzed documents, wait if the queue is full
+	/// \param[in,out] batch batch to push, empty after the call
+	void push( AnalyzedDocumentBatch& batch);
+
+	/// \brief Fetch the next batch of analyzed documents, wait if the queue is empty and not closed
+	/// \param[out] batch where to write the batch fetched to
+	/// \return false if the queue is empty and closed
+	bool pop( AnalyzedDocumentBatch& batch);
+
+	/// \brief Signal that no more batches are pushed, wakes up the indexer threads waiting
+	void close();
+
+private:
+	std::vector<AnalyzedDocumentBatch> m_ring;	///< slots of the ring buffer
+	std::size_t m_head;				///< index of the next slot to pop
+	std::size_t m_size;				///< number of slots filled
+	std::size_t m_batchSize;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cond_notEmpty;
+	strus::condition_variable m_cond_notFull;
+	bool m_closed;
+};
+
+}//namespace
+#endif
@@ -16,21 +16,26 @@
 #include "strus/storageClientInterface.hpp"
 #include "strus/storageTransactionInterface.hpp"
 #include "strus/metaDataReaderInterface.hpp"
+#include "strus/attributeReaderInterface.hpp"
+#include "strus/forwardIteratorInterface.hpp"
 #include "strus/analyzer/document.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/base/fileio.hpp"
 #include "strus/base/string_format.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/shared_ptr.hpp"
 #include "strus/base/thread.hpp"
 #include "strus/base/math.hpp"
+#include "strus/reference.hpp"
 #include "strus/fileCrawlerInterface.hpp"
 #include "private/errorUtils.hpp"
 #include "private/documentAnalyzer.hpp"
 #include "private/internationalization.hpp"
+#include "private/documentInputStream.hpp"
 #include <limits>
 #include <iostream>
+#include <algorithm>
+#include <map>
 #include <stdarg.h>
 
 using namespace strus;
@@ -41,7 +46,11 @@ CheckInsertProcessor::CheckInsertProcessor(
 		const strus::DocumentAnalyzer* analyzerMap_,
 		const analyzer::DocumentClass& defaultDocumentClass_,
 		FileCrawlerInterface* crawler_,
+		bool containerItems_,
+		DocumentClassCache* dclassCache_,
 		const std::string& logfile_,
+		CheckInsertReport* report_,
+		unsigned int batchSize_,
 		ErrorBufferInterface* errorhnd_)
 
 	:m_storage(storage_)
@@ -49,8 +58,12 @@ CheckInsertProcessor::CheckInsertProcessor(
 	,m_analyzerMap(analyzerMap_)
 	,m_defaultDocumentClass(defaultDocumentClass_)
 	,m_crawler(crawler_)
+	,m_containerItems(containerItems_)
+	,m_dclassCache(dclassCache_)
 	,m_terminated(false)
 	,m_logfile(logfile_)
+	,m_report(report_)
+	,m_batchSize(batchSize_ ? batchSize_ : 1)
 	,m_errorhnd(errorhnd_)
 {}
 
@@ -63,6 +76,225 @@ void CheckInsertProcessor::sigStop()
 	m_terminated.set( true);
 }
 
+static bool convertMetaDataValue( strus::NumericVariant& result, double val, strus::NumericVariant::Type type)
+{
+	switch (type)
+	{
+		case strus::NumericVariant::Int:
+			if (val - strus::Math::floor( val) < std::numeric_limits<float>::epsilon())
+			{
+				if (val < 0.0)
+				{
+					result = strus::NumericVariant( (int64_t)(strus::Math::floor( val - std::numeric_limits<float>::epsilon())));
+				}
+				else
+				{
+					result = strus::NumericVariant( (int64_t)(strus::Math::floor( val + std::numeric_limits<float>::epsilon())));
+				}
+				return true;
+			}
+			std::cerr << string_format( _TXT( "meta data assignment is not convertible to the type expected: (%s) %.4f"), "int", val) << std::endl;
+			return false;
+		case strus::NumericVariant::UInt:
+			if (val - strus::Math::floor( val) < std::numeric_limits<float>::epsilon()
+			|| (val + std::numeric_limits<float>::epsilon()) > 0.0)
+			{
+				result = strus::NumericVariant( (uint64_t)(strus::Math::floor( val + std::numeric_limits<float>::epsilon())));
+				return true;
+			}
+			std::cerr << string_format( _TXT( "meta data assignment is not convertible to the type expected: (%s) %.4f"), "unsigned int", val) << std::endl;
+			return false;
+		case strus::NumericVariant::Float:
+		case strus::NumericVariant::Null:
+			result = strus::NumericVariant( (float) val);
+			return true;
+	}
+	return false;
+}
+
+static bool equalMetaDataValue( const strus::NumericVariant& expected, const strus::NumericVariant& found)
+{
+	if (!found.defined()) return false;
+	double ev = expected;
+	double fv = found;
+	if (expected.type == strus::NumericVariant::Float)
+	{
+		// Floating point values may be stored with reduced precision (float16):
+		double diff = ev > fv ? (ev - fv) : (fv - ev);
+		double scale = ev < 0.0 ? -ev : ev;
+		return diff <= 1E-3 * (scale > 1.0 ? scale : 1.0);
+	}
+	return ev == fv;
+}
+
+void CheckInsertProcessor::ExpectedDocument::clear()
+{
+	docid.clear();
+	docno = 0;
+	forwardIndexCounts.clear();
+	attributes.clear();
+	metadata.clear();
+}
+
+void CheckInsertProcessor::initExpectedDocument(
+		ExpectedDocument& expected,
+		const analyzer::Document& doc,
+		const std::string& docid,
+		const MetaDataReaderInterface* metadata,
+		const std::vector<NumericVariant::Type>& metadatatype) const
+{
+	expected.clear();
+	expected.docid = docid;
+
+	// Count the forward index terms per type, the storage keeps one term per type and position:
+	std::vector<std::pair<std::string,int> > typepos;
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		fi = doc.forwardIndexTerms().begin(),
+		fe = doc.forwardIndexTerms().end();
+	for (; fi != fe; ++fi)
+	{
+		if (fi->pos() > 0 && fi->pos() <= (int)Constants::storage_max_position_info())
+		{
+			typepos.push_back( std::pair<std::string,int>( fi->type(), fi->pos()));
+		}
+	}
+	std::sort( typepos.begin(), typepos.end());
+	typepos.erase( std::unique( typepos.begin(), typepos.end()), typepos.end());
+	std::vector<std::pair<std::string,int> >::const_iterator ti = typepos.begin(), te = typepos.end();
+	while (ti != te)
+	{
+		std::vector<std::pair<std::string,int> >::const_iterator start = ti;
+		for (++ti; ti != te && ti->first == start->first; ++ti){}
+		expected.forwardIndexCounts.push_back( std::pair<std::string,int>( start->first, ti - start));
+	}
+
+	// Collect the attributes, the docid is the key of the document and not compared:
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		if (ai->name() == strus::Constants::attribute_docid()) continue;
+		expected.attributes.push_back( std::pair<std::string,std::string>( ai->name(), ai->value()));
+	}
+
+	// Collect the meta data converted to the types in the storage, an undefined value is reported as mismatch:
+	std::vector<strus::analyzer::DocumentMetaData>::const_iterator
+		mi = doc.metadata().begin(), me = doc.metadata().end();
+	for (; mi != me; ++mi)
+	{
+		strus::NumericVariant av;
+		Index midx = metadata->elementHandle( mi->name());
+		if (midx < 0)
+		{
+			(void)m_errorhnd->fetchError();
+		}
+		else if (!convertMetaDataValue( av, mi->value(), metadatatype[midx]))
+		{
+			av = strus::NumericVariant();
+		}
+		expected.metadata.push_back( std::pair<std::string,NumericVariant>( mi->name(), av));
+	}
+}
+
+void CheckInsertProcessor::checkBatch( std::vector<ExpectedDocument>& batch, std::size_t batchsize, CheckInsertSummary& summary)
+{
+	std::vector<std::size_t> order;
+	order.reserve( batchsize);
+	for (std::size_t bi=0; bi<batchsize; ++bi) order.push_back( bi);
+
+	// Resolve the document numbers in ascending order of the docids for locality of the key lookups:
+	std::sort( order.begin(), order.end(), DocidOrder( batch));
+	std::vector<std::size_t>::const_iterator oi = order.begin(), oe = order.end();
+	for (; oi != oe; ++oi)
+	{
+		batch[ *oi].docno = m_storage->documentNumber( batch[ *oi].docid);
+	}
+	if (m_errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("error resolving document numbers: %s"), m_errorhnd->fetchError());
+	}
+	// Visit the documents in ascending order of the document numbers, so that the readers created for the batch are only moved forward:
+	std::sort( order.begin(), order.end(), DocnoOrder( batch));
+
+	strus::local_ptr<strus::MetaDataReaderInterface> mdreader( m_storage->createMetaDataReader());
+	if (!mdreader.get()) throw std::runtime_error( _TXT("error creating meta data reader"));
+	strus::local_ptr<strus::AttributeReaderInterface> areader( m_storage->createAttributeReader());
+	if (!areader.get()) throw std::runtime_error( _TXT("error creating attribute reader"));
+	typedef strus::Reference<strus::ForwardIteratorInterface> ForwardIteratorReference;
+	typedef std::map<std::string,ForwardIteratorReference> ForwardIteratorMap;
+	ForwardIteratorMap fwditrmap;
+
+	for (oi = order.begin(); oi != oe; ++oi)
+	{
+		const ExpectedDocument& expected = batch[ *oi];
+		if (!expected.docno)
+		{
+			summary.addMissing( expected.docid);
+			continue;
+		}
+		bool differing = false;
+
+		mdreader->skipDoc( expected.docno);
+		std::vector<std::pair<std::string,NumericVariant> >::const_iterator
+			mi = expected.metadata.begin(), me = expected.metadata.end();
+		for (; mi != me; ++mi)
+		{
+			Index midx = mdreader->elementHandle( mi->first);
+			if (midx < 0)
+			{
+				(void)m_errorhnd->fetchError();
+				//... an unknown element is reported in the summary
+			}
+			if (midx < 0 || !mi->second.defined() || !equalMetaDataValue( mi->second, mdreader->getValue( midx)))
+			{
+				summary.addMetaDataMismatch( mi->first);
+				differing = true;
+			}
+		}
+		areader->skipDoc( expected.docno);
+		std::vector<std::pair<std::string,std::string> >::const_iterator
+			ai = expected.attributes.begin(), ae = expected.attributes.end();
+		for (; ai != ae; ++ai)
+		{
+			Index aidx = areader->elementHandle( ai->first);
+			if (!aidx)
+			{
+				(void)m_errorhnd->fetchError();
+			}
+			if (!aidx || areader->getValue( aidx) != ai->second)
+			{
+				summary.addAttributeMismatch( ai->first);
+				differing = true;
+			}
+		}
+		std::vector<std::pair<std::string,int> >::const_iterator
+			fi = expected.forwardIndexCounts.begin(), fe = expected.forwardIndexCounts.end();
+		for (; fi != fe; ++fi)
+		{
+			ForwardIteratorMap::iterator wi = fwditrmap.find( fi->first);
+			if (wi == fwditrmap.end())
+			{
+				wi = fwditrmap.insert( ForwardIteratorMap::value_type( fi->first, ForwardIteratorReference( m_storage->createForwardIterator( fi->first)))).first;
+				if (!wi->second.get())
+				{
+					(void)m_errorhnd->fetchError();
+					//... an unknown type is reported in the summary with no terms found
+				}
+			}
+			int found = 0;
+			if (wi->second.get())
+			{
+				wi->second->skipDoc( expected.docno);
+				Index pos = 0;
+				while (0 != (pos = wi->second->skipPos( pos+1))) ++found;
+			}
+			summary.addForwardIndexCount( fi->first, fi->second, found);
+			if (found != fi->second) differing = true;
+		}
+		summary.addChecked( expected.docid, differing);
+	}
+}
+
 void CheckInsertProcessor::run()
 {
 	try
@@ -99,6 +331,12 @@ void CheckInsertProcessor::run()
 			}
 		}
 		unsigned int filesChecked = 0;
+		strus::analyzer::Document doc;
+		//... reused for all documents analyzed to keep the memory allocated
+		std::vector<ExpectedDocument> batch;
+		std::size_t batchsize = 0;
+		CheckInsertSummary summary;
+		//... documents to check in the summary mode, elements reused for all batches
 		while (!(files=m_crawler->fetch()).empty())
 		{
 			fitr = files.begin();
@@ -106,10 +344,14 @@ void CheckInsertProcessor::run()
 			{
 				try
 				{
-					strus::InputStream input( *fitr);
+					strus::utils::DocumentInputStream input( *fitr, m_containerItems);
 					strus::local_ptr<strus::DocumentAnalyzerContextInterface> analyzerContext;
 					strus::analyzer::DocumentClass dclass;
-					if (!m_defaultDocumentClass.defined())
+					if (m_defaultDocumentClass.defined())
+					{
+						dclass = m_defaultDocumentClass;
+					}
+					else if (!getCachedDocumentClass( m_dclassCache, dclass, *fitr))
 					{
 						// Read the input file to analyze and detect its document type:
 						char hdrbuf[ 4096];
@@ -119,16 +361,12 @@ void CheckInsertProcessor::run()
 							std::cerr << string_format( _TXT( "failed to read document file '%s': %s"), fitr->c_str(), ::strerror( input.error())) << std::endl; 
 							continue;
 						}
-						if (!m_textproc->detectDocumentClass( dclass, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf)))
+						if (!detectDocumentClass( m_dclassCache, dclass, *fitr, m_textproc, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf)))
 						{
 							std::cerr << string_format( _TXT( "failed to detect document class of file '%s'"), fitr->c_str()) << std::endl; 
 							continue;
 						}
 					}
-					else
-					{
-						dclass = m_defaultDocumentClass;
-					}
 					const strus::DocumentAnalyzerInstanceInterface* analyzer = m_analyzerMap->get( dclass);
 					if (analyzer)
 					{
@@ -161,7 +399,6 @@ void CheckInsertProcessor::run()
 						analyzerContext->putInput( buf, readsize, eof);
 
 						// Analyze the document and print the result:
-						strus::analyzer::Document doc;
 						while (analyzerContext->analyzeNext( doc))
 						{
 							std::vector<strus::analyzer::DocumentAttribute>::const_iterator
@@ -170,6 +407,20 @@ void CheckInsertProcessor::run()
 							for (;oi != oe
 								&& oi->name() != strus::Constants::attribute_docid();
 								++oi){}
+							if (m_report)
+							{
+								// Collect the document to check it with the next batch:
+								if (batchsize == batch.size()) batch.push_back( ExpectedDocument());
+								initExpectedDocument( batch[ batchsize++], doc, (oi != oe) ? oi->value() : *fitr, metadata.get(), metadatatype);
+								if (batchsize >= m_batchSize)
+								{
+									std::size_t nofDocs = batchsize;
+									batchsize = 0;
+									checkBatch( batch, nofDocs, summary);
+									m_report->merge( summary);
+								}
+								continue;
+							}
 							const char* docid = 0;
 							strus::local_ptr<strus::StorageDocumentInterface> storagedoc;
 							if (oi != oe)
@@ -255,49 +506,18 @@ void CheckInsertProcessor::run()
 								mi = doc.metadata().begin(), me = doc.metadata().end();
 							for (; mi != me; ++mi)
 							{
-								double val = mi->value();
 								Index midx = metadata->elementHandle( mi->name());
 								if (midx < 0)
 								{
 									std::cerr << string_format( _TXT( "unknown meta data element '%s'"), mi->name().c_str()) << std::endl;
 								}
-								else switch (metadatatype[midx])
+								else
 								{
-									case strus::NumericVariant::Int:
-										if (val - strus::Math::floor( val) < std::numeric_limits<float>::epsilon())
-										{
-											if (val < 0.0)
-											{
-												strus::NumericVariant av( (int64_t)(strus::Math::floor( val - std::numeric_limits<float>::epsilon())));
-												storagedoc->setMetaData( mi->name(), av);
-											}
-											else
-											{
-												strus::NumericVariant av( (int64_t)(strus::Math::floor( val + std::numeric_limits<float>::epsilon())));
-												storagedoc->setMetaData( mi->name(), av);
-											}
-										}
-										else
-										{
-											std::cerr << string_format( _TXT( "meta data assignment is not convertible to the type expected: (%s) %.4f"), "int", val) << std::endl;
-										}
-										break;
-									case strus::NumericVariant::UInt:
-										if (val - strus::Math::floor( val) < std::numeric_limits<float>::epsilon()
-										|| (val + std::numeric_limits<float>::epsilon()) > 0.0)
-										{
-											strus::NumericVariant av( (uint64_t)(strus::Math::floor( val + std::numeric_limits<float>::epsilon())));
-											storagedoc->setMetaData( mi->name(), av);
-										}
-										else
-										{
-											std::cerr << string_format( _TXT( "meta data assignment is not convertible to the type expected: (%s) %.4f"), "unsigned int", val) << std::endl;
-										}
-										break;
-									case strus::NumericVariant::Float:
-									case strus::NumericVariant::Null:
-										storagedoc->setMetaData( mi->name(), (float) val);
-										break;
+									strus::NumericVariant av;
+									if (convertMetaDataValue( av, mi->value(), metadatatype[midx]))
+									{
+										storagedoc->setMetaData( mi->name(), av);
+									}
 								}
 							}
 							// Issue warning for documents cut because they are too big to insert:
@@ -331,6 +551,11 @@ void CheckInsertProcessor::run()
 					?_TXT( "\rchecked %u file"):_TXT( "\rchecked %u files"),
 					filesChecked) << std::endl;
 		}
+		if (batchsize)
+		{
+			checkBatch( batch, batchsize, summary);
+			m_report->merge( summary);
+		}
 	}
 	catch (const std::bad_alloc& err)
 	{
@@ -8,8 +8,15 @@
 #ifndef _STRUS_CHECK_INSERT_PROCESSOR_HPP_INCLUDED
 #define _STRUS_CHECK_INSERT_PROCESSOR_HPP_INCLUDED
 #include "private/documentAnalyzer.hpp"
+#include "private/documentClassCache.hpp"
+#include "checkInsertSummary.hpp"
+#include "strus/storage/index.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/analyzer/document.hpp"
 #include "strus/base/atomic.hpp"
 #include <string>
+#include <vector>
+#include <utility>
 
 namespace strus {
 
@@ -23,6 +30,8 @@ class DocumentAnalyzerInstanceInterface;
 class FileCrawlerInterface;
 /// \brief Forward declaration
 class ErrorBufferInterface;
+/// \brief Forward declaration
+class MetaDataReaderInterface;
 
 class CheckInsertProcessor
 {
@@ -33,7 +42,11 @@ public:
 			const strus::DocumentAnalyzer* analyzerMap_,
 			const analyzer::DocumentClass& defaultDocumentClass_,
 			FileCrawlerInterface* crawler_,
+			bool containerItems_,
+			DocumentClassCache* dclassCache_,
 			const std::string& logfile_,
+			CheckInsertReport* report_,
+			unsigned int batchSize_,
 			ErrorBufferInterface* errorhnd_);
 
 	~CheckInsertProcessor();
@@ -41,14 +54,61 @@ public:
 	void sigStop();
 	void run();
 
+private:
+	/// \brief Data of an analyzed document compared with the storage in the summary mode
+	struct ExpectedDocument
+	{
+		std::string docid;
+		Index docno;
+		std::vector<std::pair<std::string,int> > forwardIndexCounts;		///< number of forward index terms per type
+		std::vector<std::pair<std::string,std::string> > attributes;
+		std::vector<std::pair<std::string,NumericVariant> > metadata;
+
+		ExpectedDocument()
+			:docid(),docno(0),forwardIndexCounts(),attributes(),metadata(){}
+		void clear();
+	};
+	/// \brief Order of the indices of a batch of expected documents by docid
+	struct DocidOrder
+	{
+		const std::vector<ExpectedDocument>* ar;
+		explicit DocidOrder( const std::vector<ExpectedDocument>& ar_) :ar(&ar_){}
+		bool operator()( std::size_t aa, std::size_t bb) const
+		{
+			return (*ar)[ aa].docid < (*ar)[ bb].docid;
+		}
+	};
+	/// \brief Order of the indices of a batch of expected documents by docno
+	struct DocnoOrder
+	{
+		const std::vector<ExpectedDocument>* ar;
+		explicit DocnoOrder( const std::vector<ExpectedDocument>& ar_) :ar(&ar_){}
+		bool operator()( std::size_t aa, std::size_t bb) const
+		{
+			return (*ar)[ aa].docno < (*ar)[ bb].docno;
+		}
+	};
+
+	void initExpectedDocument(
+			ExpectedDocument& expected,
+			const analyzer::Document& doc,
+			const std::string& docid,
+			const MetaDataReaderInterface* metadata,
+			const std::vector<NumericVariant::Type>& metadatatype) const;
+	void checkBatch( std::vector<ExpectedDocument>& batch, std::size_t batchsize, CheckInsertSummary& summary);
+
 private:
 	StorageClientInterface* m_storage;
 	const TextProcessorInterface* m_textproc;
 	const strus::DocumentAnalyzer* m_analyzerMap;
 	analyzer::DocumentClass m_defaultDocumentClass;
 	FileCrawlerInterface* m_crawler;
+	bool m_containerItems;
+	DocumentClassCache* m_dclassCache;
 	strus::AtomicFlag m_terminated;
 	std::string m_logfile;
+	CheckInsertReport* m_report;
+	unsigned int m_batchSize;
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "checkInsertSummary.hpp"
+#include "strus/base/string_format.hpp"
+#include "private/internationalization.hpp"
+#include "private/jsonUtils.hpp"
+#include "strus/base/math.hpp"
+#include <cstring>
+#include <cerrno>
+
+using namespace strus;
+
+static void addSample( std::vector<std::string>& sample, const std::string& docid)
+{
+	if (sample.size() < (std::size_t)CheckInsertSummary::MaxNofSampleDocids)
+	{
+		sample.push_back( docid);
+	}
+}
+
+void CheckInsertSummary::addChecked( const std::string& docid, bool differing)
+{
+	m_nofChecked += 1;
+	if (differing)
+	{
+		m_nofDiffering += 1;
+		addSample( m_differingSample, docid);
+	}
+}
+
+void CheckInsertSummary::addMissing( const std::string& docid)
+{
+	m_nofMissing += 1;
+	addSample( m_missingSample, docid);
+}
+
+void CheckInsertSummary::addMetaDataMismatch( const std::string& name)
+{
+	m_metadata[ name].nofMismatches += 1;
+}
+
+void CheckInsertSummary::addAttributeMismatch( const std::string& name)
+{
+	m_attributes[ name].nofMismatches += 1;
+}
+
+void CheckInsertSummary::addForwardIndexCount( const std::string& type, int expected, int found)
+{
+	ElementDiff& ed = m_forwardIndex[ type];
+	ed.nofDocuments += 1;
+	ed.expected += expected;
+	ed.found += found;
+	if (expected != found) ed.nofMismatches += 1;
+}
+
+void CheckInsertSummary::mergeElementDiffMap( ElementDiffMap& dest, const ElementDiffMap& src)
+{
+	ElementDiffMap::const_iterator si = src.begin(), se = src.end();
+	for (; si != se; ++si)
+	{
+		ElementDiff& ed = dest[ si->first];
+		ed.nofDocuments += si->second.nofDocuments;
+		ed.nofMismatches += si->second.nofMismatches;
+		ed.expected += si->second.expected;
+		ed.found += si->second.found;
+	}
+}
+
+void CheckInsertSummary::mergeSample( std::vector<std::string>& dest, const std::vector<std::string>& src)
+{
+	std::vector<std::string>::const_iterator si = src.begin(), se = src.end();
+	for (; si != se; ++si)
+	{
+		addSample( dest, *si);
+	}
+}
+
+void CheckInsertSummary::merge( const CheckInsertSummary& o)
+{
+	m_nofChecked += o.m_nofChecked;
+	m_nofMissing += o.m_nofMissing;
+	m_nofDiffering += o.m_nofDiffering;
+	mergeElementDiffMap( m_metadata, o.m_metadata);
+	mergeElementDiffMap( m_attributes, o.m_attributes);
+	mergeElementDiffMap( m_forwardIndex, o.m_forwardIndex);
+	mergeSample( m_missingSample, o.m_missingSample);
+	mergeSample( m_differingSample, o.m_differingSample);
+}
+
+void CheckInsertSummary::clear()
+{
+	m_nofChecked = 0;
+	m_nofMissing = 0;
+	m_nofDiffering = 0;
+	m_metadata.clear();
+	m_attributes.clear();
+	m_forwardIndex.clear();
+	m_missingSample.clear();
+	m_differingSample.clear();
+}
+
+static void printJsonStringList( FILE* out, const std::vector<std::string>& list)
+{
+	::fputc( '[', out);
+	std::vector<std::string>::const_iterator li = list.begin(), le = list.end();
+	for (; li != le; ++li)
+	{
+		if (li != list.begin()) ::fputc( ',', out);
+		utils::printJsonString( out, *li);
+	}
+	::fputc( ']', out);
+}
+
+void CheckInsertSummary::printElementDiffMap( FILE* out, const ElementDiffMap& map, bool withCounts)
+{
+	::fputc( '{', out);
+	ElementDiffMap::const_iterator mi = map.begin(), me = map.end();
+	for (; mi != me; ++mi)
+	{
+		if (mi != map.begin()) ::fputc( ',', out);
+		utils::printJsonString( out, mi->first);
+		if (withCounts)
+		{
+			::fprintf( out, ":{\"documents\":%llu,\"mismatches\":%llu,\"expected\":%lld,\"found\":%lld,\"delta\":%lld}",
+					(unsigned long long)mi->second.nofDocuments,
+					(unsigned long long)mi->second.nofMismatches,
+					(long long)mi->second.expected,
+					(long long)mi->second.found,
+					(long long)(mi->second.found - mi->second.expected));
+		}
+		else
+		{
+			::fprintf( out, ":%llu", (unsigned long long)mi->second.nofMismatches);
+		}
+	}
+	::fputc( '}', out);
+}
+
+void CheckInsertSummary::printSampleEstimate( FILE* out, uint64_t count, uint64_t nofDocuments, double sampleRate)
+{
+	// Wilson score interval for the 95% confidence level, treating the documents of the sample as independent draws:
+	static const double z = 1.959964;
+	double lower = 0.0;
+	double upper = 1.0;
+	double rate = 0.0;
+	if (nofDocuments)
+	{
+		double nn = (double)nofDocuments;
+		rate = (double)count / nn;
+		double denom = 1.0 + z*z / nn;
+		double center = (rate + z*z / (2.0*nn)) / denom;
+		double halfwidth = z * strus::Math::sqrt( rate * (1.0 - rate) / nn + z*z / (4.0*nn*nn)) / denom;
+		lower = center - halfwidth;
+		upper = center + halfwidth;
+		if (lower < 0.0) lower = 0.0;
+		if (upper > 1.0) upper = 1.0;
+	}
+	::fprintf( out, "{\"rate\":%.6f,\"lower\":%.6f,\"upper\":%.6f,\"estimate\":%.0f}",
+			rate, lower, upper, (double)count / sampleRate);
+}
+
+void CheckInsertSummary::print( FILE* out, double sampleRate, unsigned int sampleSeed) const
+{
+	::fprintf( out, "{\"documents\":%llu,\"checked\":%llu,\"missing\":%llu,\"differing\":%llu",
+			(unsigned long long)(m_nofChecked + m_nofMissing),
+			(unsigned long long)m_nofChecked,
+			(unsigned long long)m_nofMissing,
+			(unsigned long long)m_nofDiffering);
+	::fprintf( out, ",\n\"missing_docids\":");
+	printJsonStringList( out, m_missingSample);
+	::fprintf( out, ",\n\"differing_docids\":");
+	printJsonStringList( out, m_differingSample);
+	::fprintf( out, ",\n\"metadata_mismatches\":");
+	printElementDiffMap( out, m_metadata, false);
+	::fprintf( out, ",\n\"attribute_mismatches\":");
+	printElementDiffMap( out, m_attributes, false);
+	::fprintf( out, ",\n\"forward_index_terms\":");
+	printElementDiffMap( out, m_forwardIndex, true);
+	if (sampleRate > 0.0)
+	{
+		// The estimates of the number of documents in the whole collection divide the counts by the sample rate:
+		uint64_t nofDocuments = m_nofChecked + m_nofMissing;
+		::fprintf( out, ",\n\"sample\":{\"rate\":%.6f,\"seed\":%u,\"confidence\":0.95,\"documents\":%.0f", sampleRate, sampleSeed, (double)nofDocuments / sampleRate);
+		::fprintf( out, ",\"missing\":");
+		printSampleEstimate( out, m_nofMissing, nofDocuments, sampleRate);
+		::fprintf( out, ",\"differing\":");
+		printSampleEstimate( out, m_nofDiffering, nofDocuments, sampleRate);
+		::fprintf( out, "}");
+	}
+	::fprintf( out, "}\n");
+}
+
+void CheckInsertReport::merge( CheckInsertSummary& part)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_total.merge( part);
+	part.clear();
+}
+
+void CheckInsertReport::write( const std::string& outputfile)
+{
+	strus::scoped_lock lock( m_mutex);
+	if (outputfile == "-")
+	{
+		m_total.print( stdout, m_sampleRate, m_sampleSeed);
+		::fflush( stdout);
+	}
+	else
+	{
+		FILE* out = ::fopen( outputfile.c_str(), "w");
+		if (!out) throw strus::runtime_error( _TXT("failed to open summary output file '%s' for writing: %s"), outputfile.c_str(), ::strerror(errno));
+		m_total.print( out, m_sampleRate, m_sampleSeed);
+		if (::fclose( out) != 0) throw strus::runtime_error( _TXT("failed to write summary output file '%s': %s"), outputfile.c_str(), ::strerror(errno));
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_CHECK_INSERT_SUMMARY_HPP_INCLUDED
+#define _STRUS_CHECK_INSERT_SUMMARY_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "strus/base/stdint.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdio>
+
+namespace strus {
+
+/// \brief Differences between the documents analyzed and the documents in the storage, collected by one checker thread
+class CheckInsertSummary
+{
+public:
+	/// \brief Maximum number of document ids listed as examples of missing or differing documents
+	enum {MaxNofSampleDocids=100};
+
+	CheckInsertSummary()
+		:m_nofChecked(0),m_nofMissing(0),m_nofDiffering(0){}
+
+	/// \brief Count a document found in the storage
+	/// \param[in] docid document id
+	/// \param[in] differing true, if any difference has been found for this document
+	void addChecked( const std::string& docid, bool differing);
+	/// \brief Count a document not found in the storage
+	void addMissing( const std::string& docid);
+	/// \brief Count a meta data element with a value different from the one analyzed
+	void addMetaDataMismatch( const std::string& name);
+	/// \brief Count an attribute with a value different from the one analyzed
+	void addAttributeMismatch( const std::string& name);
+	/// \brief Add the number of forward index terms of a type analyzed and found in the storage for a document
+	void addForwardIndexCount( const std::string& type, int expected, int found);
+
+	void merge( const CheckInsertSummary& o);
+	void clear();
+
+	/// \brief Write the summary as JSON object
+	/// \param[in] out where to write the summary to
+	/// \param[in] sampleRate fraction of the files checked if only a sample has been checked, 0.0 if all files have been checked
+	/// \param[in] sampleSeed seed of the sample selection
+	/// \note For a sample the summary includes the confidence intervals of the rates of missing and differing documents
+	void print( FILE* out, double sampleRate, unsigned int sampleSeed) const;
+
+private:
+	struct ElementDiff
+	{
+		uint64_t nofDocuments;		///< number of documents checked with this element
+		uint64_t nofMismatches;		///< number of documents with a different value or term count
+		int64_t expected;		///< number of terms analyzed (forward index only)
+		int64_t found;			///< number of terms found in the storage (forward index only)
+
+		ElementDiff()
+			:nofDocuments(0),nofMismatches(0),expected(0),found(0){}
+	};
+	typedef std::map<std::string,ElementDiff> ElementDiffMap;
+
+	static void mergeElementDiffMap( ElementDiffMap& dest, const ElementDiffMap& src);
+	static void mergeSample( std::vector<std::string>& dest, const std::vector<std::string>& src);
+	static void printElementDiffMap( FILE* out, const ElementDiffMap& map, bool withCounts);
+	static void printSampleEstimate( FILE* out, uint64_t count, uint64_t nofDocuments, double sampleRate);
+
+private:
+	uint64_t m_nofChecked;
+	uint64_t m_nofMissing;
+	uint64_t m_nofDiffering;
+	ElementDiffMap m_metadata;
+	ElementDiffMap m_attributes;
+	ElementDiffMap m_forwardIndex;
+	std::vector<std::string> m_missingSample;	///< first document ids not found in the storage
+	std::vector<std::string> m_differingSample;	///< first document ids found in the storage with differences
+};
+
+/// \brief Summary of the differences found by all checker threads
+class CheckInsertReport
+{
+public:
+	/// \brief Constructor
+	/// \param[in] sampleRate_ fraction of the files checked if only a sample is checked, 0.0 if all files are checked
+	/// \param[in] sampleSeed_ seed of the sample selection
+	explicit CheckInsertReport( double sampleRate_=0.0, unsigned int sampleSeed_=0)
+		:m_sampleRate(sampleRate_),m_sampleSeed(sampleSeed_){}
+
+	/// \brief Merge the differences found by a thread
+	/// \param[in,out] part summary of the thread, cleared after merge
+	void merge( CheckInsertSummary& part);
+
+	/// \brief Write the summary of all differences found
+	/// \param[in] outputfile file to write the report to, "-" for stdout
+	void write( const std::string& outputfile);
+
+private:
+	strus::mutex m_mutex;
+	CheckInsertSummary m_total;
+	double m_sampleRate;
+	unsigned int m_sampleSeed;
+};
+
+}//namespace
+#endif
@@ -14,78 +14,208 @@
 
 using namespace strus;
 
-void CommitQueue::handleWaitingTransactions()
+CommitQueue::CommitQueue(
+		StorageClientInterface* storage_,
+		bool verbose_,
+		int nofCommitThreads_,
+		int maxNofOpenTransactions_,
+		std::size_t maxBufferedBytes_,
+		InsertProfiler* profiler_,
+		TransactionSizeControl* sizeControl_,
+		InsertJournal* journal_,
+		ErrorBufferInterface* errorhnd_)
+	:m_storage(storage_),m_nofDocuments(0),m_nofOpenTransactions(0),m_bufferedBytes(0)
+	,m_maxNofOpenTransactions(maxNofOpenTransactions_ > 0 ? maxNofOpenTransactions_ : 1)
+	,m_maxBufferedBytes(maxBufferedBytes_)
+	,m_closed(false),m_profilerContext(profiler_, "commit queue")
+	,m_sizeControl(sizeControl_)
+	,m_journal(journal_)
+	,m_verbose(verbose_),m_errorhnd(errorhnd_)
 {
-	for (;;)
+	m_nofDocuments = m_storage->nofDocumentsInserted();
+	for (int ti=0; ti<nofCommitThreads_; ++ti)
+	{
+		m_commitThreads.push_back( new strus::thread( &CommitQueue::commitThreadMain, this));
+	}
+}
+
+CommitQueue::~CommitQueue()
+{
+	close();
+}
+
+void CommitQueue::close()
+{
+	{
+		strus::scoped_lock lock( m_mutex_openTransactions);
+		if (m_closed) return;
+		m_closed = true;
+	}
+	m_cond_notEmpty.notify_all();
+	m_cond_notFull.notify_all();
+	std::vector<Reference<strus::thread> >::iterator
+		ti = m_commitThreads.begin(), te = m_commitThreads.end();
+	for (; ti != te; ++ti) (*ti)->join();
+	m_commitThreads.clear();
+
+	// Commit what might be left in the queue, if there were no commit threads:
+	handleWaitingTransactions();
+}
+
+void CommitQueue::commitTransaction( const OpenTransaction& open)
+{
+	try
 	{
-		try
+		InsertProfilerTimer timer( &m_profilerContext);
+		uint64_t startTime = m_sizeControl->adaptive() ? InsertProfilerTimer::wallClock() : 0;
+		strus::StorageCommitResult cmres = open.transaction->commit();
+		if (startTime && cmres.success())
 		{
-			Reference<StorageTransactionInterface> transaction = getNextTransaction();
-			if (!transaction.get()) break;
-			strus::StorageCommitResult cmres = transaction->commit();
-			if (!cmres.success())
-			{
-				throw std::runtime_error( _TXT("transaction commit failed"));
-			}
-			Index totalNofDocuments = m_storage->nofDocumentsInserted();
-			Index nofDocsInserted = totalNofDocuments - m_nofDocuments;
-			if (m_verbose)
-			{
-				::fprintf( stderr, _TXT("inserted %u documents (total %u)\n"),
-						nofDocsInserted, totalNofDocuments);
-				::fflush( stderr);
-			}
-			else
-			{
-				::fprintf( stderr, _TXT("\rinserted %u documents (total %u)          "),
-						nofDocsInserted, totalNofDocuments);
-				::fflush( stderr);
-			}
+			// The latency of a failed commit says nothing about the throughput, it is not reported:
+			m_sizeControl->reportCommit( open.bufferedBytes, InsertProfilerTimer::wallClock() - startTime);
+		}
+		if (m_profilerContext.enabled())
+		{
+			strus::scoped_lock lock( m_mutex_profiler);
+			timer.stop( InsertProfiler::StageCommit);
+			m_profilerContext.flush();
 		}
-		catch (const std::bad_alloc&)
+		if (!cmres.success())
 		{
-			m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory handling transaction in queue"));
-			::fprintf( stderr, _TXT("out of memory handling transaction in queue\n"));
+			throw std::runtime_error( _TXT("transaction commit failed"));
+		}
+		Index totalNofDocuments = m_storage->nofDocumentsInserted();
+		Index nofDocsInserted = totalNofDocuments - m_nofDocuments;
+		if (m_journal)
+		{
+			m_journal->transactionCommitted( open.files, totalNofDocuments);
+		}
+		if (m_verbose)
+		{
+			::fprintf( stderr, _TXT("inserted %u documents (total %u)\n"),
+					nofDocsInserted, totalNofDocuments);
 			::fflush( stderr);
 		}
-		catch (const std::exception& err)
+		else
 		{
-			const char* errmsg = m_errorhnd->fetchError();
-			if (errmsg)
-			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error handling transaction in queue: %s, %s"), err.what(), errmsg);
-				::fprintf( stderr, _TXT("error handling transaction in queue: %s, %s\n"), err.what(), errmsg);
-				::fflush( stderr);
-			}
-			else
+			::fprintf( stderr, _TXT("\rinserted %u documents (total %u)          "),
+					nofDocsInserted, totalNofDocuments);
+			::fflush( stderr);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory handling transaction in queue"));
+		::fprintf( stderr, _TXT("out of memory handling transaction in queue\n"));
+		::fflush( stderr);
+	}
+	catch (const std::exception& err)
+	{
+		const char* errmsg = m_errorhnd->fetchError();
+		if (errmsg)
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error handling transaction in queue: %s, %s"), err.what(), errmsg);
+			::fprintf( stderr, _TXT("error handling transaction in queue: %s, %s\n"), err.what(), errmsg);
+			::fflush( stderr);
+		}
+		else
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error handling transaction in queue: %s"), err.what());
+			::fprintf( stderr, _TXT("error handling transaction in queue: %s\n"), err.what());
+			::fflush( stderr);
+		}
+		strus::scoped_lock lock( m_mutex_errors);
+		m_errors.push_back( m_errorhnd->fetchError());
+	}
+}
+
+void CommitQueue::handleWaitingTransactions()
+{
+	for (;;)
+	{
+		OpenTransaction open = getNextTransaction();
+		if (!open.transaction.get()) break;
+		commitTransaction( open);
+	}
+}
+
+void CommitQueue::commitThreadMain()
+{
+	for (;;)
+	{
+		OpenTransaction open;
+		{
+			strus::unique_lock lock( m_mutex_openTransactions);
+			while (m_openTransactions.empty() && !m_closed)
 			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error handling transaction in queue: %s"), err.what());
-				::fprintf( stderr, _TXT("error handling transaction in queue: %s\n"), err.what());
-				::fflush( stderr);
+				m_cond_notEmpty.wait( lock);
 			}
-			strus::scoped_lock lock( m_mutex_errors);
-			m_errors.push_back( m_errorhnd->fetchError());
+			if (m_openTransactions.empty()) break;
+			//... the queue is drained before the thread terminates on close
+			open = m_openTransactions.front();
+			m_openTransactions.pop();
 		}
+		commitTransaction( open);
+		open.transaction.reset();
+		{
+			// The transaction is counted as open until its commit is finished,
+			// because it occupies memory until then:
+			strus::scoped_lock lock( m_mutex_openTransactions);
+			--m_nofOpenTransactions;
+			m_bufferedBytes -= open.bufferedBytes;
+		}
+		m_cond_notFull.notify_all();
 	}
+	m_errorhnd->releaseContext();
 }
 
-void CommitQueue::pushTransaction( StorageTransactionInterface* transaction)
+void CommitQueue::pushTransaction( StorageTransactionInterface* transaction, std::size_t bufferedBytes, InsertJournal::FileDocumentsList& files, InsertProfilerContext* profilerContext)
 {
+	if (m_commitThreads.empty())
 	{
-		strus::scoped_lock lock( m_mutex_openTransactions);
-		m_openTransactions.push( StorageTransactionReference( transaction));
-		++m_nofOpenTransactions;
+		{
+			strus::scoped_lock lock( m_mutex_openTransactions);
+			m_openTransactions.push( OpenTransaction( StorageTransactionReference( transaction), bufferedBytes));
+			m_openTransactions.back().files.swap( files);
+			++m_nofOpenTransactions;
+			m_bufferedBytes += bufferedBytes;
+		}
+		handleWaitingTransactions();
+	}
+	else
+	{
+		StorageTransactionReference transactionRef( transaction);
+		{
+			InsertProfilerTimer timer( profilerContext);
+			strus::unique_lock lock( m_mutex_openTransactions);
+			// Block the inserter as long as the queue is full. A single transaction
+			// exceeding the byte limit is accepted if there is nothing else open:
+			while (!m_closed
+				&& ((int)m_nofOpenTransactions >= m_maxNofOpenTransactions
+					|| (m_maxBufferedBytes && m_nofOpenTransactions
+						&& m_bufferedBytes + bufferedBytes > m_maxBufferedBytes)))
+			{
+				m_cond_notFull.wait( lock);
+			}
+			timer.stop( InsertProfiler::StageWait);
+			if (m_closed) throw std::runtime_error( _TXT("transaction pushed to commit queue after close"));
+			m_openTransactions.push( OpenTransaction( transactionRef, bufferedBytes));
+			m_openTransactions.back().files.swap( files);
+			++m_nofOpenTransactions;
+			m_bufferedBytes += bufferedBytes;
+		}
+		m_cond_notEmpty.notify_one();
 	}
-	handleWaitingTransactions();
 }
 
-Reference<StorageTransactionInterface> CommitQueue::getNextTransaction()
+CommitQueue::OpenTransaction CommitQueue::getNextTransaction()
 {
 	strus::scoped_lock lock( m_mutex_openTransactions);
 
-	if (m_nofOpenTransactions == 0) return Reference<StorageTransactionInterface>();
+	if (m_nofOpenTransactions == 0) return OpenTransaction();
 	--m_nofOpenTransactions;
-	Reference<StorageTransactionInterface>  rt = m_openTransactions.front();
+	OpenTransaction rt = m_openTransactions.front();
+	m_bufferedBytes -= rt.bufferedBytes;
 	m_openTransactions.pop();
 	return rt;
 }
@@ -12,6 +12,9 @@
 #include "strus/storage/index.hpp"
 #include "strus/reference.hpp"
 #include "strus/base/thread.hpp"
+#include "insertProfiler.hpp"
+#include "transactionSizeControl.hpp"
+#include "insertJournal.hpp"
 #include <vector>
 #include <string>
 #include <queue>
@@ -20,35 +23,87 @@ namespace strus {
 /// \brief Forward declaration
 class ErrorBufferInterface;
 
+/// \brief Queue of transactions to commit
+/// \note If created with commit threads, the transactions are committed by these threads in the background and the inserters are only blocked if the limits for open transactions or buffered bytes are exceeded. Otherwise the transactions are committed by the thread pushing them.
 class CommitQueue
 {
 public:
+	/// \brief Constructor
+	/// \param[in] storage_ storage to insert into
+	/// \param[in] verbose_ true, if every commit should be reported on a line of its own
+	/// \param[in] nofCommitThreads_ number of background threads committing the transactions, 0 for committing in the thread pushing the transaction
+	/// \param[in] maxNofOpenTransactions_ maximum number of transactions waiting to be committed before an inserter is blocked (only with commit threads)
+	/// \param[in] maxBufferedBytes_ maximum estimated size in bytes of the transactions waiting to be committed before an inserter is blocked, 0 for no limit (only with commit threads)
+	/// \param[in] profiler_ profiler to record the commit times or NULL
+	/// \param[in] sizeControl_ transaction size control to report the commit latencies to
+	/// \param[in] journal_ journal to record the files committed or NULL
+	/// \param[in] errorhnd_ error buffer interface
 	CommitQueue(
 			StorageClientInterface* storage_,
 			bool verbose_,
-			ErrorBufferInterface* errorhnd_)
-		:m_storage(storage_),m_nofDocuments(0),m_nofOpenTransactions(0),m_verbose(verbose_),m_errorhnd(errorhnd_)
-	{
-		m_nofDocuments = m_storage->nofDocumentsInserted();
-	}
+			int nofCommitThreads_,
+			int maxNofOpenTransactions_,
+			std::size_t maxBufferedBytes_,
+			InsertProfiler* profiler_,
+			TransactionSizeControl* sizeControl_,
+			InsertJournal* journal_,
+			ErrorBufferInterface* errorhnd_);
+
+	~CommitQueue();
+
+	/// \brief Push a transaction to commit
+	/// \param[in] transaction transaction to commit (with ownership)
+	/// \param[in] bufferedBytes estimated size of the contents of the transaction in bytes
+	/// \param[in,out] files number of documents per file in the transaction for the journal (empty if no journal is written), moved into the queue
+	/// \param[in] profilerContext profiler context of the calling thread to record the time blocked on a full queue for, NULL if not profiled
+	void pushTransaction( StorageTransactionInterface* transaction, std::size_t bufferedBytes, InsertJournal::FileDocumentsList& files, InsertProfilerContext* profilerContext);
+
+	/// \brief Wait for all transactions pushed to be committed and stop the commit threads
+	void close();
 
-	void pushTransaction( StorageTransactionInterface* transaction);
 	const std::vector<std::string>& errors() const		{return m_errors;}
 
 private:
 	typedef Reference<StorageTransactionInterface> StorageTransactionReference;
 
+	struct OpenTransaction
+	{
+		StorageTransactionReference transaction;
+		std::size_t bufferedBytes;
+		InsertJournal::FileDocumentsList files;
+
+		OpenTransaction()
+			:transaction(),bufferedBytes(0),files(){}
+		OpenTransaction( const StorageTransactionReference& transaction_, std::size_t bufferedBytes_)
+			:transaction(transaction_),bufferedBytes(bufferedBytes_),files(){}
+		OpenTransaction( const OpenTransaction& o)
+			:transaction(o.transaction),bufferedBytes(o.bufferedBytes),files(o.files){}
+	};
+
 	void handleWaitingTransactions();
-	Reference<StorageTransactionInterface> getNextTransaction();
+	void commitThreadMain();
+	void commitTransaction( const OpenTransaction& open);
+	OpenTransaction getNextTransaction();
 
 private:
 	StorageClientInterface* m_storage;
 	Index m_nofDocuments;
 	unsigned int m_nofOpenTransactions;
-	std::queue<StorageTransactionReference> m_openTransactions;
+	std::size_t m_bufferedBytes;
+	std::queue<OpenTransaction> m_openTransactions;
 	strus::mutex m_mutex_openTransactions;
+	strus::condition_variable m_cond_notEmpty;
+	strus::condition_variable m_cond_notFull;
 	strus::mutex m_mutex_errors;
 	std::vector<std::string> m_errors;
+	std::vector<Reference<strus::thread> > m_commitThreads;
+	int m_maxNofOpenTransactions;
+	std::size_t m_maxBufferedBytes;
+	bool m_closed;
+	strus::mutex m_mutex_profiler;
+	InsertProfilerContext m_profilerContext;
+	TransactionSizeControl* m_sizeControl;
+	InsertJournal* m_journal;
 	bool m_verbose;
 	ErrorBufferInterface* m_errorhnd;
 };
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "documentIndexer.hpp"
+#include "strus/constants.hpp"
+#include "strus/storage/index.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/storageDocumentInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "private/internationalization.hpp"
+#include "commitQueue.hpp"
+#include <iostream>
+
+using namespace strus;
+
+DocumentIndexer::DocumentIndexer(
+		StorageClientInterface* storage_,
+		CommitQueue* commitque_,
+		TransactionSizeControl* sizeControl_,
+		InsertJournal* journal_,
+		InsertProfilerContext* profilerContext_,
+		ErrorBufferInterface* errorhnd_)
+	:m_storage(storage_)
+	,m_commitque(commitque_)
+	,m_profilerContext(profilerContext_)
+	,m_sizeControl(sizeControl_)
+	,m_transaction()
+	,m_docCount(0)
+	,m_bufferedBytes(0)
+	,m_byteLimit(0)
+	,m_journal(journal_)
+	,m_files()
+	,m_errorhnd(errorhnd_)
+{}
+
+// Rough estimate of the memory a document occupies in a transaction until it is committed:
+static std::size_t estimateDocumentSize( const strus::analyzer::Document& doc)
+{
+	std::size_t rt = 0;
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = doc.searchIndexTerms().begin(),
+		te = doc.searchIndexTerms().end();
+	for (; ti != te; ++ti)
+	{
+		rt += ti->type().size() + ti->value().size() + sizeof(strus::Index);
+	}
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		fi = doc.forwardIndexTerms().begin(),
+		fe = doc.forwardIndexTerms().end();
+	for (; fi != fe; ++fi)
+	{
+		rt += fi->type().size() + fi->value().size() + sizeof(strus::Index);
+	}
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		rt += ai->name().size() + ai->value().size();
+	}
+	rt += doc.searchIndexStructures().size() * 2 * sizeof(strus::IndexRange);
+	rt += doc.metadata().size() * sizeof(strus::NumericVariant);
+	return rt;
+}
+
+void DocumentIndexer::insert( const analyzer::Document& doc, const std::string& filename)
+{
+	InsertProfilerTimer timer( m_profilerContext);
+	if (!m_transaction.get())
+	{
+		m_transaction.reset( m_storage->createTransaction());
+		if (!m_transaction.get()) throw strus::runtime_error( _TXT("error creating storage transaction: %s"), m_errorhnd->fetchError());
+		m_byteLimit = m_sizeControl->byteLimit();
+	}
+	// Create the document with the correct docid:
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		oi = doc.attributes().begin(),
+		oe = doc.attributes().end();
+	for (;oi != oe
+		&& oi->name() != strus::Constants::attribute_docid();
+		++oi){}
+	const char* docid = 0;
+	strus::local_ptr<strus::StorageDocumentInterface> storagedoc;
+	if (oi != oe)
+	{
+		storagedoc.reset( m_transaction->createDocument( oi->value()));
+		if (!storagedoc.get()) throw strus::runtime_error( _TXT("error creating document: %s"), m_errorhnd->fetchError());
+		docid = oi->value().c_str();
+		//... use the docid from the analyzer if defined there
+	}
+	else
+	{
+		storagedoc.reset( m_transaction->createDocument( filename));
+		if (!storagedoc.get()) throw strus::runtime_error( _TXT("error creating document"));
+		storagedoc->setAttribute( strus::Constants::attribute_docid(), filename);
+		docid = filename.c_str();
+		//... define file path as hardcoded docid attribute
+	}
+	// Define all search index term occurrencies:
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = doc.searchIndexTerms().begin(),
+		te = doc.searchIndexTerms().end();
+	for (; ti != te; ++ti)
+	{
+		storagedoc->addSearchIndexTerm( ti->type(), ti->value(), ti->pos());
+	}
+	// Define all search index structures:
+	std::vector<strus::analyzer::DocumentStructure>::const_iterator
+		si = doc.searchIndexStructures().begin(),
+		se = doc.searchIndexStructures().end();
+	for (; si != se; ++si)
+	{
+		strus::IndexRange source( si->source().start(),si->source().end());
+		strus::IndexRange sink( si->sink().start(),si->sink().end());
+		storagedoc->addSearchIndexStructure( si->name(), source, sink);
+	}
+	// Define all forward index terms:
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		fi = doc.forwardIndexTerms().begin(),
+		fe = doc.forwardIndexTerms().end();
+	for (; fi != fe; ++fi)
+	{
+		storagedoc->addForwardIndexTerm( fi->type(), fi->value(), fi->pos());
+	}
+	// Define all attributes extracted from the document analysis:
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		storagedoc->setAttribute( ai->name(), ai->value());
+	}
+	// Define all metadata elements extracted from the document analysis:
+	std::vector<strus::analyzer::DocumentMetaData>::const_iterator
+		mi = doc.metadata().begin(), me = doc.metadata().end();
+	for (; mi != me; ++mi)
+	{
+		NumericVariant val = mi->value();
+		storagedoc->setMetaData( mi->name(), val);
+	}
+	timer.stop( InsertProfiler::StageBuild);
+
+	// Finish document completed:
+	storagedoc->done();
+	timer.stop( InsertProfiler::StageDone);
+	if (m_errorhnd->hasInfo())
+	{
+		std::vector<std::string> info = m_errorhnd->fetchInfo();
+		std::vector<std::string>::const_iterator ei = info.begin(), ee = info.end();
+		for (; ei != ee; ++ei)
+		{
+			std::cerr << strus::string_format( _TXT( "%s in document '%s'"), ei->c_str(), docid) << std::endl;
+		}
+	}
+	if (m_errorhnd->hasError())
+	{
+		const char* errmsg = m_errorhnd->fetchError();
+		throw strus::runtime_error( _TXT( "error in file %s': %s"), filename.c_str(), errmsg);
+	}
+	m_docCount++;
+	m_bufferedBytes += estimateDocumentSize( doc);
+	if (m_journal)
+	{
+		if (m_files.empty() || m_files.back().filename != filename)
+		{
+			m_files.push_back( InsertJournal::FileDocuments( filename));
+		}
+		++m_files.back().nofDocuments;
+	}
+	if (m_sizeControl->full( m_docCount, m_bufferedBytes, m_byteLimit))
+	{
+		pushTransaction();
+	}
+}
+
+void DocumentIndexer::flush()
+{
+	if (m_docCount)
+	{
+		pushTransaction();
+	}
+}
+
+void DocumentIndexer::reset()
+{
+	m_transaction.reset();
+	m_docCount = 0;
+	m_bufferedBytes = 0;
+	m_files.clear();
+}
+
+void DocumentIndexer::pushTransaction()
+{
+	strus::StorageTransactionInterface* transaction = m_transaction.get();
+	m_transaction.release();
+	m_transaction.reset();
+	//... the next document inserted creates a new transaction
+	std::size_t bufferedBytes = m_bufferedBytes;
+	m_docCount = 0;
+	m_bufferedBytes = 0;
+	m_commitque->pushTransaction( transaction, bufferedBytes, m_files, m_profilerContext);
+	m_files.clear();
+}
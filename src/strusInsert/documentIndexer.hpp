@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_DOCUMENT_INDEXER_HPP_INCLUDED
+#define _STRUS_INSERTER_DOCUMENT_INDEXER_HPP_INCLUDED
+#include "strus/reference.hpp"
+#include "strus/storageTransactionInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "insertProfiler.hpp"
+#include "transactionSizeControl.hpp"
+#include "insertJournal.hpp"
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class StorageClientInterface;
+/// \brief Forward declaration
+class CommitQueue;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Inserts analyzed documents into a storage transaction and passes the transaction to the commit queue when it is full
+class DocumentIndexer
+{
+public:
+	/// \brief Constructor
+	/// \param[in] storage_ storage to insert into
+	/// \param[in] commitque_ queue of transactions to commit
+	/// \param[in] sizeControl_ decides when a transaction is full
+	/// \param[in] journal_ journal to record the files committed or NULL
+	/// \param[in] profilerContext_ profiler context of the thread using this indexer (for the build and done stages)
+	/// \param[in] errorhnd_ error buffer interface
+	DocumentIndexer(
+			StorageClientInterface* storage_,
+			CommitQueue* commitque_,
+			TransactionSizeControl* sizeControl_,
+			InsertJournal* journal_,
+			InsertProfilerContext* profilerContext_,
+			ErrorBufferInterface* errorhnd_);
+
+	/// \brief Insert an analyzed document into the current transaction
+	/// \param[in] doc analyzed document
+	/// \param[in] filename name of the file the document was read from, used as docid if the analyzer did not define one
+	void insert( const analyzer::Document& doc, const std::string& filename);
+
+	/// \brief Pass the current transaction to the commit queue if it contains any documents
+	void flush();
+
+	/// \brief Drop the current transaction with all documents inserted (after an error)
+	void reset();
+
+	/// \brief Get the number of documents in the current transaction
+	int nofDocuments() const
+	{
+		return m_docCount;
+	}
+
+private:
+	void pushTransaction();
+
+private:
+	StorageClientInterface* m_storage;
+	CommitQueue* m_commitque;
+	InsertProfilerContext* m_profilerContext;
+	TransactionSizeControl* m_sizeControl;
+	strus::Reference<strus::StorageTransactionInterface> m_transaction;
+	int m_docCount;
+	std::size_t m_bufferedBytes;
+	std::size_t m_byteLimit;		///< byte limit of the current transaction, 0 for no limit
+	InsertJournal* m_journal;
+	InsertJournal::FileDocumentsList m_files;	///< number of documents per file in the current transaction (only with journal)
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
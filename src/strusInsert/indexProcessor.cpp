@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "indexProcessor.hpp"
+#include "analyzedDocumentQueue.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/string_format.hpp"
+#include "private/internationalization.hpp"
+#include <iostream>
+
+using namespace strus;
+
+IndexProcessor::IndexProcessor(
+		StorageClientInterface* storage_,
+		CommitQueue* commitque_,
+		AnalyzedDocumentQueue* docque_,
+		InsertProfiler* profiler_,
+		int worker_,
+		TransactionSizeControl* sizeControl_,
+		InsertJournal* journal_,
+		ErrorBufferInterface* errorhnd_)
+	:m_docque(docque_)
+	,m_profilerContext(profiler_, string_format( "indexer %d", worker_))
+	,m_indexer(storage_, commitque_, sizeControl_, journal_, &m_profilerContext, errorhnd_)
+	,m_gotError(false)
+	,m_errorhnd(errorhnd_)
+{}
+
+void IndexProcessor::run()
+{
+	try
+	{
+		AnalyzedDocumentBatch batch;
+		while (m_docque->pop( batch))
+		{
+			try
+			{
+				AnalyzedDocumentBatch::const_iterator bi = batch.begin(), be = batch.end();
+				for (; bi != be; ++bi)
+				{
+					m_indexer.insert( bi->doc, bi->filename);
+				}
+				m_profilerContext.flush();
+			}
+			catch (const std::bad_alloc& err)
+			{
+				std::cerr << string_format( _TXT( "memory allocation error")) << std::endl;
+				m_indexer.reset();
+				m_gotError = true;
+			}
+			catch (const std::runtime_error& err)
+			{
+				const char* errmsg = m_errorhnd->fetchError();
+				if (errmsg)
+				{
+					std::cerr << "ERROR " << strus::string_format( "%s; %s", err.what(), errmsg) << std::endl;
+				}
+				else
+				{
+					std::cerr << "ERROR " << err.what() << std::endl;
+				}
+				m_indexer.reset();
+				m_gotError = true;
+			}
+		}
+		m_indexer.flush();
+	}
+	catch (const std::bad_alloc& err)
+	{
+		std::cerr << _TXT("failed to complete inserts due to a memory allocation error") << std::endl;
+		m_gotError = true;
+	}
+	catch (const std::runtime_error& err)
+	{
+		const char* errmsg = m_errorhnd->fetchError();
+		if (errmsg)
+		{
+			std::cerr << string_format( _TXT("failed to complete inserts: %s; %s"), err.what(), errmsg) << std::endl;
+		}
+		else
+		{
+			std::cerr << string_format( _TXT("failed to complete inserts: %s"), err.what()) << std::endl;
+		}
+		m_gotError = true;
+	}
+	catch (...)
+	{
+		std::cerr << _TXT("failed to complete inserts: uncaught exception in thread") << std::endl; 
+		m_gotError = true;
+	}
+	m_profilerContext.flush();
+	m_errorhnd->releaseContext();
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_INDEX_PROCESSOR_HPP_INCLUDED
+#define _STRUS_INSERTER_INDEX_PROCESSOR_HPP_INCLUDED
+#include "documentIndexer.hpp"
+#include "insertProfiler.hpp"
+
+namespace strus {
+
+/// \brief Forward declaration
+class StorageClientInterface;
+/// \brief Forward declaration
+class CommitQueue;
+/// \brief Forward declaration
+class AnalyzedDocumentQueue;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Indexer thread of strusInsert with separated analyzer and indexer stages, inserts the documents analyzed by the analyzer threads into transactions
+class IndexProcessor
+{
+public:
+	IndexProcessor(
+			StorageClientInterface* storage_,
+			CommitQueue* commitque_,
+			AnalyzedDocumentQueue* docque_,
+			InsertProfiler* profiler_,
+			int worker_,
+			TransactionSizeControl* sizeControl_,
+			InsertJournal* journal_,
+			ErrorBufferInterface* errorhnd_);
+
+	void run();
+	bool hasError() const	{return m_gotError;}
+
+private:
+	AnalyzedDocumentQueue* m_docque;
+	InsertProfilerContext m_profilerContext;
+	DocumentIndexer m_indexer;
+	bool m_gotError;
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
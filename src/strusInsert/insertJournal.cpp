@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "insertJournal.hpp"
+#include "private/internationalization.hpp"
+#include "strus/base/fileio.hpp"
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+
+using namespace strus;
+
+InsertJournal::InsertJournal( const std::string& filename_)
+	:m_files(),m_filename(filename_),m_output(0)
+{
+	m_output = ::fopen( m_filename.c_str(), "a");
+	if (!m_output) throw strus::runtime_error( _TXT("failed to open journal file '%s' for appending: %s"), m_filename.c_str(), ::strerror(errno));
+}
+
+InsertJournal::~InsertJournal()
+{
+	::fclose( m_output);
+}
+
+std::set<std::string> InsertJournal::readCompletedFiles( const std::string& filename)
+{
+	std::set<std::string> rt;
+	if (!strus::isFile( filename)) return rt;
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec) throw strus::runtime_error( _TXT("failed to read journal file '%s': %s"), filename.c_str(), ::strerror(ec));
+
+	// Only lines terminated with end of line are accepted, the last line may have been cut by an interruption:
+	char const* li = content.c_str();
+	char const* le = std::strchr( li, '\n');
+	for (; le; li = le+1, le = std::strchr( li, '\n'))
+	{
+		if (li[0] != 'F' || li[1] != '\t') continue;
+		char const* pathstart = std::strchr( li+2, '\t');
+		if (!pathstart || pathstart > le) continue;
+		++pathstart;
+		rt.insert( std::string( pathstart, le - pathstart));
+	}
+	return rt;
+}
+
+void InsertJournal::writeFileCompleted( const std::string& filename, int nofDocuments)
+{
+	if (std::strchr( filename.c_str(), '\n'))
+	{
+		return;
+		//... a file name with an end of line can not be recorded, the file will be processed again on resume
+	}
+	::fprintf( m_output, "F\t%d\t%s\n", nofDocuments, filename.c_str());
+}
+
+void InsertJournal::fileAnalyzed( const std::string& filename, int nofDocuments)
+{
+	strus::scoped_lock lock( m_mutex);
+	std::map<std::string,FileState>::iterator fi = m_files.find( filename);
+	if (fi == m_files.end())
+	{
+		if (nofDocuments == 0)
+		{
+			writeFileCompleted( filename, 0);
+			::fflush( m_output);
+			return;
+		}
+		fi = m_files.insert( std::pair<std::string,FileState>( filename, FileState())).first;
+	}
+	fi->second.nofAnalyzed = nofDocuments;
+	if (fi->second.nofCommitted >= nofDocuments)
+	{
+		//... all documents have already been committed (possible with indexer threads or transactions closed in the middle of a file)
+		writeFileCompleted( filename, nofDocuments);
+		::fflush( m_output);
+		m_files.erase( fi);
+	}
+}
+
+void InsertJournal::transactionCommitted( const FileDocumentsList& files, unsigned int totalNofDocuments)
+{
+	strus::scoped_lock lock( m_mutex);
+	int nofDocuments = 0;
+	FileDocumentsList::const_iterator fi = files.begin(), fe = files.end();
+	for (; fi != fe; ++fi)
+	{
+		nofDocuments += fi->nofDocuments;
+	}
+	::fprintf( m_output, "C\t%d\t%u\n", nofDocuments, totalNofDocuments);
+	for (fi = files.begin(); fi != fe; ++fi)
+	{
+		FileState& st = m_files[ fi->filename];
+		st.nofCommitted += fi->nofDocuments;
+		if (st.nofAnalyzed >= 0 && st.nofCommitted >= st.nofAnalyzed)
+		{
+			writeFileCompleted( fi->filename, st.nofAnalyzed);
+			m_files.erase( fi->filename);
+		}
+	}
+	::fflush( m_output);
+	//... the journal is flushed after each commit, so that it is complete if the process is killed
+}
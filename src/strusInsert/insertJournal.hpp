@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_JOURNAL_HPP_INCLUDED
+#define _STRUS_INSERTER_JOURNAL_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <cstdio>
+
+namespace strus {
+
+/// \brief Journal of the files completely inserted by strusInsert, for resuming an insert that was interrupted
+/// \note A file is complete when all documents analyzed from it have been committed. The documents of a file
+///	may be spread over several transactions committed in any order, so the journal counts the documents
+///	committed per file and writes the file when the count reaches the number of documents analyzed.
+///	Files with errors are never complete and are processed again on resume.
+/// \remark Journal format: one line per commit "C <nof documents> <total nof documents committed>" followed by one line per file completed "F <nof documents> <path>", fields separated by tabs
+class InsertJournal
+{
+public:
+	/// \brief Number of documents of a file inserted into a transaction
+	struct FileDocuments
+	{
+		std::string filename;
+		int nofDocuments;
+
+		explicit FileDocuments( const std::string& filename_)
+			:filename(filename_),nofDocuments(0){}
+		FileDocuments( const FileDocuments& o)
+			:filename(o.filename),nofDocuments(o.nofDocuments){}
+	};
+	typedef std::vector<FileDocuments> FileDocumentsList;
+
+	/// \brief Constructor
+	/// \param[in] filename_ journal file to append to
+	explicit InsertJournal( const std::string& filename_);
+	~InsertJournal();
+
+	/// \brief Read the set of files completed from a journal
+	/// \param[in] filename journal file to read, an empty set is returned if it does not exist
+	static std::set<std::string> readCompletedFiles( const std::string& filename);
+
+	/// \brief Report that all documents of a file have been analyzed
+	/// \param[in] filename file analyzed
+	/// \param[in] nofDocuments number of documents analyzed from the file
+	void fileAnalyzed( const std::string& filename, int nofDocuments);
+
+	/// \brief Report a transaction committed
+	/// \param[in] files number of documents per file in the transaction
+	/// \param[in] totalNofDocuments total number of documents in the storage after the commit
+	void transactionCommitted( const FileDocumentsList& files, unsigned int totalNofDocuments);
+
+private:
+	void writeFileCompleted( const std::string& filename, int nofDocuments);
+
+private:
+	/// \brief State of a file with documents not yet all committed
+	struct FileState
+	{
+		int nofAnalyzed;	///< number of documents analyzed, -1 if the analysis is not yet finished
+		int nofCommitted;	///< number of documents committed
+
+		FileState()
+			:nofAnalyzed(-1),nofCommitted(0){}
+	};
+	strus::mutex m_mutex;
+	std::map<std::string,FileState> m_files;
+	std::string m_filename;
+	FILE* m_output;
+};
+
+}//namespace
+#endif
@@ -19,12 +19,14 @@
 #include "strus/analyzer/document.hpp"
 #include "strus/base/fileio.hpp"
 #include "strus/base/string_format.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/thread.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
+#include "private/mappedFile.hpp"
+#include "private/documentInputStream.hpp"
 #include "commitQueue.hpp"
+#include "insertProfiler.hpp"
 #include <memory>
 #include <iostream>
 #include <fstream>
@@ -37,19 +39,33 @@ InsertProcessor::InsertProcessor(
 		const strus::DocumentAnalyzer* analyzerMap_,
 		const analyzer::DocumentClass& defaultDocumentClass_,
 		CommitQueue* commitque_,
+		AnalyzedDocumentQueue* docque_,
+		InsertProfiler* profiler_,
 		FileCrawlerInterface* crawler_,
-		int transactionSize_,
+		bool containerItems_,
+		int worker_,
+		TransactionSizeControl* sizeControl_,
+		InsertJournal* journal_,
+		DocumentClassCache* dclassCache_,
+		bool useMmap_,
 		bool verbose_,
 		ErrorBufferInterface* errorhnd_)
 	:m_storage(storage_)
 	,m_textproc(textproc_)
 	,m_analyzerMap(analyzerMap_)
 	,m_defaultDocumentClass(defaultDocumentClass_)
-	,m_commitque(commitque_)
+	,m_docque(docque_)
+	,m_batch()
+	,m_doc()
+	,m_journal(journal_)
+	,m_dclassCache(dclassCache_)
+	,m_fileDocCount(0)
+	,m_profilerContext(profiler_, string_format( docque_ ? "analyzer %d" : "inserter %d", worker_))
+	,m_indexer(storage_, commitque_, sizeControl_, journal_, &m_profilerContext, errorhnd_)
 	,m_crawler(crawler_)
-	,m_transaction()
-	,m_transactionSize(transactionSize_)
-	,m_docCount(0)
+	,m_containerItems(containerItems_)
+	,m_worker(worker_)
+	,m_useMmap(useMmap_)
 	,m_verbose(verbose_)
 	,m_gotError(false)
 	,m_terminated(false)
@@ -65,42 +81,200 @@ void InsertProcessor::sigStop()
 	m_terminated.set( true);
 }
 
+void InsertProcessor::flushDocuments()
+{
+	if (m_docque)
+	{
+		if (!m_batch.empty())
+		{
+			InsertProfilerTimer timer( &m_profilerContext);
+			m_docque->push( m_batch);
+			timer.stop( InsertProfiler::StageWait);
+		}
+	}
+	else
+	{
+		m_indexer.flush();
+	}
+}
+
+void InsertProcessor::resetDocuments()
+{
+	if (m_docque)
+	{
+		m_batch.clear();
+	}
+	else
+	{
+		m_indexer.reset();
+	}
+}
+
+int InsertProcessor::nofDocumentsPending() const
+{
+	return m_docque ? (int)m_batch.size() : m_indexer.nofDocuments();
+}
+
+strus::DocumentAnalyzerContextInterface* InsertProcessor::createAnalyzerContext( const analyzer::DocumentClass& dclass)
+{
+	const strus::DocumentAnalyzerInstanceInterface* analyzer = m_analyzerMap->get( dclass);
+	if (!analyzer)
+	{
+		std::cerr << string_format( _TXT( "no analyzer defined for document class with MIME type '%s' schema '%s'"), dclass.mimeType().c_str(), dclass.schema().c_str()) << std::endl; 
+		m_gotError = true;
+		return 0;
+	}
+	strus::DocumentAnalyzerContextInterface* rt = analyzer->createContext( dclass);
+	if (!rt) throw strus::runtime_error( _TXT("error creating analyzer context: %s"), m_errorhnd->fetchError());
+	return rt;
+}
+
+void InsertProcessor::fileAnalyzed( const std::string& filename)
+{
+	if (m_journal && !m_terminated.test() && !m_errorhnd->hasError())
+	{
+		m_journal->fileAnalyzed( filename, m_fileDocCount);
+	}
+}
+
+bool InsertProcessor::processMappedDocument( const std::string& filename)
+{
+	InsertProfilerTimer timer( &m_profilerContext);
+	strus::utils::MappedFile input( filename);
+	timer.stop( InsertProfiler::StageRead);
+	if (input.error())
+	{
+		std::cerr << string_format( _TXT( "failed to map document file '%s': %s"), filename.c_str(), ::strerror( input.error())) << std::endl; 
+		m_gotError = true;
+		return true;
+	}
+	if (strus::utils::detectCompression( input.ptr(), input.size()) != strus::utils::CompressionNone)
+	{
+		return false;
+	}
+	strus::analyzer::DocumentClass dclass;
+	if (m_defaultDocumentClass.defined())
+	{
+		dclass = m_defaultDocumentClass;
+	}
+	else if (!getCachedDocumentClass( m_dclassCache, dclass, filename))
+	{
+		// Detect the document type from the header of the mapped file:
+		enum {MaxHeaderSize=4096};
+		std::size_t hdrsize = input.size() < (std::size_t)MaxHeaderSize ? input.size() : (std::size_t)MaxHeaderSize;
+		bool detected = strus::detectDocumentClass( m_dclassCache, dclass, filename, m_textproc, input.ptr(), hdrsize, hdrsize < (std::size_t)MaxHeaderSize);
+		timer.stop( InsertProfiler::StageDetect);
+		if (!detected)
+		{
+			std::cerr << string_format( _TXT( "failed to detect document class of file '%s'"), filename.c_str()) << std::endl; 
+			m_gotError = true;
+			return true;
+		}
+	}
+	strus::local_ptr<strus::DocumentAnalyzerContextInterface> analyzerContext( createAnalyzerContext( dclass));
+	if (!analyzerContext.get()) return true;
+
+	// Analyze the whole document (with subdocuments) passed in one piece and insert it:
+	analyzerContext->putInput( input.ptr() ? input.ptr() : "", input.size(), true);
+	insertAnalyzedDocuments( analyzerContext.get(), filename);
+	fileAnalyzed( filename);
+	if (m_verbose)
+	{
+		std::cerr << "processed file '" << filename << "' (" << nofDocumentsPending() << ")" << std::endl;
+	}
+	return true;
+}
+
+void InsertProcessor::insertAnalyzedDocuments( DocumentAnalyzerContextInterface* analyzerContext, const std::string& filename)
+{
+	if (m_docque)
+	{
+		queueAnalyzedDocuments( analyzerContext, filename);
+		return;
+	}
+	InsertProfilerTimer timer( &m_profilerContext);
+	while (!m_terminated.test() && analyzerContext->analyzeNext( m_doc))
+	{
+		timer.stop( InsertProfiler::StageAnalyze);
+		m_indexer.insert( m_doc, filename);
+		++m_fileDocCount;
+		timer.start();
+		//... the time spent in building the document is measured by the indexer, the time blocked on a full commit queue as wait
+		//    and the time committing as commit, either by the commit threads or by the indexer if there are no commit threads
+	}
+	timer.stop( InsertProfiler::StageAnalyze);
+}
+
+void InsertProcessor::queueAnalyzedDocuments( DocumentAnalyzerContextInterface* analyzerContext, const std::string& filename)
+{
+	InsertProfilerTimer timer( &m_profilerContext);
+	while (!m_terminated.test())
+	{
+		// Analyze the next document directly into the batch passed to the indexer threads:
+		AnalyzedDocument& next = m_batch.next();
+		if (!analyzerContext->analyzeNext( next.doc))
+		{
+			m_batch.pop_back();
+			break;
+		}
+		next.filename = filename;
+		++m_fileDocCount;
+		timer.stop( InsertProfiler::StageAnalyze);
+		if (m_batch.size() >= m_docque->batchSize())
+		{
+			m_docque->push( m_batch);
+			timer.stop( InsertProfiler::StageWait);
+		}
+	}
+	timer.stop( InsertProfiler::StageAnalyze);
+	if (m_errorhnd->hasError())
+	{
+		// Errors of the analyzer have to be reported here, as the indexer threads have their own error context:
+		const char* errmsg = m_errorhnd->fetchError();
+		throw strus::runtime_error( _TXT( "error in file %s': %s"), filename.c_str(), errmsg);
+	}
+}
+
 void InsertProcessor::processDocument( const std::string& filename)
 {
-	strus::InputStream input( filename);
+	m_fileDocCount = 0;
+	strus::utils::ContainerRecord record;
+	if (m_useMmap && !(m_containerItems && strus::utils::parseContainerRecordItem( record, filename)))
+	{
+		// Only whole files are mapped, records of container files and compressed files are read as stream:
+		if (processMappedDocument( filename)) return;
+	}
+	InsertProfilerTimer timer( &m_profilerContext);
+	strus::utils::DocumentInputStream input( filename, m_containerItems);
 	strus::local_ptr<strus::DocumentAnalyzerContextInterface> analyzerContext;
 	strus::analyzer::DocumentClass dclass;
-	if (!m_defaultDocumentClass.defined())
+	if (m_defaultDocumentClass.defined())
+	{
+		dclass = m_defaultDocumentClass;
+	}
+	else if (!getCachedDocumentClass( m_dclassCache, dclass, filename))
 	{
 		// Read the input file to analyze and detect its document type:
 		char hdrbuf[ 4096];
 		std::size_t hdrsize = input.readAhead( hdrbuf, sizeof( hdrbuf));
+		timer.stop( InsertProfiler::StageRead);
 		if (input.error())
 		{
 			std::cerr << string_format( _TXT( "failed to read document file '%s': %s"), filename.c_str(), ::strerror( input.error())) << std::endl; 
 			m_gotError = true;
 			return;
 		}
-		if (!m_textproc->detectDocumentClass( dclass, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf)))
+		bool detected = strus::detectDocumentClass( m_dclassCache, dclass, filename, m_textproc, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf));
+		timer.stop( InsertProfiler::StageDetect);
+		if (!detected)
 		{
 			std::cerr << string_format( _TXT( "failed to detect document class of file '%s'"), filename.c_str()) << std::endl; 
 			m_gotError = true;
 			return;
 		}
 	}
-	else
-	{
-		dclass = m_defaultDocumentClass;
-	}
-	const strus::DocumentAnalyzerInstanceInterface* analyzer = m_analyzerMap->get( dclass);
-	if (!analyzer)
-	{
-		std::cerr << string_format( _TXT( "no analyzer defined for document class with MIME type '%s' schema '%s'"), dclass.mimeType().c_str(), dclass.schema().c_str()) << std::endl; 
-		m_gotError = true;
-		return;
-	}
-	analyzerContext.reset( analyzer->createContext( dclass));
-	if (!analyzerContext.get()) throw strus::runtime_error( _TXT("error creating analyzer context: %s"), m_errorhnd->fetchError());
+	analyzerContext.reset( createAnalyzerContext( dclass));
+	if (!analyzerContext.get()) return;
 
 	// Analyze the document (with subdocuments) and insert it:
 	enum {AnalyzerBufSize=8192};
@@ -109,133 +283,38 @@ void InsertProcessor::processDocument( const std::string& filename)
 
 	while (!eof)
 	{
+		timer.start();
 		std::size_t readsize = input.read( buf, sizeof(buf));
+		timer.stop( InsertProfiler::StageRead);
 		if (readsize < sizeof(buf))
 		{
 			if (input.error())
 			{
 				std::cerr << string_format( _TXT( "failed to read document file '%s': %s"), filename.c_str(), ::strerror( input.error())) << std::endl; 
 				m_gotError = true;
-				break;
+				return;
 			}
 			eof = true;
 		}
 		analyzerContext->putInput( buf, readsize, eof);
 		// Analyze the document and print the result:
-		strus::analyzer::Document doc;
-		while (!m_terminated.test() && analyzerContext->analyzeNext( doc))
-		{
-			// Create the document with the correct docid:
-			std::vector<strus::analyzer::DocumentAttribute>::const_iterator
-				oi = doc.attributes().begin(),
-				oe = doc.attributes().end();
-			for (;oi != oe
-				&& oi->name() != strus::Constants::attribute_docid();
-				++oi){}
-			const char* docid = 0;
-			strus::local_ptr<strus::StorageDocumentInterface> storagedoc;
-			if (oi != oe)
-			{
-				storagedoc.reset( m_transaction->createDocument( oi->value()));
-				if (!storagedoc.get()) throw strus::runtime_error( _TXT("error creating document: %s"), m_errorhnd->fetchError());
-				docid = oi->value().c_str();
-				//... use the docid from the analyzer if defined there
-			}
-			else
-			{
-				storagedoc.reset( m_transaction->createDocument( filename));
-				if (!storagedoc.get()) throw strus::runtime_error( _TXT("error creating document"));
-				storagedoc->setAttribute( strus::Constants::attribute_docid(), filename);
-				docid = filename.c_str();
-				//... define file path as hardcoded docid attribute
-			}
-			// Define all search index term occurrencies:
-			std::vector<strus::analyzer::DocumentTerm>::const_iterator
-				ti = doc.searchIndexTerms().begin(),
-				te = doc.searchIndexTerms().end();
-			for (; ti != te; ++ti)
-			{
-				storagedoc->addSearchIndexTerm( ti->type(), ti->value(), ti->pos());
-			}
-			// Define all search index structures:
-			std::vector<strus::analyzer::DocumentStructure>
-				structlist = doc.searchIndexStructures();
-			std::vector<strus::analyzer::DocumentStructure>::const_iterator
-				si = structlist.begin(), se = structlist.end();
-			for (; si != se; ++si)
-			{
-				strus::IndexRange source( si->source().start(),si->source().end());
-				strus::IndexRange sink( si->sink().start(),si->sink().end());
-				storagedoc->addSearchIndexStructure( si->name(), source, sink);
-			}
-			// Define all forward index terms:
-			std::vector<strus::analyzer::DocumentTerm>::const_iterator
-				fi = doc.forwardIndexTerms().begin(),
-				fe = doc.forwardIndexTerms().end();
-			for (; fi != fe; ++fi)
-			{
-				storagedoc->addForwardIndexTerm( fi->type(), fi->value(), fi->pos());
-			}
-			// Define all attributes extracted from the document analysis:
-			std::vector<strus::analyzer::DocumentAttribute>::const_iterator
-				ai = doc.attributes().begin(), ae = doc.attributes().end();
-			for (; ai != ae; ++ai)
-			{
-				storagedoc->setAttribute( ai->name(), ai->value());
-			}
-			// Define all metadata elements extracted from the document analysis:
-			std::vector<strus::analyzer::DocumentMetaData>::const_iterator
-				mi = doc.metadata().begin(), me = doc.metadata().end();
-			for (; mi != me; ++mi)
-			{
-				NumericVariant val = mi->value();
-				storagedoc->setMetaData( mi->name(), val);
-			}
-			// Finish document completed:
-			storagedoc->done();
-			if (m_errorhnd->hasInfo())
-			{
-				std::vector<std::string> info = m_errorhnd->fetchInfo();
-				std::vector<std::string>::const_iterator ei = info.begin(), ee = info.end();
-				for (; ei != ee; ++ei)
-				{
-					std::cerr << strus::string_format( _TXT( "%s in document '%s'"), ei->c_str(), docid) << std::endl;
-				}
-			}
-			if (m_errorhnd->hasError())
-			{
-				const char* errmsg = m_errorhnd->fetchError();
-				throw strus::runtime_error( _TXT( "error in file %s': %s"), filename.c_str(), errmsg);
-			}
-			m_docCount++;
-			if (m_docCount == m_transactionSize && m_docCount && !m_terminated.test())
-			{
-				m_commitque->pushTransaction( m_transaction.get());
-				m_transaction.release();
-				m_transaction.reset( m_storage->createTransaction());
-				if (!m_transaction.get()) throw strus::runtime_error( _TXT("error recreating storage transaction: %s"), m_errorhnd->fetchError());
-				m_docCount = 0;
-			}
-		}
+		insertAnalyzedDocuments( analyzerContext.get(), filename);
 	}
+	fileAnalyzed( filename);
 	if (m_verbose)
 	{
-		std::cerr << "processed file '" << filename << "' (" << m_docCount << ")" << std::endl;
+		std::cerr << "processed file '" << filename << "' (" << nofDocumentsPending() << ")" << std::endl;
 	}
 }
 
 void InsertProcessor::run()
 {
-	m_docCount = 0;
 	try
 	{
 		std::vector<std::string> files;
 		std::vector<std::string>::const_iterator fitr;
-	
-		m_transaction.reset( m_storage->createTransaction());
-		if (!m_transaction.get()) throw strus::runtime_error( _TXT("error creating storage transaction: %s"), m_errorhnd->fetchError());
 
-		while (!(files=m_crawler->fetch()).empty())
+		while (!(files=m_crawler->fetch( m_worker)).empty())
 		{
 			fitr = files.begin();
 			for (int fidx=0; !m_terminated.test() && fitr != files.end(); ++fitr,++fidx)
@@ -243,13 +322,12 @@ void InsertProcessor::run()
 				try
 				{
 					processDocument( *fitr);
+					m_profilerContext.flush();
 				}
 				catch (const std::bad_alloc& err)
 				{
 					std::cerr << string_format( _TXT( "memory allocation error")) << std::endl;
-					m_transaction.reset( m_storage->createTransaction());
-					if (!m_transaction.get()) throw strus::runtime_error( _TXT("error recreating storage transaction: %s"), m_errorhnd->fetchError());
-					m_docCount = 0;
+					resetDocuments();
 					m_gotError = true;
 				}
 				catch (const std::runtime_error& err)
@@ -263,18 +341,14 @@ void InsertProcessor::run()
 					{
 						std::cerr << "ERROR " << err.what() << std::endl;
 					}
-					m_transaction.reset( m_storage->createTransaction());
-					if (!m_transaction.get()) throw strus::runtime_error( _TXT("error recreating storage transaction: %s"), m_errorhnd->fetchError());
-					m_docCount = 0;
+					resetDocuments();
 					m_gotError = true;
 				}
 			}
 		}
-		if (!m_terminated.test() && m_docCount)
+		if (!m_terminated.test())
 		{
-			m_commitque->pushTransaction( m_transaction.get());
-			m_transaction.release();
-			m_docCount = 0;
+			flushDocuments();
 		}
 	}
 	catch (const std::bad_alloc& err)
@@ -300,6 +374,7 @@ void InsertProcessor::run()
 		std::cerr << _TXT("failed to complete inserts: uncaught exception in thread") << std::endl; 
 		m_gotError = true;
 	}
+	m_profilerContext.flush();
 	m_errorhnd->releaseContext();
 }
 
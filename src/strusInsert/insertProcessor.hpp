@@ -8,9 +8,11 @@
 #ifndef _STRUS_INSERTER_PROCESSOR_HPP_INCLUDED
 #define _STRUS_INSERTER_PROCESSOR_HPP_INCLUDED
 #include "strus/base/atomic.hpp"
-#include "strus/reference.hpp"
-#include "strus/storageTransactionInterface.hpp"
 #include "private/documentAnalyzer.hpp"
+#include "private/documentClassCache.hpp"
+#include "insertProfiler.hpp"
+#include "documentIndexer.hpp"
+#include "analyzedDocumentQueue.hpp"
 
 namespace strus {
 
@@ -21,6 +23,8 @@ class TextProcessorInterface;
 /// \brief Forward declaration
 class DocumentAnalyzerInstanceInterface;
 /// \brief Forward declaration
+class DocumentAnalyzerContextInterface;
+/// \brief Forward declaration
 class CommitQueue;
 /// \brief Forward declaration
 class FileCrawlerInterface;
@@ -28,6 +32,8 @@ class FileCrawlerInterface;
 class ErrorBufferInterface;
 
 
+/// \brief Inserter thread of strusInsert, analyzes the files fetched from the crawler and inserts the documents
+/// \note If a queue of analyzed documents is passed, the documents are passed in batches to the indexer threads (IndexProcessor) instead of being inserted by this thread
 class InsertProcessor
 {
 public:
@@ -37,8 +43,15 @@ public:
 			const strus::DocumentAnalyzer* analyzerMap_,
 			const analyzer::DocumentClass& defaultDocumentClass_,
 			CommitQueue* commitque_,
+			AnalyzedDocumentQueue* docque_,
+			InsertProfiler* profiler_,
 			FileCrawlerInterface* crawler_,
-			int transactionSize_,
+			bool containerItems_,
+			int worker_,
+			TransactionSizeControl* sizeControl_,
+			InsertJournal* journal_,
+			DocumentClassCache* dclassCache_,
+			bool useMmap_,
 			bool verbose_,
 			ErrorBufferInterface* errorhnd_);
 
@@ -50,17 +63,32 @@ public:
 
 private:
 	void processDocument( const std::string& filename);
+	bool processMappedDocument( const std::string& filename);
+	DocumentAnalyzerContextInterface* createAnalyzerContext( const analyzer::DocumentClass& dclass);
+	void insertAnalyzedDocuments( DocumentAnalyzerContextInterface* analyzerContext, const std::string& filename);
+	void queueAnalyzedDocuments( DocumentAnalyzerContextInterface* analyzerContext, const std::string& filename);
+	void fileAnalyzed( const std::string& filename);
+	void flushDocuments();
+	void resetDocuments();
+	int nofDocumentsPending() const;
 
 private:
 	StorageClientInterface* m_storage;
 	const TextProcessorInterface* m_textproc;
 	const strus::DocumentAnalyzer* m_analyzerMap;
 	analyzer::DocumentClass m_defaultDocumentClass;
-	CommitQueue* m_commitque;
+	AnalyzedDocumentQueue* m_docque;
+	AnalyzedDocumentBatch m_batch;
+	analyzer::Document m_doc;			///< document analyzed, reused for all documents of this thread
+	InsertJournal* m_journal;
+	DocumentClassCache* m_dclassCache;
+	int m_fileDocCount;				///< number of documents analyzed from the current file
+	InsertProfilerContext m_profilerContext;
+	DocumentIndexer m_indexer;
 	FileCrawlerInterface* m_crawler;
-	strus::Reference<strus::StorageTransactionInterface> m_transaction;
-	int m_transactionSize;
-	int m_docCount;
+	bool m_containerItems;				///< true if the items fetched from the crawler may refer to records of container files
+	int m_worker;
+	bool m_useMmap;
 	bool m_verbose;
 	bool m_gotError;
 	strus::AtomicFlag m_terminated;
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "insertProfiler.hpp"
+#include "private/internationalization.hpp"
+#include "private/jsonUtils.hpp"
+#include <cstring>
+#include <cerrno>
+#include <time.h>
+
+using namespace strus;
+
+void InsertStageStatistics::add( uint64_t wallTime, uint64_t cpuTime)
+{
+	m_count += 1;
+	m_wallTime += wallTime;
+	m_cpuTime += cpuTime;
+	uint64_t usec = wallTime / 1000;
+	int bucket = 0;
+	for (; bucket < NofHistogramBuckets-1 && usec >= ((uint64_t)1 << bucket); ++bucket){}
+	m_histogram[ bucket] += 1;
+}
+
+void InsertStageStatistics::merge( const InsertStageStatistics& o)
+{
+	m_count += o.m_count;
+	m_wallTime += o.m_wallTime;
+	m_cpuTime += o.m_cpuTime;
+	for (int bi=0; bi<NofHistogramBuckets; ++bi)
+	{
+		m_histogram[ bi] += o.m_histogram[ bi];
+	}
+}
+
+void InsertStageStatistics::clear()
+{
+	m_count = 0;
+	m_wallTime = 0;
+	m_cpuTime = 0;
+	std::memset( m_histogram, 0, sizeof(m_histogram));
+}
+
+uint64_t InsertProfilerTimer::wallClock()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t InsertProfilerTimer::cpuClock()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+const char* InsertProfiler::stageName( Stage stage)
+{
+	static const char* ar[] = {"read","detect","analyze","build","done","commit","wait"};
+	return ar[ stage];
+}
+
+InsertProfiler::InsertProfiler( const std::string& outputfile, unsigned int reportInterval)
+	:m_threads(),m_output(0),m_ownOutput(false),m_reportInterval(reportInterval)
+	,m_startTime(InsertProfilerTimer::wallClock()),m_lastReportTime(0)
+{
+	m_lastReportTime = m_startTime;
+	if (outputfile == "-")
+	{
+		m_output = stderr;
+	}
+	else
+	{
+		m_output = ::fopen( outputfile.c_str(), "a");
+		if (!m_output) throw strus::runtime_error( _TXT("failed to open profiler output file '%s' for appending: %s"), outputfile.c_str(), ::strerror(errno));
+		m_ownOutput = true;
+	}
+}
+
+InsertProfiler::~InsertProfiler()
+{
+	if (m_ownOutput) ::fclose( m_output);
+}
+
+int InsertProfiler::registerThread( const std::string& name)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_threads.push_back( ThreadStatistics( name));
+	return m_threads.size()-1;
+}
+
+void InsertProfiler::merge( int thread, InsertStageStatistics* stats)
+{
+	strus::scoped_lock lock( m_mutex);
+	ThreadStatistics& ts = m_threads[ thread];
+	for (int si=0; si<NofStages; ++si)
+	{
+		ts.stats[ si].merge( stats[ si]);
+		stats[ si].clear();
+	}
+	if (m_reportInterval)
+	{
+		uint64_t now = InsertProfilerTimer::wallClock();
+		if (now - m_lastReportTime >= (uint64_t)m_reportInterval * 1000000000)
+		{
+			m_lastReportTime = now;
+			writeReport( false);
+		}
+	}
+}
+
+void InsertProfiler::report()
+{
+	strus::scoped_lock lock( m_mutex);
+	writeReport( true);
+}
+
+static void printStageStatistics( FILE* out, const InsertStageStatistics& st)
+{
+	::fprintf( out, "{\"count\":%llu,\"wall\":%.6f,\"cpu\":%.6f,\"histogram\":[",
+			(unsigned long long)st.count(), st.wallTime() / 1e9, st.cpuTime() / 1e9);
+	// Print the histogram as list of pairs [upper bound in microseconds, count], omitting empty buckets:
+	const char* delim = "";
+	for (int bi=0; bi<InsertStageStatistics::NofHistogramBuckets; ++bi)
+	{
+		if (st.histogram( bi))
+		{
+			::fprintf( out, "%s[%llu,%llu]", delim, (unsigned long long)1 << bi, (unsigned long long)st.histogram( bi));
+			delim = ",";
+		}
+	}
+	::fprintf( out, "]}");
+}
+
+void InsertProfiler::writeReport( bool final)
+{
+	InsertStageStatistics total[ NofStages];
+	std::vector<ThreadStatistics>::const_iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		for (int si=0; si<NofStages; ++si) total[ si].merge( ti->stats[ si]);
+	}
+	double elapsed = (InsertProfilerTimer::wallClock() - m_startTime) / 1e9;
+	::fprintf( m_output, "{\"final\":%s,\"elapsed\":%.3f,\"total\":{", final?"true":"false", elapsed);
+	for (int si=0; si<NofStages; ++si)
+	{
+		::fprintf( m_output, "%s\"%s\":", si?",":"", stageName( (Stage)si));
+		printStageStatistics( m_output, total[ si]);
+	}
+	::fprintf( m_output, "},\"threads\":[");
+	for (ti = m_threads.begin(); ti != te; ++ti)
+	{
+		::fprintf( m_output, "%s{\"name\":", ti == m_threads.begin() ? "":",");
+		utils::printJsonString( m_output, ti->name);
+		for (int si=0; si<NofStages; ++si)
+		{
+			if (ti->stats[ si].count() == 0) continue;
+			::fprintf( m_output, ",\"%s\":", stageName( (Stage)si));
+			printStageStatistics( m_output, ti->stats[ si]);
+		}
+		::fprintf( m_output, "}");
+	}
+	::fprintf( m_output, "]}\n");
+	::fflush( m_output);
+}
+
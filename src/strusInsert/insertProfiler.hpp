@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_PROFILER_HPP_INCLUDED
+#define _STRUS_INSERTER_PROFILER_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "strus/base/stdint.h"
+#include <vector>
+#include <string>
+#include <cstdio>
+
+namespace strus {
+
+/// \brief Statistics of the time spent in one stage of the insert process
+class InsertStageStatistics
+{
+public:
+	/// \brief Number of buckets of the histogram of wall time per call, bucket i counts the calls with a duration < 2^i microseconds
+	enum {NofHistogramBuckets=32};
+
+	InsertStageStatistics()
+		:m_count(0),m_wallTime(0),m_cpuTime(0)
+	{
+		clear();
+	}
+
+	void add( uint64_t wallTime, uint64_t cpuTime);
+	void merge( const InsertStageStatistics& o);
+	void clear();
+
+	uint64_t count() const			{return m_count;}
+	uint64_t wallTime() const		{return m_wallTime;}
+	uint64_t cpuTime() const		{return m_cpuTime;}
+	uint64_t histogram( int idx) const	{return m_histogram[ idx];}
+
+private:
+	uint64_t m_count;			///< number of calls
+	uint64_t m_wallTime;			///< wall time in nanoseconds
+	uint64_t m_cpuTime;			///< thread CPU time in nanoseconds
+	uint64_t m_histogram[ NofHistogramBuckets];
+};
+
+/// \brief Collects the time spent in the stages of the insert process and writes a report in JSON (one object per line) periodically
+class InsertProfiler
+{
+public:
+	enum Stage
+	{
+		StageRead,		///< reading the input file
+		StageDetect,		///< detecting the document class (TextProcessorInterface::detectDocumentClass)
+		StageAnalyze,		///< document analysis (DocumentAnalyzerContextInterface::analyzeNext)
+		StageBuild,		///< populating the storage document (StorageDocumentInterface)
+		StageDone,		///< finishing the storage document (StorageDocumentInterface::done)
+		StageCommit,		///< committing a transaction (StorageTransactionInterface::commit)
+		StageWait		///< waiting for a full queue (indexer queue or commit queue) to accept a batch or a transaction
+	};
+	enum {NofStages=StageWait+1};
+	static const char* stageName( Stage stage);
+
+	/// \brief Constructor
+	/// \param[in] outputfile file to append the reports to, "-" for stderr
+	/// \param[in] reportInterval interval in seconds between reports, 0 for a report at the end only
+	InsertProfiler( const std::string& outputfile, unsigned int reportInterval);
+	~InsertProfiler();
+
+	/// \brief Register a thread with a name for the report
+	/// \return handle of the thread for merge
+	int registerThread( const std::string& name);
+
+	/// \brief Merge the statistics collected by a thread and write a report if the report interval has elapsed
+	/// \param[in] thread handle of the thread returned by registerThread
+	/// \param[in,out] stats statistics of the thread indexed by stage, cleared after merge
+	void merge( int thread, InsertStageStatistics* stats);
+
+	/// \brief Write the final report
+	void report();
+
+private:
+	void writeReport( bool final);
+
+private:
+	struct ThreadStatistics
+	{
+		std::string name;
+		InsertStageStatistics stats[ NofStages];
+
+		explicit ThreadStatistics( const std::string& name_)
+			:name(name_){}
+	};
+
+	strus::mutex m_mutex;
+	std::vector<ThreadStatistics> m_threads;
+	FILE* m_output;
+	bool m_ownOutput;
+	unsigned int m_reportInterval;
+	uint64_t m_startTime;
+	uint64_t m_lastReportTime;
+};
+
+/// \brief Statistics collected by one thread, merged into the profiler from time to time to avoid locking on every measurement
+class InsertProfilerContext
+{
+public:
+	/// \param[in] profiler_ profiler to merge into or NULL if profiling is disabled
+	/// \param[in] name_ name of the thread in the report
+	InsertProfilerContext( InsertProfiler* profiler_, const std::string& name_)
+		:m_profiler(profiler_),m_thread(profiler_ ? profiler_->registerThread( name_) : -1){}
+	~InsertProfilerContext()
+	{
+		flush();
+	}
+
+	bool enabled() const
+	{
+		return m_profiler != 0;
+	}
+	void add( InsertProfiler::Stage stage, uint64_t wallTime, uint64_t cpuTime)
+	{
+		m_stats[ stage].add( wallTime, cpuTime);
+	}
+	void flush()
+	{
+		if (m_profiler) m_profiler->merge( m_thread, m_stats);
+	}
+
+private:
+	InsertProfiler* m_profiler;
+	int m_thread;
+	InsertStageStatistics m_stats[ InsertProfiler::NofStages];
+};
+
+/// \brief Measures the wall and CPU time between calls of start and stop, does nothing if the context is disabled
+class InsertProfilerTimer
+{
+public:
+	explicit InsertProfilerTimer( InsertProfilerContext* ctx_)
+		:m_ctx(ctx_ && ctx_->enabled() ? ctx_ : 0),m_wallStart(0),m_cpuStart(0)
+	{
+		start();
+	}
+
+	void start()
+	{
+		if (m_ctx)
+		{
+			m_wallStart = wallClock();
+			m_cpuStart = cpuClock();
+		}
+	}
+	/// \brief Record the time elapsed since the last start or stop for a stage and restart the timer
+	void stop( InsertProfiler::Stage stage)
+	{
+		if (m_ctx)
+		{
+			uint64_t wallNow = wallClock();
+			uint64_t cpuNow = cpuClock();
+			m_ctx->add( stage, wallNow - m_wallStart, cpuNow - m_cpuStart);
+			m_wallStart = wallNow;
+			m_cpuStart = cpuNow;
+		}
+	}
+
+	static uint64_t wallClock();
+	static uint64_t cpuClock();
+
+private:
+	InsertProfilerContext* m_ctx;
+	uint64_t m_wallStart;
+	uint64_t m_cpuStart;
+};
+
+}//namespace
+#endif
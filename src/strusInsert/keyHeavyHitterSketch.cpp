@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "keyHeavyHitterSketch.hpp"
+#include "keyMapGenProcessor.hpp"
+
+using namespace strus;
+
+KeyHeavyHitterSketch::KeyHeavyHitterSketch( std::size_t capacity_)
+	:m_capacity(capacity_ ? capacity_ : 1),m_counters(),m_heap(),m_keyIndexMap(),m_totalCount(0)
+{}
+
+void KeyHeavyHitterSketch::clear()
+{
+	m_counters.clear();
+	m_heap.clear();
+	m_keyIndexMap.clear();
+	m_totalCount = 0;
+}
+
+void KeyHeavyHitterSketch::swapHeapElements( std::size_t aa, std::size_t bb)
+{
+	std::size_t tmp = m_heap[ aa];
+	m_heap[ aa] = m_heap[ bb];
+	m_heap[ bb] = tmp;
+	m_counters[ m_heap[ aa]].heappos = aa;
+	m_counters[ m_heap[ bb]].heappos = bb;
+}
+
+void KeyHeavyHitterSketch::siftDown( std::size_t heappos)
+{
+	std::size_t size = m_heap.size();
+	for (;;)
+	{
+		std::size_t smallest = heappos;
+		std::size_t left = 2*heappos + 1;
+		std::size_t right = left + 1;
+		if (left < size && m_counters[ m_heap[ left]].frequency < m_counters[ m_heap[ smallest]].frequency) smallest = left;
+		if (right < size && m_counters[ m_heap[ right]].frequency < m_counters[ m_heap[ smallest]].frequency) smallest = right;
+		if (smallest == heappos) break;
+		swapHeapElements( heappos, smallest);
+		heappos = smallest;
+	}
+}
+
+void KeyHeavyHitterSketch::siftUp( std::size_t heappos)
+{
+	while (heappos > 0)
+	{
+		std::size_t parent = (heappos - 1) / 2;
+		if (m_counters[ m_heap[ parent]].frequency <= m_counters[ m_heap[ heappos]].frequency) break;
+		swapHeapElements( heappos, parent);
+		heappos = parent;
+	}
+}
+
+void KeyHeavyHitterSketch::add( const std::string& key)
+{
+	++m_totalCount;
+	KeyIndexMap::iterator ki = m_keyIndexMap.find( key);
+	if (ki != m_keyIndexMap.end())
+	{
+		Counter& counter = m_counters[ ki->second];
+		++counter.frequency;
+		siftDown( counter.heappos);
+	}
+	else if (m_counters.size() < m_capacity)
+	{
+		std::size_t cidx = m_counters.size();
+		m_counters.push_back( Counter( key, 1, m_heap.size()));
+		m_heap.push_back( cidx);
+		m_keyIndexMap[ key] = cidx;
+		siftUp( m_heap.size()-1);
+	}
+	else
+	{
+		// Replace the key with the smallest frequency, the new key inherits its frequency as overestimation:
+		std::size_t cidx = m_heap[ 0];
+		Counter& counter = m_counters[ cidx];
+		m_keyIndexMap.erase( counter.key);
+		counter.key = key;
+		++counter.frequency;
+		m_keyIndexMap[ key] = cidx;
+		siftDown( 0);
+	}
+}
+
+void KeyHeavyHitterSketch::getSortedList( std::vector<KeyOccurrence>& result) const
+{
+	result.reserve( result.size() + m_keyIndexMap.size());
+	KeyIndexMap::const_iterator ki = m_keyIndexMap.begin(), ke = m_keyIndexMap.end();
+	for (; ki != ke; ++ki)
+	{
+		result.push_back( KeyOccurrence( ki->first, m_counters[ ki->second].frequency));
+	}
+}
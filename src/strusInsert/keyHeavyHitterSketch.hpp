@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_KEYMAP_KEY_HEAVY_HITTER_SKETCH_HPP_INCLUDED
+#define _STRUS_KEYMAP_KEY_HEAVY_HITTER_SKETCH_HPP_INCLUDED
+#include "strus/base/stdint.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Forward declaration
+class KeyOccurrence;
+
+/// \brief Approximate counter of the most frequent keys with bounded memory (SpaceSaving algorithm, Metwally et al.)
+/// \note Keeps at most 'capacity' keys. The frequency of a key is overestimated by at most totalCount()/capacity,
+///	every key with a frequency above this bound is kept
+class KeyHeavyHitterSketch
+{
+public:
+	/// \brief Constructor
+	/// \param[in] capacity_ maximum number of keys kept
+	explicit KeyHeavyHitterSketch( std::size_t capacity_);
+
+	/// \brief Count an occurrence of a key
+	void add( const std::string& key);
+
+	/// \brief Number of occurrences counted
+	uint64_t totalCount() const
+	{
+		return m_totalCount;
+	}
+
+	/// \brief Frequency a key not kept may have at most, 0 as long as no key has been evicted
+	std::size_t minFrequency() const
+	{
+		return m_counters.size() < m_capacity || m_heap.empty() ? 0 : m_counters[ m_heap[0]].frequency;
+	}
+
+	/// \brief Get the keys kept with their estimated frequencies (upper bounds) sorted by key
+	/// \param[out] result where to append the keys to
+	void getSortedList( std::vector<KeyOccurrence>& result) const;
+
+	/// \brief Remove all keys
+	void clear();
+
+private:
+	struct Counter
+	{
+		std::string key;
+		std::size_t frequency;		///< estimated frequency, upper bound of the real frequency
+		std::size_t heappos;		///< position of the counter in the heap
+
+		Counter( const std::string& key_, std::size_t frequency_, std::size_t heappos_)
+			:key(key_),frequency(frequency_),heappos(heappos_){}
+	};
+	typedef std::map<std::string,std::size_t> KeyIndexMap;
+
+	void siftDown( std::size_t heappos);
+	void siftUp( std::size_t heappos);
+	void swapHeapElements( std::size_t aa, std::size_t bb);
+
+private:
+	std::size_t m_capacity;
+	std::vector<Counter> m_counters;
+	std::vector<std::size_t> m_heap;	///< min heap of indices of counters ordered by frequency
+	KeyIndexMap m_keyIndexMap;		///< map of the keys kept to their counter index
+	uint64_t m_totalCount;
+};
+
+}//namespace
+#endif
@@ -11,13 +11,14 @@
 #include "strus/textProcessorInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/fileCrawlerInterface.hpp"
+#include "strus/analyzer/document.hpp"
 #include "strus/constants.hpp"
 #include "strus/base/fileio.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/string_format.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/thread.hpp"
 #include "private/internationalization.hpp"
+#include "private/documentInputStream.hpp"
 #include <iostream>
 #include <algorithm>
 
@@ -30,60 +31,123 @@ static bool compareKeyMapOccurrenceFrequency( const KeyOccurrence& aa, const Key
 	return aa.name() < bb.name();
 }
 
-void KeyMapGenResultList::push( KeyOccurrenceList& lst)
+void KeyMapGenResultList::push( KeyOccurrenceList& lst, std::size_t missingFrequency)
 {
 	strus::scoped_lock lock( m_mutex);
+	m_missingFrequencyBuf.reserve( m_missingFrequencyBuf.size()+1);
 	m_keyOccurrenceListBuf.push_back( KeyOccurrenceList());
 	m_keyOccurrenceListBuf.back().swap( lst);
+	m_missingFrequencyBuf.push_back( missingFrequency);
 }
 
-void KeyMapGenResultList::printKeyOccurrenceList( std::ostream& out, std::size_t maxNofResults) const
+std::size_t KeyMapGenResultList::maxOverestimation() const
 {
-	// Merge lists:
+	std::size_t rt = 0;
+	std::vector<std::size_t>::const_iterator mi = m_missingFrequencyBuf.begin(), me = m_missingFrequencyBuf.end();
+	for (; mi != me; ++mi) rt += *mi;
+	return rt;
+}
+
+namespace {
+/// \brief Cursor on one of the key occurrence lists merged, ordered in the merge heap by the name of the current element
+struct KeyOccurrenceListCursor
+{
+	KeyOccurrenceList::const_iterator itr;
+	KeyOccurrenceList::const_iterator end;
+	std::size_t missingFrequency;
+
+	KeyOccurrenceListCursor( const KeyOccurrenceList::const_iterator& itr_, const KeyOccurrenceList::const_iterator& end_, std::size_t missingFrequency_)
+		:itr(itr_),end(end_),missingFrequency(missingFrequency_){}
+};
+
+/// \brief Order of the merge heap, the cursor with the smallest name on top
+struct KeyOccurrenceListCursorOrder
+{
+	bool operator()( const KeyOccurrenceListCursor& aa, const KeyOccurrenceListCursor& bb) const
+	{
+		return bb.itr->name() < aa.itr->name();
+	}
+};
+
+/// \brief Order of the top-N heap, the element ranked worst on top
+struct KeyOccurrenceRankOrder
+{
+	bool operator()( const KeyOccurrence& aa, const KeyOccurrence& bb) const
+	{
+		return compareKeyMapOccurrenceFrequency( aa, bb);
+	}
+};
+}//anonymous namespace
+
+void KeyMapGenResultList::printKeyOccurrenceList( std::ostream& out, std::size_t maxNofResults, bool withFrequency) const
+{
+	if (maxNofResults == 0) return;
+
+	// Merge the lists sorted by name with a heap of cursors, summing up the frequencies of a key in one pass.
+	// A key missing in a list built with approximate counting gets the frequency it may have at most in this list:
+	std::size_t totalMissingFrequency = maxOverestimation();
+	std::vector<KeyOccurrenceListCursor> mergeHeap;
+	mergeHeap.reserve( m_keyOccurrenceListBuf.size());
 	std::vector<KeyOccurrenceList>::const_iterator
 		ki = m_keyOccurrenceListBuf.begin(),
 		ke = m_keyOccurrenceListBuf.end();
-
-	KeyOccurrenceList result = *ki;
-	for (++ki; ki != ke; ++ki)
+	std::vector<std::size_t>::const_iterator mi = m_missingFrequencyBuf.begin();
+	for (; ki != ke; ++ki,++mi)
 	{
-		KeyOccurrenceList prev;
-		prev.swap( result);
+		if (!ki->empty()) mergeHeap.push_back( KeyOccurrenceListCursor( ki->begin(), ki->end(), *mi));
+	}
+	KeyOccurrenceListCursorOrder mergeOrder;
+	std::make_heap( mergeHeap.begin(), mergeHeap.end(), mergeOrder);
 
-		KeyOccurrenceList::const_iterator ai = prev.begin(), ae = prev.end();
-		KeyOccurrenceList::const_iterator bi = ki->begin(), be = ki->end();
+	// Select the best ranked keys with a heap bounded to the number of results, the worst element selected on top:
+	KeyOccurrenceList result;
+	result.reserve( maxNofResults);
+	KeyOccurrenceRankOrder rankOrder;
 
-		while (ai != ae && bi != be)
+	while (!mergeHeap.empty())
+	{
+		const std::string& name = mergeHeap.front().itr->name();
+		std::size_t frequency = totalMissingFrequency;
+		KeyOccurrenceList::const_iterator keyitr = mergeHeap.front().itr;
+		//... the name referenced stays valid as the lists are not modified
+		while (!mergeHeap.empty() && mergeHeap.front().itr->name() == name)
 		{
-			if (ai->name() <= bi->name())
+			std::pop_heap( mergeHeap.begin(), mergeHeap.end(), mergeOrder);
+			KeyOccurrenceListCursor& cursor = mergeHeap.back();
+			frequency += cursor.itr->frequency() - cursor.missingFrequency;
+			if (++cursor.itr == cursor.end)
 			{
-				if (ai->name() == bi->name())
-				{
-					result.push_back( KeyOccurrence( ai->name(), ai->frequency() + bi->frequency()));
-					++ai;
-					++bi;
-				}
-				else
-				{
-					result.push_back( KeyOccurrence( ai->name(), ai->frequency()));
-					++ai;
-				}
+				mergeHeap.pop_back();
 			}
 			else
 			{
-				result.push_back( KeyOccurrence( bi->name(), bi->frequency()));
-				++bi;
+				std::push_heap( mergeHeap.begin(), mergeHeap.end(), mergeOrder);
 			}
 		}
+		KeyOccurrence occurrence( keyitr->name(), frequency);
+		if (result.size() < maxNofResults)
+		{
+			result.push_back( occurrence);
+			std::push_heap( result.begin(), result.end(), rankOrder);
+		}
+		else if (compareKeyMapOccurrenceFrequency( occurrence, result.front()))
+		{
+			std::pop_heap( result.begin(), result.end(), rankOrder);
+			result.back() = occurrence;
+			std::push_heap( result.begin(), result.end(), rankOrder);
+		}
 	}
-	// Sort result:
-	std::sort( result.begin(), result.end(), compareKeyMapOccurrenceFrequency);
-
-	// Print result:
-	std::size_t ri = 0, re = maxNofResults<result.size()?maxNofResults:result.size();
+	// Print result, best ranked first:
+	std::sort_heap( result.begin(), result.end(), rankOrder);
+	KeyOccurrenceList::const_iterator ri = result.begin(), re = result.end();
 	for (; ri != re; ++ri)
 	{
-		out << result[ ri].name() << std::endl;
+		out << ri->name();
+		if (withFrequency)
+		{
+			out << "\t" << ri->frequency();
+		}
+		out << std::endl;
 	}
 }
 
@@ -93,6 +157,9 @@ KeyMapGenProcessor::KeyMapGenProcessor(
 		const analyzer::DocumentClass& defaultDocumentClass_,
 		KeyMapGenResultList* que_,
 		FileCrawlerInterface* crawler_,
+		bool containerItems_,
+		DocumentClassCache* dclassCache_,
+		std::size_t sketchSize_,
 		ErrorBufferInterface* errorhnd_)
 
 	:m_textproc(textproc_)
@@ -100,9 +167,18 @@ KeyMapGenProcessor::KeyMapGenProcessor(
 	,m_defaultDocumentClass(defaultDocumentClass_)
 	,m_que(que_)
 	,m_crawler(crawler_)
+	,m_containerItems(containerItems_)
+	,m_dclassCache(dclassCache_)
+	,m_counter()
+	,m_sketch()
 	,m_terminated(false)
 	,m_errorhnd(errorhnd_)
-{}
+{
+	if (sketchSize_)
+	{
+		m_sketch.reset( new KeyHeavyHitterSketch( sketchSize_));
+	}
+}
 
 KeyMapGenProcessor::~KeyMapGenProcessor()
 {
@@ -118,23 +194,26 @@ void KeyMapGenProcessor::run()
 {
 	std::vector<std::string> files;
 	std::vector<std::string>::const_iterator fitr;
+	strus::analyzer::Document doc;
+	//... reused for all documents analyzed to keep the memory allocated
 
 	while (!(files=m_crawler->fetch()).empty())
 	{
 		try
 		{
-			typedef std::map<std::string,int> KeyOccurrenceMap;
-			KeyOccurrenceMap keyOccurrenceMap;
-
 			fitr = files.begin();
 			for (int fidx=0; !m_terminated.test() && fitr != files.end(); ++fitr,++fidx)
 			{
 				try
 				{
-					strus::InputStream input( *fitr);
+					strus::utils::DocumentInputStream input( *fitr, m_containerItems);
 					strus::local_ptr<strus::DocumentAnalyzerContextInterface> analyzerContext;
 					strus::analyzer::DocumentClass dclass;
-					if (!m_defaultDocumentClass.defined())
+					if (m_defaultDocumentClass.defined())
+					{
+						dclass = m_defaultDocumentClass;
+					}
+					else if (!getCachedDocumentClass( m_dclassCache, dclass, *fitr))
 					{
 						// Read the input file to analyze and detect its document type:
 						char hdrbuf[ 4096];
@@ -144,16 +223,12 @@ void KeyMapGenProcessor::run()
 							std::cerr << string_format( _TXT( "failed to read document file '%s': %s"), fitr->c_str(), ::strerror( input.error())) << std::endl; 
 							break;
 						}
-						if (!m_textproc->detectDocumentClass( dclass, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf)))
+						if (!detectDocumentClass( m_dclassCache, dclass, *fitr, m_textproc, hdrbuf, hdrsize, hdrsize < sizeof(hdrbuf)))
 						{
 							std::cerr << string_format( _TXT( "failed to detect document class of file '%s'"), fitr->c_str()) << std::endl; 
 							continue;
 						}
 					}
-					else
-					{
-						dclass = m_defaultDocumentClass;
-					}
 					const strus::DocumentAnalyzerInstanceInterface* analyzer = m_analyzerMap->get( dclass);
 					if (!analyzer)
 					{
@@ -183,7 +258,6 @@ void KeyMapGenProcessor::run()
 						analyzerContext->putInput( buf, readsize, eof);
 			
 						// Analyze the document and print the result:
-						strus::analyzer::Document doc;
 						while (analyzerContext->analyzeNext( doc))
 						{
 							// Define all search index term occurrencies:
@@ -192,15 +266,13 @@ void KeyMapGenProcessor::run()
 								te = doc.searchIndexTerms().end();
 							for (; ti != te; ++ti)
 							{
-								KeyOccurrenceMap::iterator
-									ki = keyOccurrenceMap.find( ti->value());
-								if (ki == keyOccurrenceMap.end())
+								if (m_sketch.get())
 								{
-									keyOccurrenceMap[ ti->value()] = 1;
+									m_sketch->add( ti->value());
 								}
 								else
 								{
-									++ki->second;
+									m_counter.add( ti->value());
 								}
 							}
 						}
@@ -217,14 +289,6 @@ void KeyMapGenProcessor::run()
 			}
 			if (!m_terminated.test())
 			{
-				KeyOccurrenceList keyOccurrenceList;
-				KeyOccurrenceMap::const_iterator
-					ki = keyOccurrenceMap.begin(), ke = keyOccurrenceMap.end();
-				for (; ki != ke; ++ki)
-				{
-					keyOccurrenceList.push_back( KeyOccurrence( ki->first, ki->second));
-				}
-				m_que->push( keyOccurrenceList);
 				std::cerr << ".";
 			}
 		}
@@ -245,6 +309,31 @@ void KeyMapGenProcessor::run()
 			}
 		}
 	}
+	// Pass the keys counted by this thread to the final merge:
+	if (!m_terminated.test())
+	{
+		try
+		{
+			KeyOccurrenceList keyOccurrenceList;
+			if (m_sketch.get())
+			{
+				m_sketch->getSortedList( keyOccurrenceList);
+				std::size_t missingFrequency = m_sketch->minFrequency();
+				m_sketch->clear();
+				m_que->push( keyOccurrenceList, missingFrequency);
+			}
+			else
+			{
+				m_counter.getSortedList( keyOccurrenceList);
+				m_counter.clear();
+				m_que->push( keyOccurrenceList);
+			}
+		}
+		catch (const std::bad_alloc&)
+		{
+			std::cerr << _TXT("out of memory when passing the keys counted to the merge") << std::endl;
+		}
+	}
 	m_errorhnd->releaseContext();
 }
 
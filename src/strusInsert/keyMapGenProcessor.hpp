@@ -13,6 +13,10 @@
 #include "strus/base/thread.hpp"
 #include "strus/base/atomic.hpp"
 #include "private/documentAnalyzer.hpp"
+#include "private/documentClassCache.hpp"
+#include "keyOccurrenceCounter.hpp"
+#include "keyHeavyHitterSketch.hpp"
+#include "strus/base/local_ptr.hpp"
 
 namespace strus {
 
@@ -49,13 +53,24 @@ class KeyMapGenResultList
 {
 public:
 	KeyMapGenResultList(){}
-	void push( KeyOccurrenceList& lst);
+	/// \brief Add a list of keys with their frequencies sorted by key to merge
+	/// \param[in,out] lst list to add, empty after the call
+	/// \param[in] missingFrequency frequency a key not in the list may have at most, if the list has been built with a sketch (approximate counting)
+	void push( KeyOccurrenceList& lst, std::size_t missingFrequency=0);
 
-	void printKeyOccurrenceList( std::ostream& out, std::size_t maxNofResults) const;
+	/// \brief Print the best ranked keys of the merged lists, one per line
+	/// \param[in] out where to print to
+	/// \param[in] maxNofResults maximum number of keys to print
+	/// \param[in] withFrequency true, if the (estimated) frequency is printed after the key, separated by a tab
+	void printKeyOccurrenceList( std::ostream& out, std::size_t maxNofResults, bool withFrequency=false) const;
+
+	/// \brief Maximum overestimation of the frequency of a key in the merge of approximate counts
+	std::size_t maxOverestimation() const;
 
 private:
 	strus::mutex m_mutex;
 	std::vector<KeyOccurrenceList> m_keyOccurrenceListBuf;
+	std::vector<std::size_t> m_missingFrequencyBuf;
 };
 
 
@@ -68,6 +83,9 @@ public:
 			const analyzer::DocumentClass& defaultDocumentClass_,
 			KeyMapGenResultList* que_,
 			FileCrawlerInterface* crawler_,
+			bool containerItems_,
+			DocumentClassCache* dclassCache_,
+			std::size_t sketchSize_,
 			ErrorBufferInterface* errorhnd_);
 
 	~KeyMapGenProcessor();
@@ -81,6 +99,10 @@ private:
 	analyzer::DocumentClass m_defaultDocumentClass;
 	KeyMapGenResultList* m_que;
 	FileCrawlerInterface* m_crawler;
+	bool m_containerItems;
+	DocumentClassCache* m_dclassCache;
+	KeyOccurrenceCounter m_counter;		///< key occurrences counted over all chunks processed by this thread
+	strus::local_ptr<KeyHeavyHitterSketch> m_sketch;	///< sketch used instead of m_counter for approximate counting of the most frequent keys
 	strus::AtomicFlag m_terminated;
 	ErrorBufferInterface* m_errorhnd;
 };
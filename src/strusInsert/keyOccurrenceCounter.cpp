@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "keyOccurrenceCounter.hpp"
+#include "keyMapGenProcessor.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace strus;
+
+KeyOccurrenceCounter::KeyOccurrenceCounter()
+	:m_table(),m_nofKeys(0),m_pool(),m_poolpos(0),m_poolsize(0)
+{}
+
+KeyOccurrenceCounter::~KeyOccurrenceCounter()
+{
+	clear();
+}
+
+void KeyOccurrenceCounter::clear()
+{
+	std::vector<char*>::iterator pi = m_pool.begin(), pe = m_pool.end();
+	for (; pi != pe; ++pi) delete [] *pi;
+	m_pool.clear();
+	m_poolpos = 0;
+	m_poolsize = 0;
+	m_table.clear();
+	m_nofKeys = 0;
+}
+
+uint32_t KeyOccurrenceCounter::hashKey( const char* key, std::size_t keysize)
+{
+	// FNV-1a:
+	uint32_t hh = 2166136261U;
+	const char* ke = key + keysize;
+	for (; key != ke; ++key)
+	{
+		hh ^= (unsigned char)*key;
+		hh *= 16777619U;
+	}
+	return hh;
+}
+
+const char* KeyOccurrenceCounter::allocKey( const char* key, std::size_t keysize)
+{
+	if (m_pool.empty() || m_poolpos + keysize > m_poolsize)
+	{
+		// Keys bigger than a block get a block of their own:
+		std::size_t blocksize = keysize > (std::size_t)PoolBlockSize ? keysize : (std::size_t)PoolBlockSize;
+		m_pool.reserve( m_pool.size() + 1);
+		m_pool.push_back( new char[ blocksize]);
+		m_poolpos = 0;
+		m_poolsize = blocksize;
+	}
+	char* rt = m_pool.back() + m_poolpos;
+	std::memcpy( rt, key, keysize);
+	m_poolpos += keysize;
+	return rt;
+}
+
+void KeyOccurrenceCounter::rehash( std::size_t capacity)
+{
+	Entry empty;
+	std::memset( &empty, 0, sizeof(empty));
+	std::vector<Entry> table( capacity, empty);
+	std::size_t mask = capacity - 1;
+	std::vector<Entry>::const_iterator ei = m_table.begin(), ee = m_table.end();
+	for (; ei != ee; ++ei)
+	{
+		if (!ei->key) continue;
+		std::size_t slot = ei->hash & mask;
+		while (table[ slot].key) slot = (slot + 1) & mask;
+		table[ slot] = *ei;
+	}
+	m_table.swap( table);
+}
+
+void KeyOccurrenceCounter::add( const char* key, std::size_t keysize)
+{
+	if ((m_nofKeys + 1) * 10 > m_table.size() * 7)
+	{
+		rehash( m_table.empty() ? (std::size_t)InitialCapacity : m_table.size() * 2);
+	}
+	uint32_t hash = hashKey( key, keysize);
+	std::size_t mask = m_table.size() - 1;
+	std::size_t slot = hash & mask;
+	for (;;)
+	{
+		Entry& entry = m_table[ slot];
+		if (!entry.key)
+		{
+			entry.key = allocKey( key, keysize);
+			entry.keysize = keysize;
+			entry.hash = hash;
+			entry.frequency = 1;
+			++m_nofKeys;
+			return;
+		}
+		if (entry.hash == hash && entry.keysize == keysize && 0==std::memcmp( entry.key, key, keysize))
+		{
+			++entry.frequency;
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+/// \brief Order of entries by key, the same as the order of std::string
+struct KeyOccurrenceCounter::EntryKeyOrder
+{
+	bool operator()( const Entry* aa, const Entry* bb) const
+	{
+		std::size_t minsize = aa->keysize < bb->keysize ? aa->keysize : bb->keysize;
+		int cmp = std::memcmp( aa->key, bb->key, minsize);
+		return cmp ? (cmp < 0) : (aa->keysize < bb->keysize);
+	}
+};
+
+void KeyOccurrenceCounter::getSortedList( std::vector<KeyOccurrence>& result) const
+{
+	std::vector<const Entry*> entries;
+	entries.reserve( m_nofKeys);
+	std::vector<Entry>::const_iterator ei = m_table.begin(), ee = m_table.end();
+	for (; ei != ee; ++ei)
+	{
+		if (ei->key) entries.push_back( &*ei);
+	}
+	std::sort( entries.begin(), entries.end(), EntryKeyOrder());
+
+	result.reserve( result.size() + entries.size());
+	std::vector<const Entry*>::const_iterator si = entries.begin(), se = entries.end();
+	for (; si != se; ++si)
+	{
+		result.push_back( KeyOccurrence( std::string( (*si)->key, (*si)->keysize), (*si)->frequency));
+	}
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_KEYMAP_KEY_OCCURRENCE_COUNTER_HPP_INCLUDED
+#define _STRUS_KEYMAP_KEY_OCCURRENCE_COUNTER_HPP_INCLUDED
+#include "strus/base/stdint.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Forward declaration
+class KeyOccurrence;
+
+/// \brief Counter of key occurrences in an open addressing hash table (linear probing) with the keys stored in a string pool
+/// \note Counting a key already seen does not allocate any memory
+class KeyOccurrenceCounter
+{
+public:
+	KeyOccurrenceCounter();
+	~KeyOccurrenceCounter();
+
+	/// \brief Count an occurrence of a key
+	void add( const char* key, std::size_t keysize);
+	void add( const std::string& key)
+	{
+		add( key.c_str(), key.size());
+	}
+
+	/// \brief Number of distinct keys counted
+	std::size_t size() const
+	{
+		return m_nofKeys;
+	}
+
+	/// \brief Get the keys with their frequencies sorted by key
+	/// \param[out] result where to append the keys to
+	void getSortedList( std::vector<KeyOccurrence>& result) const;
+
+	/// \brief Remove all keys and free the memory of the string pool
+	void clear();
+
+private:
+	KeyOccurrenceCounter( const KeyOccurrenceCounter&){}	//... non copyable
+	void operator=( const KeyOccurrenceCounter&){}		//... non copyable
+
+	struct Entry
+	{
+		const char* key;		///< key in the string pool or NULL for an empty slot
+		uint32_t keysize;
+		uint32_t hash;
+		std::size_t frequency;
+	};
+	struct EntryKeyOrder;
+
+	static uint32_t hashKey( const char* key, std::size_t keysize);
+	const char* allocKey( const char* key, std::size_t keysize);
+	void rehash( std::size_t capacity);
+
+	enum {InitialCapacity=1<<10, PoolBlockSize=1<<16};
+
+private:
+	std::vector<Entry> m_table;		///< hash table, capacity is a power of 2 and kept at most 70% filled
+	std::size_t m_nofKeys;
+	std::vector<char*> m_pool;		///< blocks of the string pool holding the keys
+	std::size_t m_poolpos;			///< number of bytes used in the last block of the string pool
+	std::size_t m_poolsize;			///< size of the last block of the string pool
+};
+
+}//namespace
+#endif
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/analyzer_prgload_std.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/base/programOptions.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/versionModule.hpp"
+#include "strus/versionAnalyzer.hpp"
+#include "strus/versionBase.hpp"
+#include "private/versionUtilities.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include "private/documentAnalyzer.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+// Count the heap allocations of the program with a replaced global operator new.
+// The analysis measured runs in the main thread only, so the counter does not need to be atomic:
+static unsigned long g_nofAllocations = 0;
+
+#if __cplusplus >= 201103L
+#define ALLOC_THROW_SPEC
+#define DEALLOC_THROW_SPEC noexcept
+#else
+#define ALLOC_THROW_SPEC throw (std::bad_alloc)
+#define DEALLOC_THROW_SPEC throw ()
+#endif
+
+void* operator new( std::size_t size) ALLOC_THROW_SPEC
+{
+	++g_nofAllocations;
+	void* rt = std::malloc( size ? size : 1);
+	if (!rt) throw std::bad_alloc();
+	return rt;
+}
+
+void* operator new[]( std::size_t size) ALLOC_THROW_SPEC
+{
+	++g_nofAllocations;
+	void* rt = std::malloc( size ? size : 1);
+	if (!rt) throw std::bad_alloc();
+	return rt;
+}
+
+void operator delete( void* ptr) DEALLOC_THROW_SPEC
+{
+	std::free( ptr);
+}
+
+void operator delete[]( void* ptr) DEALLOC_THROW_SPEC
+{
+	std::free( ptr);
+}
+
+static std::string getFileArg( const std::string& filearg, strus::ModuleLoaderInterface* moduleLoader)
+{
+	std::string programFileName = filearg;
+	std::string programDir;
+	int ec;
+
+	if (strus::isExplicitPath( programFileName))
+	{
+		ec = strus::getParentPath( programFileName, programDir);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file directory from explicit path '%s': %s"), programFileName.c_str(), ::strerror(ec));
+		moduleLoader->addResourcePath( programDir);
+	}
+	else
+	{
+		std::string filedir;
+		std::string filenam;
+		ec = strus::getFileName( programFileName, filenam);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file name from absolute path '%s': %s"), programFileName.c_str(), ::strerror(ec));
+		ec = strus::getParentPath( programFileName, filedir);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file directory from absolute path '%s': %s"), programFileName.c_str(), ::strerror(ec));
+		programDir = filedir;
+		programFileName = filenam;
+		moduleLoader->addResourcePath( programDir);
+	}
+	return programFileName;
+}
+
+/// \brief Document to benchmark loaded into memory with its document class
+struct BenchmarkDocument
+{
+	std::string filename;
+	std::string content;
+	strus::analyzer::DocumentClass dclass;
+};
+
+/// \brief Result of analyzing all documents in one mode
+struct BenchmarkResult
+{
+	unsigned long nofAllocations;
+	unsigned long nofDocuments;
+	bool capacityKept;
+	std::size_t checksum;
+
+	BenchmarkResult()
+		:nofAllocations(0),nofDocuments(0),capacityKept(true),checksum(0){}
+};
+
+// Touch the parts of a document visited by the indexer, iterating over the structures either by reference or with a copy:
+static std::size_t visitDocument( const strus::analyzer::Document& doc, bool copyStructures)
+{
+	std::size_t rt = doc.searchIndexTerms().size() + doc.forwardIndexTerms().size();
+	if (copyStructures)
+	{
+		std::vector<strus::analyzer::DocumentStructure> structlist = doc.searchIndexStructures();
+		rt += structlist.size();
+	}
+	else
+	{
+		rt += doc.searchIndexStructures().size();
+	}
+	return rt;
+}
+
+// Analyze all documents with a new document object per input buffer and copying the structures (as the insert loop did before)
+// or with one document object reused for all (as the insert loop does now):
+static BenchmarkResult runBenchmark(
+		const strus::DocumentAnalyzer& analyzerMap,
+		const std::vector<BenchmarkDocument>& documents,
+		unsigned int nofRepeats,
+		bool reuseDocument)
+{
+	BenchmarkResult rt;
+	strus::analyzer::Document reusedDoc;
+	unsigned long startNofAllocations = g_nofAllocations;
+
+	for (unsigned int ri=0; ri < nofRepeats; ++ri)
+	{
+		std::vector<BenchmarkDocument>::const_iterator di = documents.begin(), de = documents.end();
+		for (; di != de; ++di)
+		{
+			const strus::DocumentAnalyzerInstanceInterface* analyzer = analyzerMap.get( di->dclass);
+			if (!analyzer) throw strus::runtime_error( _TXT("no analyzer defined for document '%s'"), di->filename.c_str());
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> analyzerContext( analyzer->createContext( di->dclass));
+			if (!analyzerContext.get()) throw std::runtime_error( _TXT("error creating analyzer context"));
+			analyzerContext->putInput( di->content.c_str(), di->content.size(), true);
+
+			if (reuseDocument)
+			{
+				std::size_t capacity = reusedDoc.searchIndexTerms().capacity();
+				while (analyzerContext->analyzeNext( reusedDoc))
+				{
+					if (reusedDoc.searchIndexTerms().capacity() < capacity) rt.capacityKept = false;
+					capacity = reusedDoc.searchIndexTerms().capacity();
+					rt.checksum += visitDocument( reusedDoc, false);
+					++rt.nofDocuments;
+				}
+			}
+			else
+			{
+				strus::analyzer::Document doc;
+				while (analyzerContext->analyzeNext( doc))
+				{
+					rt.checksum += visitDocument( doc, true);
+					++rt.nofDocuments;
+				}
+			}
+		}
+	}
+	rt.nofAllocations = g_nofAllocations - startNofAllocations;
+	return rt;
+}
+
+int main( int argc_, const char* argv_[])
+{
+	int rt = 0;
+	strus::DebugTraceInterface* dbgtrace = strus::createDebugTrace_standard( 2);
+	if (!dbgtrace)
+	{
+		std::cerr << _TXT("failed to create debug trace") << std::endl;
+		return -1;
+	}
+	strus::local_ptr<strus::ErrorBufferInterface> errorBuffer( strus::createErrorBuffer_standard( 0, 2, dbgtrace/*passed with ownership*/));
+	if (!errorBuffer.get())
+	{
+		delete dbgtrace;
+		std::cerr << _TXT("failed to create error buffer") << std::endl;
+		return -1;
+	}
+	try
+	{
+		bool printUsageAndExit = false;
+		strus::ProgramOptions opt(
+				errorBuffer.get(), argc_, argv_, 11,
+				"h,help", "v,version", "license",
+				"m,module:", "M,moduledir:", "R,resourcedir:",
+				"s,segmenter:", "C,contenttype:", "x,extension:",
+				"n,repeat:", "q,quiet");
+		if (errorBuffer->hasError())
+		{
+			throw strus::runtime_error(_TXT("failed to parse program arguments"));
+		}
+		if (opt( "help")) printUsageAndExit = true;
+
+		strus::local_ptr<strus::ModuleLoaderInterface> moduleLoader( strus::createModuleLoader( errorBuffer.get()));
+		if (!moduleLoader.get()) throw std::runtime_error( _TXT("failed to create module loader"));
+		if (opt("moduledir"))
+		{
+			std::vector<std::string> modirlist( opt.list("moduledir"));
+			std::vector<std::string>::const_iterator mi = modirlist.begin(), me = modirlist.end();
+			for (; mi != me; ++mi)
+			{
+				moduleLoader->addModulePath( *mi);
+			}
+			moduleLoader->addSystemModulePath();
+		}
+		if (opt("module"))
+		{
+			std::vector<std::string> modlist( opt.list("module"));
+			std::vector<std::string>::const_iterator mi = modlist.begin(), me = modlist.end();
+			for (; mi != me; ++mi)
+			{
+				if (!moduleLoader->loadModule( *mi))
+				{
+					throw strus::runtime_error(_TXT("error failed to load module %s"), mi->c_str());
+				}
+			}
+		}
+		if (opt("license"))
+		{
+			std::vector<std::string> licenses_3rdParty = moduleLoader->get3rdPartyLicenseTexts();
+			std::vector<std::string>::const_iterator ti = licenses_3rdParty.begin(), te = licenses_3rdParty.end();
+			if (ti != te) std::cout << _TXT("3rd party licenses:") << std::endl;
+			for (; ti != te; ++ti)
+			{
+				std::cout << *ti << std::endl;
+			}
+			std::cout << std::endl;
+			if (!printUsageAndExit) return 0;
+		}
+		if (opt( "version"))
+		{
+			std::cout << _TXT("Strus utilities version ") << STRUS_UTILITIES_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus module version ") << STRUS_MODULE_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus analyzer version ") << STRUS_ANALYZER_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus base version ") << STRUS_BASE_VERSION_STRING << std::endl;
+			if (!printUsageAndExit) return 0;
+		}
+		else if (!printUsageAndExit)
+		{
+			if (opt.nofargs() > 2)
+			{
+				std::cerr << _TXT("too many arguments") << std::endl;
+				printUsageAndExit = true;
+				rt = 1;
+			}
+			if (opt.nofargs() < 2)
+			{
+				std::cerr << _TXT("too few arguments") << std::endl;
+				printUsageAndExit = true;
+				rt = 2;
+			}
+		}
+		if (printUsageAndExit)
+		{
+			std::cout << _TXT("usage:") << " strusBenchmarkDocumentAlloc [options] <program> <docpath>" << std::endl;
+			std::cout << "<program> = " << _TXT("path of analyzer program or analyzer map") << std::endl;
+			std::cout << "<docpath> = " << _TXT("path of document or directory with the documents to analyze") << std::endl;
+			std::cout << _TXT("description: Counts the heap allocations of analyzing documents with a new") << std::endl;
+			std::cout << "             " << _TXT("document object per input and of analyzing them into one document") << std::endl;
+			std::cout << "             " << _TXT("object reused, as strusInsert does. The exit code is 3 if reusing") << std::endl;
+			std::cout << "             " << _TXT("the document does not reduce the number of allocations or if the") << std::endl;
+			std::cout << "             " << _TXT("analyzer does not keep the capacity of the document reused.") << std::endl;
+			std::cout << _TXT("options:") << std::endl;
+			std::cout << "-h|--help" << std::endl;
+			std::cout << "    " << _TXT("Print this usage and do nothing else") << std::endl;
+			std::cout << "-v|--version" << std::endl;
+			std::cout << "    " << _TXT("Print the program version and do nothing else") << std::endl;
+			std::cout << "--license" << std::endl;
+			std::cout << "    " << _TXT("Print 3rd party licences requiring reference") << std::endl;
+			std::cout << "-m|--module <MOD>" << std::endl;
+			std::cout << "    " << _TXT("Load components from module <MOD>") << std::endl;
+			std::cout << "-M|--moduledir <DIR>" << std::endl;
+			std::cout << "    " << _TXT("Search modules to load first in <DIR>") << std::endl;
+			std::cout << "-R|--resourcedir <DIR>" << std::endl;
+			std::cout << "    " << _TXT("Search resource files for analyzer first in <DIR>") << std::endl;
+			std::cout << "-s|--segmenter <NAME>" << std::endl;
+			std::cout << "    " << _TXT("Use the document segmenter with name <NAME>") << std::endl;
+			std::cout << "-C|--contenttype <CT>" << std::endl;
+			std::cout << "    " << _TXT("forced definition of the document class of all documents processed.") << std::endl;
+			std::cout << "-x|--extension <EXT>" << std::endl;
+			std::cout << "    " << _TXT("Grab only the files with extension <EXT> (default all files)") << std::endl;
+			std::cout << "-n|--repeat <N>" << std::endl;
+			std::cout << "    " << _TXT("Analyze the documents <N> times in each mode (default 10)") << std::endl;
+			std::cout << "-q|--quiet" << std::endl;
+			std::cout << "    " << _TXT("Print only the number of documents and the verdict, not the counts") << std::endl;
+			return rt;
+		}
+		unsigned int nofRepeats = 10;
+		if (opt("repeat"))
+		{
+			nofRepeats = opt.asUint( "repeat");
+			if (nofRepeats == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--repeat");
+		}
+		std::string fileext;
+		if (opt( "extension"))
+		{
+			fileext = opt[ "extension"];
+			if (fileext.size() && fileext[0] != '.')
+			{
+				fileext = std::string(".") + fileext;
+			}
+		}
+		std::string segmenterName;
+		if (opt( "segmenter"))
+		{
+			segmenterName = opt[ "segmenter"];
+		}
+		if (opt("resourcedir"))
+		{
+			std::vector<std::string> pathlist( opt.list("resourcedir"));
+			std::vector<std::string>::const_iterator
+				pi = pathlist.begin(), pe = pathlist.end();
+			for (; pi != pe; ++pi)
+			{
+				moduleLoader->addResourcePath( *pi);
+			}
+		}
+		std::string programFileName = getFileArg( opt[0], moduleLoader.get());
+		std::string datapath = opt[1];
+
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface>
+			analyzerBuilder( moduleLoader->createAnalyzerObjectBuilder());
+		if (!analyzerBuilder.get()) throw std::runtime_error( _TXT("failed to create analyzer object builder"));
+		const strus::TextProcessorInterface* textproc = analyzerBuilder->getTextProcessor();
+		if (!textproc) throw std::runtime_error( _TXT("failed to get text processor"));
+
+		strus::analyzer::DocumentClass documentClass;
+		if (opt( "contenttype"))
+		{
+			documentClass = strus::parse_DocumentClass( opt[ "contenttype"], errorBuffer.get());
+			if (!documentClass.defined() && errorBuffer->hasError())
+			{
+				throw std::runtime_error( _TXT("failed to parse document class"));
+			}
+		}
+
+		// Load the documents into memory, so that reading them does not count:
+		std::vector<std::string> filenames;
+		if (strus::isDir( datapath))
+		{
+			std::vector<std::string> files;
+			int ec = strus::readDirFiles( datapath, fileext, files);
+			if (ec) throw strus::runtime_error( _TXT("could not read directory to process '%s': %s"), datapath.c_str(), ::strerror(ec));
+			std::sort( files.begin(), files.end());
+			std::vector<std::string>::const_iterator fi = files.begin(), fe = files.end();
+			for (; fi != fe; ++fi)
+			{
+				filenames.push_back( strus::joinFilePath( datapath, *fi));
+			}
+		}
+		else
+		{
+			filenames.push_back( datapath);
+		}
+		std::vector<BenchmarkDocument> documents;
+		std::vector<std::string>::const_iterator fi = filenames.begin(), fe = filenames.end();
+		for (; fi != fe; ++fi)
+		{
+			documents.push_back( BenchmarkDocument());
+			BenchmarkDocument& doc = documents.back();
+			doc.filename = *fi;
+			int ec = strus::readFile( doc.filename, doc.content);
+			if (ec) throw strus::runtime_error( _TXT("failed to read document file '%s': %s"), doc.filename.c_str(), ::strerror(ec));
+			if (documentClass.defined())
+			{
+				doc.dclass = documentClass;
+			}
+			else if (!textproc->detectDocumentClass( doc.dclass, doc.content.c_str(), doc.content.size(), true))
+			{
+				throw strus::runtime_error( _TXT("failed to detect document class of file '%s'"), doc.filename.c_str());
+			}
+			if (!documentClass.defined()) documentClass = doc.dclass;
+		}
+		strus::DocumentAnalyzer analyzerMap( analyzerBuilder.get(), documentClass, segmenterName, programFileName, errorBuffer.get());
+		if (errorBuffer->hasError())
+		{
+			throw std::runtime_error( _TXT("error in initialization"));
+		}
+
+		// Run the benchmark in both modes and check that they produce the same analysis result:
+		BenchmarkResult newDocResult = runBenchmark( analyzerMap, documents, nofRepeats, false);
+		BenchmarkResult reusedDocResult = runBenchmark( analyzerMap, documents, nofRepeats, true);
+		if (newDocResult.checksum != reusedDocResult.checksum || newDocResult.nofDocuments != reusedDocResult.nofDocuments)
+		{
+			throw std::runtime_error( _TXT("analysis result differs when reusing the document"));
+		}
+		unsigned long nofDocuments = reusedDocResult.nofDocuments / nofRepeats;
+		bool reduced = reusedDocResult.nofAllocations < newDocResult.nofAllocations;
+
+		std::cout << strus::string_format( _TXT("documents analyzed: %lu"), nofDocuments) << std::endl;
+		if (!opt("quiet"))
+		{
+			std::cout << strus::string_format( _TXT("allocations with a new document per input: %lu (%.1f per document)"),
+							newDocResult.nofAllocations, (double)newDocResult.nofAllocations / newDocResult.nofDocuments) << std::endl;
+			std::cout << strus::string_format( _TXT("allocations with the document reused: %lu (%.1f per document)"),
+							reusedDocResult.nofAllocations, (double)reusedDocResult.nofAllocations / reusedDocResult.nofDocuments) << std::endl;
+		}
+		std::cout << strus::string_format( _TXT("allocations reduced: %s"), reduced ? "yes":"no") << std::endl;
+		std::cout << strus::string_format( _TXT("capacity of the document reused kept: %s"), reusedDocResult.capacityKept ? "yes":"no") << std::endl;
+		if (!reduced || !reusedDocResult.capacityKept)
+		{
+			rt = 3;
+		}
+		if (errorBuffer->hasError())
+		{
+			throw strus::runtime_error(_TXT("unhandled error in document allocation benchmark: %s"), errorBuffer->fetchError());
+		}
+		return rt;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << _TXT("ERROR ") << _TXT("out of memory") << std::endl;
+		return -2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		const char* errormsg = errorBuffer->fetchError();
+		if (errormsg)
+		{
+			std::cerr << _TXT("ERROR ") << e.what() << ": " << errormsg << std::endl;
+		}
+		else
+		{
+			std::cerr << _TXT("ERROR ") << e.what() << std::endl;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << _TXT("EXCEPTION ") << e.what() << std::endl;
+	}
+	return -1;
+}
@@ -34,7 +34,6 @@
 #include "strus/base/cmdLineOpt.hpp"
 #include "strus/base/configParser.hpp"
 #include "strus/base/string_format.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/thread.hpp"
 #include "strus/versionAnalyzer.hpp"
@@ -48,8 +47,11 @@
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
+#include "private/documentInputStream.hpp"
+#include "private/documentClassCache.hpp"
 #include "private/programLoader.hpp"
 #include "checkInsertProcessor.hpp"
+#include "checkInsertSummary.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -126,12 +128,14 @@ int main( int argc_, const char* argv_[])
 	{
 		bool printUsageAndExit = false;
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc_, argv_, 17,
+				errorBuffer.get(), argc_, argv_, 24,
 				"h,help", "v,version", "license",
 				"G,debug:", "t,threads:", "l,logfile:", "n,notify:",
 				"R,resourcedir:", "M,moduledir:", "m,module:", 
 				"C,contenttype:", "x,extension:", "r,rpc:",
 				"g,segmenter:", "s,storage:", "S,configfile:",
+				"detectcache:", "detectsample:", "containers",
+				"summary:", "batch:", "sample:", "seed:",
 				"T,trace:");
 		if (errorBuffer->hasError())
 		{
@@ -286,12 +290,29 @@ int main( int argc_, const char* argv_[])
 			std::cout << "    " << _TXT("forced definition of the document class of all documents checked.") << std::endl;
 			std::cout << "-x|--extension <EXT>" << std::endl;
 			std::cout << "    " << _TXT("Grab only the files with extension <EXT> (default all files)") << std::endl;
+			strus::printDocumentClassCacheUsage( std::cout);
+			std::cout << "--containers" << std::endl;
+			std::cout << "    " << _TXT("Split JSON lines files (*.jsonl, *.ndjson) and tar archives (*.tar) into") << std::endl;
+			std::cout << "    " << _TXT("their records and process every record as a file of its own") << std::endl;
 			std::cout << "-t|--threads <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of inserter threads to use") << std::endl;
 			std::cout << "-l|--logfile <FILE>" << std::endl;
 			std::cout << "    " << _TXT("Set <FILE> as output file (default stdout)") << std::endl;
 			std::cout << "-n|--notify <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as notification interval (number of documents)") << std::endl;
+			std::cout << "--summary <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Compare the documents batchwise with the storage instead of logging") << std::endl;
+			std::cout << "    " << _TXT("every difference and write a summary of the differences found as JSON") << std::endl;
+			std::cout << "    " << _TXT("to <FILE> (missing documents, forward index term counts, meta data") << std::endl;
+			std::cout << "    " << _TXT("and attribute mismatches), \"-\" for stdout") << std::endl;
+			std::cout << "--batch <N>" << std::endl;
+			std::cout << "    " << _TXT("Check <N> documents per batch with --summary (default 256)") << std::endl;
+			std::cout << "--sample <RATE>" << std::endl;
+			std::cout << "    " << _TXT("Check only a random sample of the fraction <RATE> (e.g. 0.02) of the files") << std::endl;
+			std::cout << "    " << _TXT("of every chunk and report the confidence intervals of the rates of") << std::endl;
+			std::cout << "    " << _TXT("missing and differing documents in the summary (with --summary only)") << std::endl;
+			std::cout << "--seed <N>" << std::endl;
+			std::cout << "    " << _TXT("Use <N> as seed of the sample selection (default 0, with --sample only)") << std::endl;
 			std::cout << "-T|--trace <CONFIG>" << std::endl;
 			std::cout << "    " << _TXT("Print method call traces configured with <CONFIG>") << std::endl;
 			std::cout << "    " << strus::string_format( _TXT("Example: %s"), "-T \"log=dump;file=stdout\"") << std::endl;
@@ -406,6 +427,45 @@ int main( int argc_, const char* argv_[])
 		const strus::TextProcessorInterface* textproc = analyzerBuilder->getTextProcessor();
 		if (!textproc) throw std::runtime_error( _TXT("failed to get text processor"));
 
+		// Create the cache of document classes detected if enabled:
+		strus::local_ptr<strus::DocumentClassCache> dclassCache( strus::createDocumentClassCache( opt));
+
+		// Create the summary report of the differences if enabled:
+		strus::local_ptr<strus::CheckInsertReport> report;
+		unsigned int batchSize = 256;
+		double sampleRate = 0.0;
+		unsigned int sampleSeed = 0;
+		if (opt("sample"))
+		{
+			if (!opt("summary")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--sample", "--summary");
+			sampleRate = opt.asDouble( "sample");
+			if (sampleRate <= 0.0 || sampleRate > 1.0)
+			{
+				throw strus::runtime_error( _TXT("value of option %s out of range"), "--sample");
+			}
+			if (opt("seed"))
+			{
+				sampleSeed = opt.asUint( "seed");
+			}
+		}
+		else if (opt("seed"))
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--seed", "--sample");
+		}
+		if (opt("summary"))
+		{
+			report.reset( new strus::CheckInsertReport( sampleRate, sampleSeed));
+			if (opt("batch"))
+			{
+				batchSize = opt.asUint( "batch");
+				if (batchSize == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--batch");
+			}
+		}
+		else if (opt("batch"))
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--batch", "--summary");
+		}
+
 		// Try to determine document class:
 		strus::analyzer::DocumentClass documentClass;
 		if (!contenttype.empty())
@@ -418,7 +478,7 @@ int main( int argc_, const char* argv_[])
 		}
 		else if (strus::isFile( datapath))
 		{
-			strus::InputStream input( datapath);
+			strus::utils::DocumentInputStream input( datapath, false/*containerItems*/);
 			char hdrbuf[ 4096];
 			std::size_t hdrsize = input.readAhead( hdrbuf, sizeof( hdrbuf));
 			if (input.error())
@@ -436,11 +496,22 @@ int main( int argc_, const char* argv_[])
 		// Process input:
 		strus::local_ptr<strus::FileCrawlerInterface> fileCrawler( strus::createFileCrawlerInterface( datapath, notificationInterval, fileext, errorBuffer.get()));
 		if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		if (opt("containers"))
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_container( fileCrawler.release(), notificationInterval, errorBuffer.get()));
+			if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		}
+		if (sampleRate > 0.0)
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_sample( fileCrawler.release(), datapath, sampleRate, sampleSeed, errorBuffer.get()));
+			if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		}
 
 		if (nofThreads == 0)
 		{
 			strus::CheckInsertProcessor checker(
-				storage.get(), textproc, &analyzerMap, documentClass, fileCrawler.get(), logfile, errorBuffer.get());
+				storage.get(), textproc, &analyzerMap, documentClass, fileCrawler.get(), dclassCache.get(), logfile,
+				report.get(), batchSize, errorBuffer.get());
 			checker.run();
 		}
 		else
@@ -452,7 +523,8 @@ int main( int argc_, const char* argv_[])
 				processorList.push_back(
 					new strus::CheckInsertProcessor(
 						storage.get(), textproc, &analyzerMap, documentClass,
-						fileCrawler.get(), logfile, errorBuffer.get()));
+						fileCrawler.get(), opt("containers"), dclassCache.get(), logfile,
+						report.get(), batchSize, errorBuffer.get()));
 			}
 			{
 				std::vector<strus::Reference<strus::thread> > threadGroup;
@@ -470,6 +542,10 @@ int main( int argc_, const char* argv_[])
 		{
 			throw std::runtime_error( _TXT("unhandled error in check insert"));
 		}
+		if (report.get())
+		{
+			report->write( opt[ "summary"]);
+		}
 		std::cerr << _TXT("done.") << std::endl;
 		if (!dumpDebugTrace( dbgtrace, NULL/*filename ~ NULL = stderr*/))
 		{
@@ -22,7 +22,6 @@
 #include "strus/base/fileio.hpp"
 #include "strus/base/string_format.hpp"
 #include "strus/base/cmdLineOpt.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/thread.hpp"
 #include "strus/versionModule.hpp"
@@ -35,6 +34,8 @@
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
 #include "private/documentAnalyzer.hpp"
+#include "private/documentInputStream.hpp"
+#include "private/documentClassCache.hpp"
 #include "private/programLoader.hpp"
 #include "keyMapGenProcessor.hpp"
 #include <iostream>
@@ -91,12 +92,13 @@ int main( int argc_, const char* argv_[])
 	{
 		bool printUsageAndExit = false;
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc_, argv_, 14,
+				errorBuffer.get(), argc_, argv_, 19,
 				"h,help",  "v,version", "license",
 				"G,debug:", "t,threads:", "u,unit:",
 				"n,results:","m,module:", "x,extension:",
 				"s,segmenter:", "C,contenttype:", "M,moduledir:", "R,resourcedir:",
-				"T,trace:");
+				"detectcache:", "detectsample:", "containers",
+				"approx:", "F,frequency", "T,trace:");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
@@ -219,12 +221,24 @@ int main( int argc_, const char* argv_[])
 			std::cout << "    " << _TXT("forced definition of the document class of all documents processed.") << std::endl;
 			std::cout << "-x|--extension <EXT>" << std::endl;
 			std::cout << "    " << _TXT("Grab only the files with extension <EXT> (default all files)") << std::endl;
+			strus::printDocumentClassCacheUsage( std::cout);
+			std::cout << "--containers" << std::endl;
+			std::cout << "    " << _TXT("Split JSON lines files (*.jsonl, *.ndjson) and tar archives (*.tar) into") << std::endl;
+			std::cout << "    " << _TXT("their records and process every record as a file of its own") << std::endl;
 			std::cout << "-t|--threads <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of threads to use") << std::endl;
 			std::cout << "-u|--unit <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of files processed per iteration (default 1000)") << std::endl;
 			std::cout << "-n|--results <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of elements in the key map generated") << std::endl;
+			std::cout << "--approx <E>" << std::endl;
+			std::cout << "    " << _TXT("Count only the most frequent keys approximately in bounded memory,") << std::endl;
+			std::cout << "    " << _TXT("keeping 1/<E> keys per thread (at least the number of results). The") << std::endl;
+			std::cout << "    " << _TXT("frequency of a key is overestimated by at most <E> times the number of") << std::endl;
+			std::cout << "    " << _TXT("key occurrences (e.g. 0.0001)") << std::endl;
+			std::cout << "-F|--frequency" << std::endl;
+			std::cout << "    " << _TXT("Print the (estimated) frequency of every key, separated by a tab") << std::endl;
+			std::cout << "    " << _TXT("after the key") << std::endl;
 			std::cout << "-T|--trace <CONFIG>" << std::endl;
 			std::cout << "    " << _TXT("Print method call traces configured with <CONFIG>") << std::endl;
 			std::cout << "    " << strus::string_format( _TXT("Example: %s"), "-T \"log=dump;file=stdout\"") << std::endl;
@@ -250,6 +264,19 @@ int main( int argc_, const char* argv_[])
 			unitSize = opt.asUint( "unit");
 		}
 		unsigned int nofResults = opt.asUint( "results");
+		bool printFrequency = opt( "frequency");
+		std::size_t sketchSize = 0;
+		if (opt( "approx"))
+		{
+			double approxError = opt.asDouble( "approx");
+			if (approxError <= 0.0 || approxError >= 1.0)
+			{
+				throw strus::runtime_error( _TXT("value of option %s out of range"), "--approx");
+			}
+			sketchSize = (std::size_t)(1.0 / approxError);
+			if ((double)sketchSize * approxError < 1.0) ++sketchSize;
+			if (sketchSize < nofResults) sketchSize = nofResults;
+		}
 		std::string fileext = "";
 		std::string segmenterName;
 		std::string contenttype;
@@ -308,6 +335,9 @@ int main( int argc_, const char* argv_[])
 		const strus::TextProcessorInterface* textproc = analyzerBuilder->getTextProcessor();
 		if (!textproc) throw std::runtime_error( _TXT("failed to get text processor"));
 
+		// Create the cache of document classes detected if enabled:
+		strus::local_ptr<strus::DocumentClassCache> dclassCache( strus::createDocumentClassCache( opt));
+
 		// Try to determine document class:
 		strus::analyzer::DocumentClass documentClass;
 		if (!contenttype.empty())
@@ -320,7 +350,7 @@ int main( int argc_, const char* argv_[])
 		}
 		else if (strus::isFile( datapath))
 		{
-			strus::InputStream input( datapath);
+			strus::utils::DocumentInputStream input( datapath, false/*containerItems*/);
 			char hdrbuf[ 4096];
 			std::size_t hdrsize = input.readAhead( hdrbuf, sizeof( hdrbuf));
 			if (input.error())
@@ -340,12 +370,17 @@ int main( int argc_, const char* argv_[])
 		strus::KeyMapGenResultList resultList;
 		strus::local_ptr<strus::FileCrawlerInterface> fileCrawler( strus::createFileCrawlerInterface( datapath, unitSize, fileext, errorBuffer.get()));
 		if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		if (opt("containers"))
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_container( fileCrawler.release(), unitSize, errorBuffer.get()));
+			if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		}
 
 		if (nofThreads == 0)
 		{
 			strus::KeyMapGenProcessor processor(
 				textproc, &analyzerMap, documentClass,
-				&resultList, fileCrawler.get(), errorBuffer.get());
+				&resultList, fileCrawler.get(), opt("containers"), dclassCache.get(), sketchSize, errorBuffer.get());
 			processor.run();
 		}
 		else
@@ -356,7 +391,7 @@ int main( int argc_, const char* argv_[])
 				processorList.push_back(
 					new strus::KeyMapGenProcessor(
 						textproc, &analyzerMap, documentClass, 
-						&resultList, fileCrawler.get(), errorBuffer.get()));
+						&resultList, fileCrawler.get(), opt("containers"), dclassCache.get(), sketchSize, errorBuffer.get()));
 			}
 			{
 				std::vector<strus::Reference<strus::thread> > threadGroup;
@@ -372,7 +407,11 @@ int main( int argc_, const char* argv_[])
 		}
 		// [3] Final merge:
 		std::cerr << std::endl << _TXT("merging results:") << std::endl;
-		resultList.printKeyOccurrenceList( std::cout, nofResults);
+		resultList.printKeyOccurrenceList( std::cout, nofResults, printFrequency);
+		if (sketchSize)
+		{
+			std::cerr << strus::string_format( _TXT("frequencies of the keys approximated with an overestimation of at most %u"), (unsigned int)resultList.maxOverestimation()) << std::endl;
+		}
 		
 		if (errorBuffer->hasError())
 		{
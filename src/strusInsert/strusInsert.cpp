@@ -34,7 +34,6 @@
 #include "strus/base/cmdLineOpt.hpp"
 #include "strus/base/configParser.hpp"
 #include "strus/base/string_format.hpp"
-#include "strus/base/inputStream.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/thread.hpp"
 #include "strus/versionStorage.hpp"
@@ -48,9 +47,16 @@
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
 #include "private/documentAnalyzer.hpp"
+#include "private/documentInputStream.hpp"
+#include "private/documentClassCache.hpp"
 #include "private/programLoader.hpp"
 #include "commitQueue.hpp"
 #include "insertProcessor.hpp"
+#include "insertProfiler.hpp"
+#include "indexProcessor.hpp"
+#include "analyzedDocumentQueue.hpp"
+#include "transactionSizeControl.hpp"
+#include "insertJournal.hpp"
 #include <iostream>
 #include <sstream>
 #include <memory>
@@ -58,6 +64,11 @@
 #include <cerrno>
 #include <cstdio>
 #include <stdexcept>
+#include <set>
+#include <vector>
+
+/// \brief Number of documents per batch passed from the analyzer to the indexer threads (option --indexthreads)
+enum {IndexBatchSize=32};
 
 static void printStorageConfigOptions( std::ostream& out, const strus::ModuleLoaderInterface* moduleLoader, const std::string& config, strus::ErrorBufferInterface* errorhnd)
 {
@@ -83,6 +94,40 @@ static void printStorageConfigOptions( std::ostream& out, const strus::ModuleLoa
 					strus::StorageInterface::CmdCreateClient), errorhnd);
 }
 
+/// \brief Closes the queue of analyzed documents and joins the indexer threads, also when leaving the scope with an exception
+class IndexerThreadGuard
+{
+public:
+	IndexerThreadGuard( strus::AnalyzedDocumentQueue* queue_, std::vector<strus::Reference<strus::thread> >* threadGroup_)
+		:m_queue(queue_),m_threadGroup(threadGroup_){}
+	~IndexerThreadGuard()
+	{
+		try
+		{
+			join();
+		}
+		catch (...) {}
+	}
+
+	/// \brief Close the queue and wait for the indexer threads to process the batches still queued
+	void join()
+	{
+		if (m_queue)
+		{
+			m_queue->close();
+			m_queue = 0;
+		}
+		std::vector<strus::Reference<strus::thread> >::iterator
+			gi = m_threadGroup->begin(), ge = m_threadGroup->end();
+		for (; gi != ge; ++gi) (*gi)->join();
+		m_threadGroup->clear();
+	}
+
+private:
+	strus::AnalyzedDocumentQueue* m_queue;
+	std::vector<strus::Reference<strus::thread> >* m_threadGroup;
+};
+
 static std::string getFileArg( const std::string& filearg, strus::ModuleLoaderInterface* moduleLoader)
 {
 	std::string programFileName = filearg;
@@ -130,13 +175,21 @@ int main( int argc_, const char* argv_[])
 	{
 		bool printUsageAndExit = false;
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc_, argv_, 18,
+				errorBuffer.get(), argc_, argv_, 36,
 				"h,help", "v,version", "license",
 				"G,debug:", "t,threads:", "c,commit:", "f,fetch:",
+				"committhreads:", "commitqueue:", "commitmem:",
+				"transactionmem:", "commitlatency:", "transactionstats",
+				"indexthreads:", "indexqueue:",
+				"balance:", "lookahead:", "mmap",
+				"journal:", "resume",
+				"profile:", "profileinterval:",
 				"g,segmenter:", "C,contenttype:", "m,module:",
 				"L,logerror:", "M,moduledir:", "R,resourcedir:",
 				"r,rpc:", "x,extension:", "s,storage:",
-				"S,configfile:", "V,verbose", "T,trace:");
+				"S,configfile:", "V,verbose",
+				"detectcache:", "detectsample:", "containers",
+				"T,trace:");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
@@ -156,10 +209,23 @@ int main( int argc_, const char* argv_[])
 		}
 
 		int nofThreads = 0;
+		int nofCommitThreads = 0;
+		int nofIndexThreads = 0;
 		if (opt("threads"))
 		{
 			nofThreads = opt.asUint( "threads");
-			if (!errorBuffer->setMaxNofThreads( nofThreads+2))
+		}
+		if (opt("committhreads"))
+		{
+			nofCommitThreads = opt.asUint( "committhreads");
+		}
+		if (opt("indexthreads"))
+		{
+			nofIndexThreads = opt.asUint( "indexthreads");
+		}
+		if (nofThreads || nofCommitThreads || nofIndexThreads)
+		{
+			if (!errorBuffer->setMaxNofThreads( nofThreads+nofCommitThreads+nofIndexThreads+2))
 			{
 				std::cerr << _TXT("failed to set number of threads for error buffer (option --threads)") << std::endl;
 				return -1;
@@ -289,17 +355,69 @@ int main( int argc_, const char* argv_[])
 			std::cout << "    " << _TXT("forced definition of the document class of all documents inserted.") << std::endl;
 			std::cout << "-x|--extension <EXT>" << std::endl;
 			std::cout << "    " << _TXT("Grab only the files with extension <EXT> (default all files)") << std::endl;
+			strus::printDocumentClassCacheUsage( std::cout);
+			std::cout << "--containers" << std::endl;
+			std::cout << "    " << _TXT("Split JSON lines files (*.jsonl, *.ndjson) and tar archives (*.tar) into") << std::endl;
+			std::cout << "    " << _TXT("their records and process every record as a file of its own") << std::endl;
 			std::cout << "-t|--threads <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of inserter threads to use") << std::endl;
 			std::cout << "-c|--commit <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of documents inserted per transaction (default 1000)") << std::endl;
+			std::cout << "--committhreads <N>" << std::endl;
+			std::cout << "    " << _TXT("Set <N> as number of threads committing transactions in the background") << std::endl;
+			std::cout << "    " << _TXT("Default is 0 (transactions are committed by the inserter threads)") << std::endl;
+			std::cout << "--commitqueue <N>" << std::endl;
+			std::cout << "    " << _TXT("Set <N> as maximum number of transactions open for commit") << std::endl;
+			std::cout << "    " << _TXT("before inserter threads are blocked (default 4, with --committhreads only)") << std::endl;
+			std::cout << "--commitmem <MB>" << std::endl;
+			std::cout << "    " << _TXT("Set <MB> as maximum estimated size in megabytes of transactions open for commit") << std::endl;
+			std::cout << "    " << _TXT("before inserter threads are blocked (default no limit, with --committhreads only)") << std::endl;
+			std::cout << "--transactionmem <MB>" << std::endl;
+			std::cout << "    " << _TXT("Size the transactions adaptively with a memory budget of <MB> megabytes") << std::endl;
+			std::cout << "    " << _TXT("for all transactions held in memory: a transaction is passed to commit when") << std::endl;
+			std::cout << "    " << _TXT("its estimated size reaches a limit derived from the observed commit") << std::endl;
+			std::cout << "    " << _TXT("throughput and the target commit latency. Option '--commit' becomes an") << std::endl;
+			std::cout << "    " << _TXT("upper bound of documents per transaction (default no limit).") << std::endl;
+			std::cout << "--commitlatency <MS>" << std::endl;
+			std::cout << "    " << _TXT("Set <MS> as target duration of a commit in milliseconds") << std::endl;
+			std::cout << "    " << _TXT("(default 1000, with --transactionmem only)") << std::endl;
+			std::cout << "--transactionstats" << std::endl;
+			std::cout << "    " << _TXT("Print the number of commits and the changes of the transaction size limit") << std::endl;
+			std::cout << "    " << _TXT("to stdout at the end (with --transactionmem only)") << std::endl;
+			std::cout << "--indexthreads <N>" << std::endl;
+			std::cout << "    " << _TXT("Separate document analysis from indexing: the inserter threads only analyze") << std::endl;
+			std::cout << "    " << _TXT("the documents and pass them in batches to <N> indexer threads building the") << std::endl;
+			std::cout << "    " << _TXT("transactions. Default is 0 (inserter threads analyze and index)") << std::endl;
+			std::cout << "--indexqueue <N>" << std::endl;
+			std::cout << "    " << _TXT("Set <N> as maximum number of batches of analyzed documents waiting for") << std::endl;
+			std::cout << "    " << strus::string_format( _TXT("the indexer threads (default 16, %d documents per batch)"), (int)IndexBatchSize) << std::endl;
 			std::cout << "-f|--fetch <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of files fetched in each inserter iteration") << std::endl;
 			std::cout << "    " << _TXT("Default is the value of option '--commit' (one document/file)") << std::endl;
+			std::cout << "--balance <KB>" << std::endl;
+			std::cout << "    " << _TXT("Build the chunks of files fetched with a total size of at most <KB> kilobytes") << std::endl;
+			std::cout << "    " << _TXT("and schedule them to the inserter threads with work stealing") << std::endl;
+			std::cout << "    " << _TXT("(the maximum number of files per chunk is still defined by '--fetch')") << std::endl;
+			std::cout << "--lookahead <N>" << std::endl;
+			std::cout << "    " << _TXT("Read the directories in a background thread while inserting,") << std::endl;
+			std::cout << "    " << _TXT("keeping at most <N> chunks of files ahead of the inserter threads") << std::endl;
+			std::cout << "--mmap" << std::endl;
+			std::cout << "    " << _TXT("Map the input files into memory and pass them to the analyzer in one piece") << std::endl;
+			std::cout << "    " << _TXT("instead of reading them in buffers of fixed size") << std::endl;
+			std::cout << "--journal <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Append the files whose documents are all committed to the journal <FILE>") << std::endl;
+			std::cout << "--resume" << std::endl;
+			std::cout << "    " << _TXT("Skip the files recorded as committed in the journal (option --journal),") << std::endl;
+			std::cout << "    " << _TXT("for continuing an insert that was interrupted with the same <docpath> arguments") << std::endl;
 			std::cout << "-L|--logerror <FILE>" << std::endl;
 			std::cout << "    " << _TXT("Write the last error occurred to <FILE> in case of an exception")  << std::endl;
 			std::cout << "-V|--verbose" << std::endl;
 			std::cout << "    " << _TXT("verbose output") << std::endl;
+			std::cout << "--profile <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Measure the time spent in the stages of the insert process and") << std::endl;
+			std::cout << "    " << _TXT("append the report in JSON (one object per line) to <FILE> ('-' for stderr)") << std::endl;
+			std::cout << "--profileinterval <SEC>" << std::endl;
+			std::cout << "    " << _TXT("Write a profiler report every <SEC> seconds (default only at the end)") << std::endl;
 			std::cout << "-T|--trace <CONFIG>" << std::endl;
 			std::cout << "    " << _TXT("Print method call traces configured with <CONFIG>") << std::endl;
 			std::cout << "    " << strus::string_format( _TXT("Example: %s"), "-T \"log=dump;file=stdout\"") << std::endl;
@@ -329,12 +447,79 @@ int main( int argc_, const char* argv_[])
 		{
 			transactionSize = opt.asUint( "commit");
 		}
+		unsigned int maxNofOpenTransactions = 4;
+		if (opt("commitqueue"))
+		{
+			maxNofOpenTransactions = opt.asUint( "commitqueue");
+			if (maxNofOpenTransactions == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--commitqueue");
+		}
+		std::size_t maxBufferedBytes = 0;
+		if (opt("commitmem"))
+		{
+			maxBufferedBytes = (std::size_t)opt.asUint( "commitmem") * 1024 * 1024;
+		}
+		std::size_t transactionMemoryBudget = 0;
+		unsigned int commitLatency = 1000;
+		if (opt("transactionmem"))
+		{
+			transactionMemoryBudget = (std::size_t)opt.asUint( "transactionmem") * 1024 * 1024;
+			if (transactionMemoryBudget == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--transactionmem");
+		}
+		if (opt("commitlatency"))
+		{
+			if (!opt("transactionmem")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--commitlatency", "--transactionmem");
+			commitLatency = opt.asUint( "commitlatency");
+		}
+		if (opt("transactionstats") && !opt("transactionmem"))
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--transactionstats", "--transactionmem");
+		}
+		unsigned int indexQueueSize = 16;
+		if (opt("indexqueue"))
+		{
+			if (!opt("indexthreads")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--indexqueue", "--indexthreads");
+			indexQueueSize = opt.asUint( "indexqueue");
+			if (indexQueueSize == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--indexqueue");
+		}
 		unsigned int fetchSize = transactionSize;
 		if (opt("fetch"))
 		{
 			fetchSize = opt.asUint( "fetch");
 		}
+		uint64_t balanceChunkBytes = 0;
+		bool balance = false;
+		if (opt("balance"))
+		{
+			balance = true;
+			balanceChunkBytes = (uint64_t)opt.asUint( "balance") * 1024;
+		}
+		unsigned int lookahead = 0;
+		if (opt("lookahead"))
+		{
+			if (opt("balance")) throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), "--balance", "--lookahead");
+			lookahead = opt.asUint( "lookahead");
+			if (lookahead == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--lookahead");
+		}
 		bool verbose = opt( "verbose");
+		bool useMmap = opt( "mmap");
+		std::string journalFile;
+		if (opt("journal"))
+		{
+			journalFile = opt[ "journal"];
+		}
+		bool resume = opt( "resume");
+		if (resume && !opt("journal")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--resume", "--journal");
+		std::string profileOutput;
+		unsigned int profileInterval = 0;
+		if (opt("profile"))
+		{
+			profileOutput = opt[ "profile"];
+		}
+		if (opt("profileinterval"))
+		{
+			if (!opt("profile")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--profileinterval", "--profile");
+			profileInterval = opt.asUint( "profileinterval");
+		}
 
 		// Parse arguments:
 		std::string fileext = "";
@@ -425,6 +610,9 @@ int main( int argc_, const char* argv_[])
 		const strus::TextProcessorInterface* textproc = analyzerBuilder->getTextProcessor();
 		if (!textproc) throw std::runtime_error( _TXT("failed to get text processor"));
 
+		// Create the cache of document classes detected if enabled:
+		strus::local_ptr<strus::DocumentClassCache> dclassCache( strus::createDocumentClassCache( opt));
+
 		// Try to determine document class:
 		strus::analyzer::DocumentClass documentClass;
 		if (!contenttype.empty())
@@ -437,7 +625,7 @@ int main( int argc_, const char* argv_[])
 		}
 		else if (!datapath.empty() && strus::isFile( datapath[0]))
 		{
-			strus::InputStream input( datapath[0]);
+			strus::utils::DocumentInputStream input( datapath[0], false/*containerItems*/);
 			char hdrbuf[ 4096];
 			std::size_t hdrsize = input.readAhead( hdrbuf, sizeof( hdrbuf));
 			if (input.error())
@@ -453,47 +641,142 @@ int main( int argc_, const char* argv_[])
 		strus::DocumentAnalyzer analyzerMap( analyzerBuilder.get(), documentClass, segmenterName, programFileName, errorBuffer.get());
 
 		// Start inserter process:
+		strus::local_ptr<strus::InsertProfiler> profiler;
+		if (!profileOutput.empty())
+		{
+			profiler.reset( new strus::InsertProfiler( profileOutput, profileInterval));
+		}
+		// Transactions held in memory at the same time are the ones open in the threads
+		// building them and the ones waiting for or being in commit:
+		int nofConcurrentTransactions = nofIndexThreads ? nofIndexThreads : (nofThreads ? nofThreads : 1);
+		if (nofCommitThreads) nofConcurrentTransactions += maxNofOpenTransactions;
+		int maxNofDocumentsPerTransaction = (transactionMemoryBudget && !opt("commit")) ? 0 : transactionSize;
+		std::set<std::string> filesCompleted;
+		strus::local_ptr<strus::InsertJournal> journal;
+		if (!journalFile.empty())
+		{
+			if (resume)
+			{
+				filesCompleted = strus::InsertJournal::readCompletedFiles( journalFile);
+			}
+			journal.reset( new strus::InsertJournal( journalFile));
+		}
+		strus::TransactionSizeControl sizeControl(
+				maxNofDocumentsPerTransaction, transactionMemoryBudget,
+				nofConcurrentTransactions, commitLatency);
 		strus::local_ptr<strus::CommitQueue>
-			commitQue( new strus::CommitQueue( storage.get(), verbose, errorBuffer.get()));
+			commitQue( new strus::CommitQueue(
+					storage.get(), verbose, nofCommitThreads,
+					maxNofOpenTransactions, maxBufferedBytes,
+					profiler.get(), &sizeControl, journal.get(), errorBuffer.get()));
 
-		strus::local_ptr<strus::FileCrawlerInterface> fileCrawler( strus::createFileCrawlerInterface( datapath, fetchSize, fileext, errorBuffer.get()));
+		strus::local_ptr<strus::FileCrawlerInterface> fileCrawler;
+		if (balance)
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_workstealing( datapath, fetchSize, balanceChunkBytes, nofThreads ? nofThreads : 1, fileext, errorBuffer.get()));
+		}
+		else if (lookahead)
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_streaming( datapath, fetchSize, lookahead, fileext, errorBuffer.get()));
+		}
+		else
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface( datapath, fetchSize, fileext, errorBuffer.get()));
+		}
 		if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		if (opt("containers"))
+		{
+			fileCrawler.reset( strus::createFileCrawlerInterface_container( fileCrawler.release(), fetchSize, errorBuffer.get()));
+			if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		}
+		if (!filesCompleted.empty())
+		{
+			std::cerr << strus::string_format( _TXT("resuming insert, skipping %u files already committed"), (unsigned int)filesCompleted.size()) << std::endl;
+			fileCrawler.reset( strus::createFileCrawlerInterface_skip( fileCrawler.release(), filesCompleted, errorBuffer.get()));
+			if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
+		}
+		// Create the document analyzer processors first, so that nothing is left to fail when the indexer threads are running:
+		int nofProcessors = nofThreads ? nofThreads : 1;
+		strus::local_ptr<strus::AnalyzedDocumentQueue> docQueue;
+		if (nofIndexThreads)
+		{
+			docQueue.reset( new strus::AnalyzedDocumentQueue( indexQueueSize, IndexBatchSize));
+		}
+		std::vector<strus::Reference<strus::InsertProcessor> > processorList;
+		processorList.reserve( nofProcessors);
+		for (int ti = 0; ti<nofProcessors; ++ti)
+		{
+			processorList.push_back(
+				new strus::InsertProcessor(
+					storage.get(), textproc, &analyzerMap, documentClass, commitQue.get(), docQueue.get(),
+					profiler.get(), fileCrawler.get(), opt("containers"), ti/*worker*/, &sizeControl, journal.get(), dclassCache.get(), useMmap, verbose, errorBuffer.get()));
+		}
+		// Start the indexer threads if analysis and indexing are separated:
+		std::vector<strus::Reference<strus::IndexProcessor> > indexerList;
+		std::vector<strus::Reference<strus::thread> > indexerThreadGroup;
+		IndexerThreadGuard indexerThreadGuard( docQueue.get(), &indexerThreadGroup);
+		if (nofIndexThreads)
+		{
+			indexerList.reserve( nofIndexThreads);
+			for (int ti = 0; ti<nofIndexThreads; ++ti)
+			{
+				indexerList.push_back(
+					new strus::IndexProcessor(
+						storage.get(), commitQue.get(), docQueue.get(),
+						profiler.get(), ti/*worker*/, &sizeControl, journal.get(), errorBuffer.get()));
+			}
+			for (int ti=0; ti<nofIndexThreads; ++ti)
+			{
+				strus::IndexProcessor* tc = indexerList[ ti].get();
+				strus::Reference<strus::thread> th( new strus::thread( &strus::IndexProcessor::run, tc));
+				indexerThreadGroup.push_back( th);
+			}
+		}
 		if (nofThreads == 0)
 		{
-			strus::InsertProcessor inserter(
-				storage.get(), textproc, &analyzerMap, documentClass, commitQue.get(),
-				fileCrawler.get(), transactionSize, verbose, errorBuffer.get());
-			inserter.run();
-			if (inserter.hasError()) rt = -3;
+			processorList[ 0]->run();
 		}
 		else
 		{
-			std::vector<strus::Reference<strus::InsertProcessor> > processorList;
-			processorList.reserve( nofThreads);
-			for (int ti = 0; ti<nofThreads; ++ti)
+			std::vector<strus::Reference<strus::thread> > threadGroup;
+			for (int ti=0; ti<nofThreads; ++ti)
 			{
-				processorList.push_back(
-					new strus::InsertProcessor(
-						storage.get(), textproc, &analyzerMap, documentClass, commitQue.get(),
-						fileCrawler.get(), transactionSize, verbose, errorBuffer.get()));
+				strus::InsertProcessor* tc = processorList[ ti].get();
+				strus::Reference<strus::thread> th( new strus::thread( &strus::InsertProcessor::run, tc));
+				threadGroup.push_back( th);
 			}
+			std::vector<strus::Reference<strus::thread> >::iterator
+				gi = threadGroup.begin(), ge = threadGroup.end();
+			for (; gi != ge; ++gi) (*gi)->join();
+		}
+		for (int ti=0; ti<nofProcessors; ++ti)
+		{
+			if (processorList[ ti]->hasError()) rt = -3;
+		}
+		if (docQueue.get())
+		{
+			// All documents analyzed, wait for the indexer threads to process the batches still queued:
+			indexerThreadGuard.join();
+			for (int ti=0; ti<nofIndexThreads; ++ti)
 			{
-				std::vector<strus::Reference<strus::thread> > threadGroup;
-				for (int ti=0; ti<nofThreads; ++ti)
-				{
-					strus::InsertProcessor* tc = processorList[ ti].get();
-					strus::Reference<strus::thread> th( new strus::thread( &strus::InsertProcessor::run, tc));
-					threadGroup.push_back( th);
-				}
-				std::vector<strus::Reference<strus::thread> >::iterator
-					gi = threadGroup.begin(), ge = threadGroup.end();
-				for (; gi != ge; ++gi) (*gi)->join();
-				for (int ti=0; ti<nofThreads; ++ti)
-				{
-					if (processorList[ ti]->hasError()) rt = -3;
-				}
+				if (indexerList[ ti]->hasError()) rt = -3;
 			}
 		}
+		// Wait for the transactions still in the commit queue:
+		commitQue->close();
+		if (opt("transactionstats"))
+		{
+			sizeControl.printStatistics( std::cout);
+		}
+		if (profiler.get())
+		{
+			profiler->report();
+		}
+
+		if (verbose && dclassCache.get())
+		{
+			std::cerr << strus::string_format( _TXT("document class detected for %u files, taken from the cache for %u files"), dclassCache->nofDetections(), dclassCache->nofHits()) << std::endl;
+		}
 		// Close of the storage including compaction of the database:
 		storage->close();
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "transactionSizeControl.hpp"
+#include "private/internationalization.hpp"
+#include "strus/base/string_format.hpp"
+
+using namespace strus;
+
+#define MIN_TRANSACTION_BYTES (256*1024)
+#define THROUGHPUT_SMOOTHING 0.3
+
+TransactionSizeControl::TransactionSizeControl(
+		int maxNofDocuments_,
+		std::size_t memoryBudget_,
+		int nofConcurrentTransactions_,
+		unsigned int targetLatency_)
+	:m_maxNofDocuments(maxNofDocuments_)
+	,m_minBytes(0),m_maxBytes(0),m_byteLimit(0),m_initialByteLimit(0)
+	,m_nofCommits(0),m_nofChanges(0)
+	,m_throughput(0.0)
+	,m_targetLatency(targetLatency_ / 1000.0)
+{
+	if (memoryBudget_)
+	{
+		m_maxBytes = memoryBudget_ / (nofConcurrentTransactions_ > 0 ? nofConcurrentTransactions_ : 1);
+		if (m_maxBytes == 0) m_maxBytes = 1;
+		m_minBytes = m_maxBytes < (std::size_t)MIN_TRANSACTION_BYTES ? m_maxBytes : (std::size_t)MIN_TRANSACTION_BYTES;
+		// Start with small transactions until the commit throughput is known:
+		m_byteLimit = m_maxBytes / 8;
+		if (m_byteLimit < m_minBytes) m_byteLimit = m_minBytes;
+		m_initialByteLimit = m_byteLimit;
+	}
+}
+
+std::size_t TransactionSizeControl::byteLimit()
+{
+	if (!m_maxBytes) return 0;
+	strus::scoped_lock lock( m_mutex);
+	return m_byteLimit;
+}
+
+void TransactionSizeControl::reportCommit( std::size_t bufferedBytes, uint64_t duration)
+{
+	if (!m_maxBytes || !bufferedBytes) return;
+	double seconds = duration / 1e9;
+	if (seconds <= 0.0) seconds = 1e-6;
+	double throughput = bufferedBytes / seconds;
+
+	strus::scoped_lock lock( m_mutex);
+	m_throughput = (m_throughput == 0.0)
+			? throughput
+			: THROUGHPUT_SMOOTHING * throughput + (1.0 - THROUGHPUT_SMOOTHING) * m_throughput;
+	double target = m_throughput * m_targetLatency;
+	// Change the limit by at most a factor 2 per commit to damp oscillation:
+	double upper = 2.0 * m_byteLimit;
+	double lower = 0.5 * m_byteLimit;
+	if (target > upper) target = upper;
+	if (target < lower) target = lower;
+	if (target > (double)m_maxBytes) target = (double)m_maxBytes;
+	if (target < (double)m_minBytes) target = (double)m_minBytes;
+	++m_nofCommits;
+	if ((std::size_t)target != m_byteLimit)
+	{
+		++m_nofChanges;
+		m_byteLimit = (std::size_t)target;
+	}
+}
+
+void TransactionSizeControl::printStatistics( std::ostream& out) const
+{
+	strus::scoped_lock lock( m_mutex);
+	out << strus::string_format( _TXT("transaction size: %u commits, byte limit %u initial, %u final, changed %u times"),
+					m_nofCommits, (unsigned int)m_initialByteLimit, (unsigned int)m_byteLimit, m_nofChanges) << std::endl;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSERTER_TRANSACTION_SIZE_CONTROL_HPP_INCLUDED
+#define _STRUS_INSERTER_TRANSACTION_SIZE_CONTROL_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "strus/base/stdint.h"
+#include <ostream>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Decides when a transaction of strusInsert is full and has to be passed to the commit queue
+/// \note Without memory budget a transaction is full when it contains a fixed number of documents.
+///	With memory budget (adaptive mode) a transaction is full when the estimated size of its contents exceeds a byte limit.
+///	The byte limit follows the throughput of the commits observed, so that a commit takes about the target latency,
+///	but it never exceeds the memory budget divided by the number of transactions that can be held in memory at the same time.
+class TransactionSizeControl
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofDocuments_ maximum number of documents per transaction, 0 for no limit
+	/// \param[in] memoryBudget_ memory budget in bytes for all transactions held in memory, 0 for a fixed number of documents per transaction
+	/// \param[in] nofConcurrentTransactions_ number of transactions held in memory at the same time (open in indexers or waiting for commit)
+	/// \param[in] targetLatency_ target duration of a commit in milliseconds (adaptive mode only)
+	TransactionSizeControl(
+			int maxNofDocuments_,
+			std::size_t memoryBudget_,
+			int nofConcurrentTransactions_,
+			unsigned int targetLatency_);
+
+	/// \brief Evaluate if the transaction sizing is adaptive
+	bool adaptive() const
+	{
+		return m_maxBytes != 0;
+	}
+
+	/// \brief Get the current limit of the estimated size of a transaction in bytes, 0 for no limit
+	/// \note Called by the indexers when they start a new transaction
+	std::size_t byteLimit();
+
+	/// \brief Evaluate if a transaction is full
+	/// \param[in] nofDocuments number of documents in the transaction
+	/// \param[in] bufferedBytes estimated size of the transaction contents in bytes
+	/// \param[in] byteLimit byte limit returned by byteLimit() when the transaction was started
+	bool full( int nofDocuments, std::size_t bufferedBytes, std::size_t byteLimit) const
+	{
+		return (m_maxNofDocuments && nofDocuments >= m_maxNofDocuments)
+			|| (byteLimit && bufferedBytes >= byteLimit);
+	}
+
+	/// \brief Report a successful commit to adapt the byte limit to
+	/// \param[in] bufferedBytes estimated size of the transaction contents committed in bytes
+	/// \param[in] duration duration of the commit in nanoseconds
+	void reportCommit( std::size_t bufferedBytes, uint64_t duration);
+
+	/// \brief Print the number of commits reported and the changes of the byte limit in one line
+	void printStatistics( std::ostream& out) const;
+
+private:
+	mutable strus::mutex m_mutex;
+	int m_maxNofDocuments;
+	std::size_t m_minBytes;		///< lower bound of the byte limit
+	std::size_t m_maxBytes;		///< upper bound of the byte limit derived from the memory budget
+	std::size_t m_byteLimit;	///< current byte limit
+	std::size_t m_initialByteLimit;	///< byte limit before the first commit reported
+	unsigned int m_nofCommits;	///< number of commits reported
+	unsigned int m_nofChanges;	///< number of commits reported that changed the byte limit
+	double m_throughput;		///< moving average of the commit throughput in bytes per second, 0 if not yet measured
+	double m_targetLatency;		///< target duration of a commit in seconds
+};
+
+}//namespace
+#endif
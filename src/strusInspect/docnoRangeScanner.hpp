@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSPECT_DOCNO_RANGE_SCANNER_HPP_INCLUDED
+#define _STRUS_INSPECT_DOCNO_RANGE_SCANNER_HPP_INCLUDED
+#include "strus/storage/index.hpp"
+#include <ostream>
+
+namespace strus {
+
+/// \brief Interface for inspecting the documents in a range of document numbers
+/// \note A scanner owns its own iterators, one scanner is used by only one thread
+class DocnoRangeScannerInterface
+{
+public:
+	virtual ~DocnoRangeScannerInterface(){}
+
+	/// \brief Inspect the documents with a document number in a range
+	/// \param[out] out where to print the output to
+	/// \param[in] from first document number of the range
+	/// \param[in] to last document number of the range (inclusive)
+	/// \note Called with ascending ranges that do not overlap
+	virtual void scan( std::ostream& out, const Index& from, const Index& to)=0;
+};
+
+}//namespace
+#endif
+
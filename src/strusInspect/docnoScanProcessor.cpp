@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "docnoScanProcessor.hpp"
+#include "private/orderedResultBuffer.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/thread.hpp"
+#include "private/internationalization.hpp"
+#include <sstream>
+#include <stdexcept>
+
+using namespace strus;
+
+void DocnoScanProcessor::run()
+{
+	std::size_t segidx;
+	while (m_buffer->fetch( segidx))
+	{
+		Index from = (Index)segidx * m_segmentSize + 1;
+		Index to = (m_maxDocno - from < m_segmentSize) ? m_maxDocno : from + m_segmentSize - 1;
+		std::ostringstream out;
+		std::string error;
+		try
+		{
+			m_scanner->scan( out, from, to);
+		}
+		catch (const std::bad_alloc&)
+		{
+			error = _TXT("out of memory");
+		}
+		catch (const std::exception& err)
+		{
+			error = err.what();
+		}
+		catch (...)
+		{
+			error = _TXT("unknown exception");
+		}
+		if (m_errorhnd->hasError())
+		{
+			const char* errmsg = m_errorhnd->fetchError();
+			if (error.empty()) error = errmsg;
+		}
+		// An output is pushed for every segment fetched, otherwise the thread popping the outputs would wait forever:
+		m_buffer->push( segidx, out.str(), error);
+	}
+	m_errorhnd->releaseContext();
+}
+
+void strus::scanDocnoRangeParallel( std::ostream& out, const std::vector<DocnoRangeScannerInterface*>& scanners, const Index& maxDocno, const Index& segmentSize, ErrorBufferInterface* errorhnd)
+{
+	Index segmentSize_ = segmentSize > 0 ? segmentSize : 1;
+	Index maxDocno_ = maxDocno > 0 ? maxDocno : 0;
+	std::size_t nofSegments = (maxDocno_ + segmentSize_ - 1) / segmentSize_;
+	// Enough segments ahead to keep all threads busy while one segment with many documents is inspected:
+	strus::utils::OrderedResultBuffer buffer( nofSegments, scanners.size() * 4);
+	std::vector<DocnoScanProcessor> processors;
+	std::vector<DocnoRangeScannerInterface*>::const_iterator si = scanners.begin(), se = scanners.end();
+	for (; si != se; ++si)
+	{
+		processors.push_back( DocnoScanProcessor( *si, &buffer, maxDocno_, segmentSize_, errorhnd));
+	}
+	std::vector<strus::Reference<strus::thread> > threadGroup;
+	std::vector<DocnoScanProcessor>::iterator pi = processors.begin(), pe = processors.end();
+	for (; pi != pe; ++pi)
+	{
+		threadGroup.push_back( strus::Reference<strus::thread>( new strus::thread( &DocnoScanProcessor::run, &*pi)));
+	}
+	std::string output;
+	std::string error;
+	while (buffer.pop( output, error))
+	{
+		if (!error.empty())
+		{
+			buffer.terminate();
+			break;
+		}
+		out << output;
+	}
+	std::vector<strus::Reference<strus::thread> >::iterator ti = threadGroup.begin(), te = threadGroup.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+	}
+	if (!error.empty())
+	{
+		throw std::runtime_error( error);
+	}
+}
+
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_INSPECT_DOCNO_SCAN_PROCESSOR_HPP_INCLUDED
+#define _STRUS_INSPECT_DOCNO_SCAN_PROCESSOR_HPP_INCLUDED
+#include "docnoRangeScanner.hpp"
+#include "strus/storage/index.hpp"
+#include <vector>
+#include <ostream>
+
+namespace strus {
+
+/// \brief Forward declaration
+class ErrorBufferInterface;
+namespace utils {
+/// \brief Forward declaration
+class OrderedResultBuffer;
+}
+
+/// \brief Thread of strusInspect inspecting the segments of the document number range fetched from a buffer returning the output in document number order
+class DocnoScanProcessor
+{
+public:
+	/// \brief Constructor
+	/// \param[in] scanner_ scanner used by this thread
+	/// \param[in] buffer_ buffer handing out the indices of the segments and collecting their output
+	/// \param[in] maxDocno_ maximum document number to inspect
+	/// \param[in] segmentSize_ number of document numbers per segment
+	/// \param[in] errorhnd_ error buffer interface
+	DocnoScanProcessor(
+			DocnoRangeScannerInterface* scanner_,
+			utils::OrderedResultBuffer* buffer_,
+			const Index& maxDocno_,
+			const Index& segmentSize_,
+			ErrorBufferInterface* errorhnd_)
+		:m_scanner(scanner_),m_buffer(buffer_),m_maxDocno(maxDocno_),m_segmentSize(segmentSize_),m_errorhnd(errorhnd_){}
+
+	/// \brief Thread main function
+	void run();
+
+private:
+	DocnoRangeScannerInterface* m_scanner;
+	utils::OrderedResultBuffer* m_buffer;
+	Index m_maxDocno;
+	Index m_segmentSize;
+	ErrorBufferInterface* m_errorhnd;
+};
+
+/// \brief Inspect all documents from 1 to maxDocno with one thread per scanner and print the output in document number order
+/// \param[out] out where to print the output to
+/// \param[in] scanners one scanner per thread
+/// \param[in] maxDocno maximum document number to inspect
+/// \param[in] segmentSize number of document numbers inspected by a thread in one piece
+/// \param[in] errorhnd error buffer interface
+/// \note Throws on error
+void scanDocnoRangeParallel( std::ostream& out, const std::vector<DocnoRangeScannerInterface*>& scanners, const Index& maxDocno, const Index& segmentSize, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
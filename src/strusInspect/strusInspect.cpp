@@ -49,6 +49,8 @@
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
+#include "docnoRangeScanner.hpp"
+#include "docnoScanProcessor.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -58,6 +60,7 @@
 #include <limits>
 
 static int g_output_precision = 8;
+static strus::Index g_segment_size = 16384;
 
 static void printStorageConfigOptions( std::ostream& out, const strus::ModuleLoaderInterface* moduleLoader, const std::string& config, strus::ErrorBufferInterface* errorhnd)
 {
@@ -103,66 +106,172 @@ static bool isIndex( char const* cc)
 	return (*cc == '\0');
 }
 
-static void printDocumentDocidLine( const strus::Index& docno, strus::AttributeReaderInterface* areader, const strus::Index& ahandle)
+static void printDocumentDocidLine( std::ostream& out, const strus::Index& docno, strus::AttributeReaderInterface* areader, const strus::Index& ahandle)
 {
 	if (ahandle > 0)
 	{
 		areader->skipDoc( docno);
-		std::cout << areader->getValue( ahandle) << ':' << std::endl;
+		out << areader->getValue( ahandle) << ':' << std::endl;
 	}
 	else
 	{
-		std::cout << docno << ':' << std::endl;
+		out << docno << ':' << std::endl;
 	}
 }
 
-static void inspectPositions( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute, bool printEmpty)
+/// \brief Run scanners on all documents of the storage, in parallel if there is more than one scanner
+template <class Scanner>
+static void scanAllDocuments( strus::StorageClientInterface& storage, const std::vector<strus::Reference<Scanner> >& scanners, strus::ErrorBufferInterface* errorhnd)
 {
-	if (size > 3) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
-	if (size < 2) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
+	strus::Index maxDocno = storage.maxDocumentNumber();
+	if (scanners.size() == 1)
+	{
+		scanners[0]->scan( std::cout, 1, maxDocno);
+	}
+	else
+	{
+		std::vector<strus::DocnoRangeScannerInterface*> scannerptrs;
+		typename std::vector<strus::Reference<Scanner> >::const_iterator si = scanners.begin(), se = scanners.end();
+		for (; si != se; ++si)
+		{
+			scannerptrs.push_back( si->get());
+		}
+		strus::scanDocnoRangeParallel( std::cout, scannerptrs, maxDocno, g_segment_size, errorhnd);
+	}
+}
 
-	strus::Reference<strus::AttributeReaderInterface> areader;
-	strus::Index ahandle = -1;
-	if (!attribute.empty())
+/// \brief Writer of the lines of documents without matches, printed with option --empty
+/// \remark Prints a run of consecutive documents as one line with the document number range <first>-<last> if compact and the documents are not identified by an attribute
+class EmptyDocumentWriter
+{
+public:
+	EmptyDocumentWriter()
+		:m_areader(0),m_ahandle(-1),m_suffix(""),m_compact(false){}
+	EmptyDocumentWriter( strus::AttributeReaderInterface* areader_, const strus::Index& ahandle_, const char* suffix_, bool compact_)
+		:m_areader(areader_),m_ahandle(ahandle_),m_suffix(suffix_),m_compact(compact_ && ahandle_ <= 0){}
+
+	/// \brief Get true, if runs of documents are printed as one line
+	bool compact() const
 	{
-		areader.reset( storage.createAttributeReader());
-		ahandle = areader->elementHandle( attribute);
+		return m_compact;
 	}
 
-	strus::PostingIteratorReference itr(
-		storage.createTermPostingIterator(
-			std::string(key[0]), std::string(key[1]), 1, strus::TermStatistics()));
-	if (!itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
+	/// \brief Print the documents from first to last (inclusive)
+	void print( std::ostream& out, const strus::Index& first, const strus::Index& last) const
+	{
+		if (m_compact && first < last)
+		{
+			out << first << '-' << last << m_suffix << std::endl;
+			return;
+		}
+		strus::Index docno = first;
+		for (; docno <= last; ++docno)
+		{
+			if (m_ahandle > 0)
+			{
+				m_areader->skipDoc( docno);
+				out << m_areader->getValue( m_ahandle) << m_suffix << std::endl;
+			}
+			else
+			{
+				out << docno << m_suffix << std::endl;
+			}
+		}
+	}
 
-	if (size == 2)
+private:
+	strus::AttributeReaderInterface* m_areader;
+	strus::Index m_ahandle;
+	const char* m_suffix;
+	bool m_compact;
+};
+
+/// \brief Evaluate if a document is part of a run of documents without matches started before it
+/// \note Such a run is printed as a whole by the scanner of the range where it starts, if runs are printed compact
+static bool continuesEmptyRun( strus::PostingIteratorInterface& itr, const strus::Index& docno)
+{
+	return docno > 1 && itr.skipDoc( docno-1) != docno-1;
+}
+
+/// \brief Scanner printing the positions of a term in the documents of a range
+/// \remark Visits only the documents containing the term
+class PositionsScanner
+	:public strus::DocnoRangeScannerInterface
+{
+public:
+	PositionsScanner( strus::StorageClientInterface& storage, const std::string& type, const std::string& value, const std::string& attribute, bool printEmpty_, bool printCompact_)
+		:m_itr(),m_areader(),m_ahandle(-1),m_printEmpty(printEmpty_),m_emptyWriter()
 	{
-		strus::Index maxDocno = storage.maxDocumentNumber();
-		strus::Index docno = 1;
-		for (; docno <= maxDocno; ++docno)
+		if (!attribute.empty())
 		{
-			strus::Index next_docno = itr->skipDoc( docno);
-			if (!next_docno) break;
+			m_areader.reset( storage.createAttributeReader());
+			if (!m_areader.get()) throw std::runtime_error( _TXT("failed to create attribute reader"));
+			m_ahandle = m_areader->elementHandle( attribute);
+		}
+		m_itr.reset( storage.createTermPostingIterator( type, value, 1, strus::TermStatistics()));
+		if (!m_itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
+		m_emptyWriter = EmptyDocumentWriter( m_areader.get(), m_ahandle, ":", printCompact_);
+	}
 
-			if (printEmpty && next_docno > docno)
+	virtual void scan( std::ostream& out, const strus::Index& from, const strus::Index& to)
+	{
+		bool continued = m_printEmpty && m_emptyWriter.compact() && continuesEmptyRun( *m_itr, from);
+		strus::Index next_docno = m_itr->skipDoc( from);
+		strus::Index docno = continued ? next_docno : from;
+
+		for (; next_docno && next_docno <= to; next_docno = m_itr->skipDoc( docno))
+		{
+			if (m_printEmpty && next_docno > docno)
 			{
-				for (; docno < next_docno; ++docno)
-				{
-					printDocumentDocidLine( docno, areader.get(), ahandle);
-				}
+				m_emptyWriter.print( out, docno, next_docno-1);
 			}
-			docno = next_docno;
-			printDocumentDocidLine( docno, areader.get(), ahandle);
+			printDocumentDocidLine( out, next_docno, m_areader.get(), m_ahandle);
 
 			strus::Index pos=0;
-			while (0!=(pos=itr->skipPos(pos+1)))
+			while (0!=(pos=m_itr->skipPos(pos+1)))
 			{
-				std::cout << ' ' << pos;
+				out << ' ' << pos;
 			}
-			std::cout << std::endl;
+			out << std::endl;
+			docno = next_docno+1;
+		}
+		if (m_printEmpty && next_docno && docno <= to)
+		{
+			// Documents without the term are only printed if a document with the term follows, maybe in a later range:
+			m_emptyWriter.print( out, docno, m_emptyWriter.compact() ? next_docno-1 : to);
 		}
 	}
+
+private:
+	strus::PostingIteratorReference m_itr;
+	strus::Reference<strus::AttributeReaderInterface> m_areader;
+	strus::Index m_ahandle;
+	bool m_printEmpty;
+	EmptyDocumentWriter m_emptyWriter;
+};
+
+static void inspectPositions( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute, bool printEmpty, bool printCompact, int nofThreads, strus::ErrorBufferInterface* errorhnd)
+{
+	if (size > 3) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
+	if (size < 2) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
+
+	if (size == 2)
+	{
+		std::vector<strus::Reference<PositionsScanner> > scanners;
+		int si = 0, se = nofThreads > 0 ? nofThreads : 1;
+		for (; si != se; ++si)
+		{
+			scanners.push_back( new PositionsScanner( storage, key[0], key[1], attribute, printEmpty, printCompact));
+		}
+		scanAllDocuments( storage, scanners, errorhnd);
+	}
 	else
 	{
+		strus::PostingIteratorReference itr(
+			storage.createTermPostingIterator(
+				std::string(key[0]), std::string(key[1]), 1, strus::TermStatistics()));
+		if (!itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
+
 		strus::Index docno = isIndex(key[2])
 				?stringToIndex( key[2])
 				:storage.documentNumber( key[2]);
@@ -232,11 +341,11 @@ static void inspectDocumentIndexTerms( strus::StorageClientInterface& storage, c
 			{
 				for (; docno < next_docno; ++docno)
 				{
-					printDocumentDocidLine( docno, areader.get(), ahandle);
+					printDocumentDocidLine( std::cout, docno, areader.get(), ahandle);
 				}
 			}
 			docno = next_docno;
-			printDocumentDocidLine( docno, areader.get(), ahandle);
+			printDocumentDocidLine( std::cout, docno, areader.get(), ahandle);
 
 			strus::DocumentTermIteratorInterface::Term term;
 			while (itr->nextTerm( term))
@@ -306,11 +415,11 @@ static void inspectDocumentIndexStructures( strus::StorageClientInterface& stora
 			{
 				if (printEmpty)
 				{
-					printDocumentDocidLine( docno, areader.get(), ahandle);
+					printDocumentDocidLine( std::cout, docno, areader.get(), ahandle);
 				}
 				continue;
 			}
-			printDocumentDocidLine( docno, areader.get(), ahandle);
+			printDocumentDocidLine( std::cout, docno, areader.get(), ahandle);
 
 			strus::StorageStructMap::const_iterator si = structMap.begin( structno), se = structMap.end( structno);
 			for (; si != se; ++si)
@@ -451,69 +560,93 @@ static void inspectDocumentTermTypeStats( strus::StorageClientInterface& storage
 	}
 }
 
-static void inspectFeatureFrequency( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute, bool printEmpty)
+/// \brief Scanner printing the frequency of a term in the documents of a range
+/// \remark Visits only the documents containing the term
+class FeatureFrequencyScanner
+	:public strus::DocnoRangeScannerInterface
 {
-	if (size > 3) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
-	if (size < 2) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
-
-	strus::Reference<strus::AttributeReaderInterface> areader;
-	strus::Index ahandle = -1;
-	if (!attribute.empty())
+public:
+	FeatureFrequencyScanner( strus::StorageClientInterface& storage, const std::string& type, const std::string& value, const std::string& attribute, bool printEmpty_, bool printCompact_)
+		:m_itr(),m_areader(),m_ahandle(-1),m_printEmpty(printEmpty_),m_emptyWriter(),m_maxDocno(storage.maxDocumentNumber())
 	{
-		areader.reset( storage.createAttributeReader());
-		ahandle = areader->elementHandle( attribute);
+		if (!attribute.empty())
+		{
+			m_areader.reset( storage.createAttributeReader());
+			if (!m_areader.get()) throw std::runtime_error( _TXT("failed to create attribute reader"));
+			m_ahandle = m_areader->elementHandle( attribute);
+		}
+		m_itr.reset( storage.createTermPostingIterator( type, value, 1, strus::TermStatistics()));
+		if (!m_itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
+		// Documents without the term are not printed if identified by an attribute:
+		m_printEmpty &= (m_ahandle <= 0);
+		m_emptyWriter = EmptyDocumentWriter( 0, -1, " 0", printCompact_);
 	}
 
-	strus::PostingIteratorReference itr(
-		storage.createTermPostingIterator(
-			std::string(key[0]), std::string(key[1]), 1, strus::TermStatistics()));
-	if (!itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
-
-	if (size == 2)
+	virtual void scan( std::ostream& out, const strus::Index& from, const strus::Index& to)
 	{
-		strus::Index maxDocno = storage.maxDocumentNumber();
-		strus::Index docno = 1;
-		for (; docno <= maxDocno; ++docno)
+		bool continued = m_printEmpty && m_emptyWriter.compact() && continuesEmptyRun( *m_itr, from);
+		strus::Index next_docno = m_itr->skipDoc( from);
+		strus::Index docno = continued ? (next_docno ? next_docno : to+1) : from;
+
+		for (; next_docno && next_docno <= to; next_docno = m_itr->skipDoc( docno))
 		{
-			strus::Index next_docno = itr->skipDoc( docno);
-			if (docno != next_docno)
+			if (m_printEmpty && next_docno > docno)
 			{
-				if (printEmpty && ahandle <= 0)
-				{
-					if (!next_docno)
-					{
-						for (; docno <= maxDocno; ++docno)
-						{
-							std::cout << docno << " 0" << std::endl;
-						}
-						break;
-					}
-					else
-					{
-						for (; docno < next_docno; ++docno)
-						{
-							std::cout << docno << " 0" << std::endl;
-						}
-					}
-				}
-				else
-				{
-					docno = next_docno;
-				}
+				m_emptyWriter.print( out, docno, next_docno-1);
 			}
-			if (ahandle > 0)
+			if (m_ahandle > 0)
 			{
-				areader->skipDoc(docno);
-				std::cout << areader->getValue( ahandle) << ' ' << (*itr).frequency() << std::endl;
+				m_areader->skipDoc( next_docno);
+				out << m_areader->getValue( m_ahandle) << ' ' << m_itr->frequency() << std::endl;
 			}
 			else
 			{
-				std::cout << docno << ' ' << (*itr).frequency() << std::endl;
+				out << next_docno << ' ' << m_itr->frequency() << std::endl;
 			}
+			docno = next_docno+1;
+		}
+		if (m_printEmpty && docno <= to)
+		{
+			strus::Index last = to;
+			if (m_emptyWriter.compact())
+			{
+				last = next_docno ? next_docno-1 : m_maxDocno;
+			}
+			m_emptyWriter.print( out, docno, last);
+		}
+	}
+
+private:
+	strus::PostingIteratorReference m_itr;
+	strus::Reference<strus::AttributeReaderInterface> m_areader;
+	strus::Index m_ahandle;
+	bool m_printEmpty;
+	EmptyDocumentWriter m_emptyWriter;
+	strus::Index m_maxDocno;
+};
+
+static void inspectFeatureFrequency( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute, bool printEmpty, bool printCompact, int nofThreads, strus::ErrorBufferInterface* errorhnd)
+{
+	if (size > 3) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
+	if (size < 2) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
+
+	if (size == 2)
+	{
+		std::vector<strus::Reference<FeatureFrequencyScanner> > scanners;
+		int si = 0, se = nofThreads > 0 ? nofThreads : 1;
+		for (; si != se; ++si)
+		{
+			scanners.push_back( new FeatureFrequencyScanner( storage, key[0], key[1], attribute, printEmpty, printCompact));
 		}
+		scanAllDocuments( storage, scanners, errorhnd);
 	}
 	else
 	{
+		strus::PostingIteratorReference itr(
+			storage.createTermPostingIterator(
+				std::string(key[0]), std::string(key[1]), 1, strus::TermStatistics()));
+		if (!itr.get()) throw std::runtime_error( _TXT("failed to create term posting iterator"));
+
 		strus::Index docno = isIndex( key[2])
 				?stringToIndex( key[2])
 				:storage.documentNumber( key[2]);
@@ -769,7 +902,6 @@ static void inspectContent( strus::StorageClientInterface& storage, const char**
 }
 
 static void fillForwardIndexStats(
-		strus::StorageClientInterface& storage,
 		strus::ForwardIteratorReference& viewer,
 		std::map<std::string,unsigned int>& statmap,
 		const strus::Index& docno)
@@ -831,68 +963,139 @@ static std::string mapCntrlToSpace( const std::string& tok)
 	return val;
 }
 
-static void inspectForwardIndexStats( strus::StorageClientInterface& storage, const char** key, int size)
+/// \brief Scanner counting the occurrencies of the forward index tokens of a type in the documents of a range
+/// \note Prints nothing, the counts of all scanners are merged when all ranges have been scanned
+class ForwardIndexStatsScanner
+	:public strus::DocnoRangeScannerInterface
+{
+public:
+	typedef std::map<std::string,unsigned int> StatMap;
+
+	ForwardIndexStatsScanner( strus::StorageClientInterface& storage, const std::string& type)
+		:m_viewer( storage.createForwardIterator( type)),m_statmap()
+	{
+		if (!m_viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
+	}
+
+	virtual void scan( std::ostream&, const strus::Index& from, const strus::Index& to)
+	{
+		strus::Index docno = from;
+		for (; docno <= to; ++docno)
+		{
+			fillForwardIndexStats( m_viewer, m_statmap, docno);
+		}
+	}
+
+	const StatMap& statmap() const
+	{
+		return m_statmap;
+	}
+
+private:
+	strus::ForwardIteratorReference m_viewer;
+	StatMap m_statmap;
+};
+
+/// \brief Scanner printing the forward index tokens of a type with their position in the documents of a range
+class ForwardIndexMapScanner
+	:public strus::DocnoRangeScannerInterface
+{
+public:
+	ForwardIndexMapScanner( strus::StorageClientInterface& storage, const std::string& type)
+		:m_viewer( storage.createForwardIterator( type))
+	{
+		if (!m_viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
+	}
+
+	virtual void scan( std::ostream& out, const strus::Index& from, const strus::Index& to)
+	{
+		strus::Index docno = from;
+		for (; docno <= to; ++docno)
+		{
+			m_viewer->skipDoc( docno);
+			strus::Index pos=0;
+			while (0!=(pos=m_viewer->skipPos(pos+1)))
+			{
+				std::string value = m_viewer->fetch();
+				out << docno << ":" << pos << " " << mapCntrlToSpace(value) << std::endl;
+			}
+		}
+	}
+
+private:
+	strus::ForwardIteratorReference m_viewer;
+};
+
+static void inspectForwardIndexStats( strus::StorageClientInterface& storage, const char** key, int size, int nofThreads, strus::ErrorBufferInterface* errorhnd)
 {
 	if (size > 2) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
 	if (size < 1) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
 
-	strus::ForwardIteratorReference viewer( storage.createForwardIterator( std::string(key[0])));
-	if (!viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
-	std::map<std::string,unsigned int> statmap;
+	ForwardIndexStatsScanner::StatMap statmap;
 	if (size == 1)
 	{
-		strus::Index maxDocno = storage.maxDocumentNumber();
-		strus::Index docno = 1;
-		for (; docno <= maxDocno; ++docno)
+		std::vector<strus::Reference<ForwardIndexStatsScanner> > scanners;
+		int si = 0, se = nofThreads > 0 ? nofThreads : 1;
+		for (; si != se; ++si)
 		{
-			fillForwardIndexStats( storage, viewer, statmap, docno);
+			scanners.push_back( new ForwardIndexStatsScanner( storage, key[0]));
+		}
+		scanAllDocuments( storage, scanners, errorhnd);
+
+		std::vector<strus::Reference<ForwardIndexStatsScanner> >::const_iterator ci = scanners.begin(), ce = scanners.end();
+		for (; ci != ce; ++ci)
+		{
+			ForwardIndexStatsScanner::StatMap::const_iterator mi = (*ci)->statmap().begin(), me = (*ci)->statmap().end();
+			for (; mi != me; ++mi)
+			{
+				statmap[ mi->first] += mi->second;
+			}
 		}
 	}
 	else
 	{
+		strus::ForwardIteratorReference viewer( storage.createForwardIterator( std::string(key[0])));
+		if (!viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
+
 		strus::Index docno = isIndex(key[1])
 				?stringToIndex( key[1])
 				:storage.documentNumber( key[1]);
 		if (docno)
 		{
-			fillForwardIndexStats( storage, viewer, statmap, docno);
+			fillForwardIndexStats( viewer, statmap, docno);
 		}
 		else
 		{
 			throw strus::runtime_error( "%s",  _TXT("unknown document"));
 		}
 	}
-	std::map<std::string,unsigned int>::const_iterator si = statmap.begin(), se = statmap.end();
+	ForwardIndexStatsScanner::StatMap::const_iterator si = statmap.begin(), se = statmap.end();
 	for (; si != se; ++si)
 	{
 		std::cout << "'" << mapForwardIndexToken( si->first) << "' " << si->second << std::endl;
 	}
 }
 
-static void inspectForwardIndexMap( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute)
+static void inspectForwardIndexMap( strus::StorageClientInterface& storage, const char** key, int size, const std::string& attribute, int nofThreads, strus::ErrorBufferInterface* errorhnd)
 {
 	if (size > 2) throw strus::runtime_error( "%s",  _TXT("too many arguments"));
 	if (size < 1) throw strus::runtime_error( "%s",  _TXT("too few arguments"));
 
-	strus::ForwardIteratorReference viewer( storage.createForwardIterator( std::string(key[0])));
-	if (!viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
 	if (size == 1)
 	{
-		strus::Index maxDocno = storage.maxDocumentNumber();
-		strus::Index docno = 1;
-		for (; docno <= maxDocno; ++docno)
+		std::vector<strus::Reference<ForwardIndexMapScanner> > scanners;
+		int si = 0, se = nofThreads > 0 ? nofThreads : 1;
+		for (; si != se; ++si)
 		{
-			viewer->skipDoc( docno);
-			strus::Index pos=0;
-			while (0!=(pos=viewer->skipPos(pos+1)))
-			{
-				std::string value = viewer->fetch();
-				std::cout << docno << ":" << pos << " " << mapCntrlToSpace(value) << std::endl;
-			}
+			scanners.push_back( new ForwardIndexMapScanner( storage, key[0]));
 		}
+		scanAllDocuments( storage, scanners, errorhnd);
 	}
 	else
 	{
+		strus::ForwardIteratorReference viewer( storage.createForwardIterator( std::string(key[0])));
+		if (!viewer.get()) throw std::runtime_error( _TXT("failed to create forward index iterator"));
+
 		strus::Index docno = isIndex(key[1])
 				?stringToIndex( key[1])
 				:storage.documentNumber( key[1]);
@@ -1013,11 +1216,11 @@ int main( int argc, const char* argv[])
 	{
 		bool printUsageAndExit = false;
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc, argv, 11,
+				errorBuffer.get(), argc, argv, 14,
 				"h,help", "v,version","license",
 				"G,debug:", "m,module:", "M,moduledir:",
 				"r,rpc:", "s,storage:", "T,trace:",
-				"A,attribute:", "E,empty");
+				"A,attribute:", "E,empty", "C,compact", "t,threads:", "segmentsize:");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
@@ -1026,6 +1229,16 @@ int main( int argc, const char* argv[])
 		{
 			printUsageAndExit = true;
 		}
+		int nofThreads = 0;
+		if (opt("threads"))
+		{
+			nofThreads = opt.asUint( "threads");
+			if (!errorBuffer->setMaxNofThreads( nofThreads+2))
+			{
+				std::cerr << _TXT("failed to set number of threads for error buffer (option --threads)") << std::endl;
+				return -1;
+			}
+		}
 
 		// Enable debugging selected with option 'debug':
 		{
@@ -1198,6 +1411,14 @@ int main( int argc, const char* argv[])
 			std::cout << "    " << _TXT("Print attribute with name <NAME> for lists of results instead of docno") << std::endl;
 			std::cout << "-E|--empty" << std::endl;
 			std::cout << "    " << _TXT("Print non existing elements as empty value") << std::endl;
+			std::cout << "-C|--compact" << std::endl;
+			std::cout << "    " << _TXT("Print runs of documents without elements as one line with the") << std::endl;
+			std::cout << "    " << _TXT("document number range <FIRST>-<LAST> (commands pos and ff with -E)") << std::endl;
+			std::cout << "-t|--threads <N>" << std::endl;
+			std::cout << "    " << _TXT("Inspect the documents with <N> threads for the commands") << std::endl;
+			std::cout << "    " << _TXT("pos, ff, fwstats and fwmap over all documents. Default is 0 (no threads)") << std::endl;
+			std::cout << "--segmentsize <N>" << std::endl;
+			std::cout << "    " << _TXT("Let the threads inspect ranges of <N> document numbers (default 16384)") << std::endl;
 			return rt;
 		}
 		// Parse arguments:
@@ -1212,7 +1433,18 @@ int main( int argc, const char* argv[])
 		{
 			attribute = opt["attribute"];
 		}
+		if (opt("segmentsize"))
+		{
+			if (!opt("threads")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--segmentsize", "--threads");
+			g_segment_size = opt.asUint( "segmentsize");
+			if (g_segment_size <= 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--segmentsize");
+		}
 		bool printEmpty = opt("empty");
+		bool printCompact = opt("compact");
+		if (printCompact && !printEmpty)
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--compact", "--empty");
+		}
 
 		// Declare trace proxy objects:
 		typedef strus::Reference<strus::TraceProxy> TraceReference;
@@ -1270,11 +1502,11 @@ int main( int argc, const char* argv[])
 
 		if (strus::caseInsensitiveEquals( what, "pos"))
 		{
-			inspectPositions( *storage, inpectarg, inpectargsize, attribute, printEmpty);
+			inspectPositions( *storage, inpectarg, inpectargsize, attribute, printEmpty, printCompact, nofThreads, errorBuffer.get());
 		}
 		else if (strus::caseInsensitiveEquals( what, "ff"))
 		{
-			inspectFeatureFrequency( *storage, inpectarg, inpectargsize, attribute, printEmpty);
+			inspectFeatureFrequency( *storage, inpectarg, inpectargsize, attribute, printEmpty, printCompact, nofThreads, errorBuffer.get());
 		}
 		else if (strus::caseInsensitiveEquals( what, "df"))
 		{
@@ -1330,11 +1562,11 @@ int main( int argc, const char* argv[])
 		}
 		else if (strus::caseInsensitiveEquals( what, "fwstats"))
 		{
-			inspectForwardIndexStats( *storage, inpectarg, inpectargsize);
+			inspectForwardIndexStats( *storage, inpectarg, inpectargsize, nofThreads, errorBuffer.get());
 		}
 		else if (strus::caseInsensitiveEquals( what, "fwmap"))
 		{
-			inspectForwardIndexMap( *storage, inpectarg, inpectargsize, attribute);
+			inspectForwardIndexMap( *storage, inpectarg, inpectargsize, attribute, nofThreads, errorBuffer.get());
 		}
 		else if (strus::caseInsensitiveEquals( what, "docno"))
 		{
@@ -45,6 +45,7 @@
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
+#include "private/documentClassCache.hpp"
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -190,6 +191,7 @@ static void writePosTaggerInput(
 		const std::string& outputFile,
 		strus::FileCrawlerInterface* crawler,
 		const strus::DocumentClassDetectorInterface* dclassdetector,
+		strus::DocumentClassCache* dclassCache,
 		const strus::analyzer::DocumentClass& dclass,
 		const strus::PosTaggerInstanceInterface* postaggerinst,
 		const strus::SegmenterInstanceInterface* entitySegmenter,
@@ -213,7 +215,8 @@ static void writePosTaggerInput(
 			strus::analyzer::DocumentClass documentclass;
 			if (!dclass.defined())
 			{
-				if (!dclassdetector->detect( documentclass, content.c_str(), content.size(), true/*is complete*/))
+				if (!strus::getCachedDocumentClass( dclassCache, documentclass, *ai)
+				&&  !strus::detectDocumentClass( dclassCache, documentclass, *ai, dclassdetector, content.c_str(), content.size(), true/*is complete*/))
 				{
 					const char* errormsg = g_errorBuffer->fetchError();
 					if (!errormsg) errormsg = "unsupported content type";
@@ -385,6 +388,7 @@ static void writePosTagging(
 		const std::string& outputpath,
 		const std::string& errorpath,
 		const strus::DocumentClassDetectorInterface* dclassdetector,
+		strus::DocumentClassCache* dclassCache,
 		const strus::analyzer::DocumentClass& dclass,
 		const strus::PosTaggerInstanceInterface* postaggerinst,
 		strus::FileCrawlerInterface* crawler)
@@ -406,7 +410,8 @@ static void writePosTagging(
 			strus::analyzer::DocumentClass documentclass;
 			if (!dclass.defined())
 			{
-				if (!dclassdetector->detect( documentclass, content.c_str(), content.size(), true/*is complete*/))
+				if (!strus::getCachedDocumentClass( dclassCache, documentclass, *ai)
+				&&  !strus::detectDocumentClass( dclassCache, documentclass, *ai, dclassdetector, content.c_str(), content.size(), true/*is complete*/))
 				{
 					const char* errormsg = g_errorBuffer->fetchError();
 					if (!errormsg) errormsg = "unsupported content type";
@@ -478,6 +483,7 @@ public:
 			int threadid_,
 			strus::FileCrawlerInterface* crawler_,
 			const strus::DocumentClassDetectorInterface* dclassdetector_,
+			strus::DocumentClassCache* dclassCache_,
 			const strus::analyzer::DocumentClass& dclass_,
 			const strus::PosTaggerInstanceInterface* postaggerinst_,
 			const strus::SegmenterInstanceInterface* entitySegmenter_,
@@ -486,7 +492,7 @@ public:
 			const std::string& inputPath_,
 			const std::string& outputFile_)
 		:m_threadid(threadid_),m_inputPath(inputPath_),m_outputFile(outputFile_),m_crawler(crawler_)
-		,m_dclassdetector(dclassdetector_),m_dclass(dclass_),m_postaggerinst(postaggerinst_)
+		,m_dclassdetector(dclassdetector_),m_dclassCache(dclassCache_),m_dclass(dclass_),m_postaggerinst(postaggerinst_)
 		,m_entitySegmenter(entitySegmenter_),m_entityPrefix(entityPrefix_)
 		,m_fileTagPrefix(fileTagPrefix_)
 	{
@@ -500,7 +506,7 @@ public:
 	{
 		try
 		{
-			writePosTaggerInput( m_inputPath, m_outputFile, m_crawler, m_dclassdetector, m_dclass, m_postaggerinst, m_entitySegmenter, m_entityPrefix, m_fileTagPrefix);
+			writePosTaggerInput( m_inputPath, m_outputFile, m_crawler, m_dclassdetector, m_dclassCache, m_dclass, m_postaggerinst, m_entitySegmenter, m_entityPrefix, m_fileTagPrefix);
 		}
 		catch (const std::bad_alloc& err)
 		{
@@ -522,6 +528,7 @@ private:
 	std::string m_outputFile;
 	strus::FileCrawlerInterface* m_crawler;
 	const strus::DocumentClassDetectorInterface* m_dclassdetector;
+	strus::DocumentClassCache* m_dclassCache;
 	strus::analyzer::DocumentClass m_dclass;
 	const strus::PosTaggerInstanceInterface* m_postaggerinst;
 	const strus::SegmenterInstanceInterface* m_entitySegmenter;
@@ -539,13 +546,14 @@ public:
 			int threadid_,
 			strus::FileCrawlerInterface* crawler_,
 			const strus::DocumentClassDetectorInterface* dclassdetector_,
+			strus::DocumentClassCache* dclassCache_,
 			const strus::analyzer::DocumentClass& dclass_,
 			const strus::PosTaggerInstanceInterface* postaggerinst_,
 			const strus::PosTaggerDataInterface* data_,
 			const std::map<std::string,int>* filemap_,
 			const std::string& outputpath_,
 			const std::string& errorpath_)
-		:m_threadid(threadid_),m_crawler(crawler_),m_dclassdetector(dclassdetector_),m_dclass(dclass_)
+		:m_threadid(threadid_),m_crawler(crawler_),m_dclassdetector(dclassdetector_),m_dclassCache(dclassCache_),m_dclass(dclass_)
 		,m_postaggerinst(postaggerinst_)
 		,m_data(data_),m_filemap(filemap_),m_outputpath(outputpath_),m_errorpath(errorpath_)
 	{}
@@ -554,7 +562,7 @@ public:
 	{
 		try
 		{
-			writePosTagging( m_data, *m_filemap, m_outputpath, m_errorpath, m_dclassdetector, m_dclass, m_postaggerinst, m_crawler);
+			writePosTagging( m_data, *m_filemap, m_outputpath, m_errorpath, m_dclassdetector, m_dclassCache, m_dclass, m_postaggerinst, m_crawler);
 		}
 		catch (const std::bad_alloc& err)
 		{
@@ -574,6 +582,7 @@ private:
 	int m_threadid;
 	strus::FileCrawlerInterface* m_crawler;
 	const strus::DocumentClassDetectorInterface* m_dclassdetector;
+	strus::DocumentClassCache* m_dclassCache;
 	strus::analyzer::DocumentClass m_dclass;
 	const strus::PosTaggerInstanceInterface* m_postaggerinst;
 	const strus::PosTaggerDataInterface* m_data;
@@ -614,14 +623,15 @@ int main( int argc, const char* argv[])
 		bool printUsageAndExit = false;
 
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc, argv, 25,
+				errorBuffer.get(), argc, argv, 27,
 				"h,help", "v,version", "V,verbose",
 				"license", "G,debug:", "m,module:",
 				"M,moduledir:", "r,rpc:", "T,trace:", "R,resourcedir:",
 				"g,segmenter:", "C,contenttype:", "x,extension:",
 				"e,contentexpr:", "X,entityexpr:", "E,spaceexpr:", "p,punctexpr:", "D,punctdelim:",
 				"I,posinp", "t,threads:", "f,fetch:",
-				"P,prefix:", "Y,entityprefix:", "o,output:", "F,erroutput:");
+				"P,prefix:", "Y,entityprefix:", "o,output:", "F,erroutput:",
+				"detectcache:", "detectsample:");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
@@ -792,6 +802,7 @@ int main( int argc, const char* argv[])
 			std::cout << "    " << _TXT("forced definition of the document class of the document processed.") << std::endl;
 			std::cout << "-x|--extension <EXT>" << std::endl;
 			std::cout << "    " << _TXT("extension of the input files processed.") << std::endl;
+			strus::printDocumentClassCacheUsage( std::cout);
 			std::cout << "-t|--threads <N>" << std::endl;
 			std::cout << "    " << _TXT("Set <N> as number of threads to use") << std::endl;
 			std::cout << "-f|--fetch <N>" << std::endl;
@@ -990,6 +1001,9 @@ int main( int argc, const char* argv[])
 		if (!fileCrawler.get()) throw std::runtime_error( errorBuffer->fetchError());
 		strus::local_ptr<strus::DocumentClassDetectorInterface> documentClassDetector( analyzerBuilder->createDocumentClassDetector());
 		if (!documentClassDetector.get()) throw std::runtime_error( errorBuffer->fetchError());
+
+		// Create the cache of document classes detected if enabled:
+		strus::local_ptr<strus::DocumentClassCache> dclassCache( strus::createDocumentClassCache( opt));
 		const strus::SegmenterInterface* segmenter = NULL;
 		strus::analyzer::SegmenterOptions segmenterOpts;
 		strus::local_ptr<strus::SegmenterInstanceInterface> entitySegmenterInst;
@@ -1112,7 +1126,7 @@ int main( int argc, const char* argv[])
 					int threadid = threads ? (ti+1) : -1;
 					workers[ti].reset(
 						new PosInputWorker(
-							threadid, fileCrawler.get(), documentClassDetector.get(),
+							threadid, fileCrawler.get(), documentClassDetector.get(), dclassCache.get(),
 							documentClass, postagger.get(), entitySegmenterInst.get(),
 							entityPrefix, filenamePrefix, docdir, posfile));
 				}
@@ -1154,7 +1168,7 @@ int main( int argc, const char* argv[])
 					int threadid = threads ? (ti+1) : -1;
 					workers[ti].reset(
 						new PosOutputWorker(
-							threadid, fileCrawler.get(), documentClassDetector.get(),
+							threadid, fileCrawler.get(), documentClassDetector.get(), dclassCache.get(),
 							documentClass, postagger.get(), posTagData.get(), &posTagDocnoMap,
 							outputpath, errorpath));
 				}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryBenchmarkProcessor.hpp"
+#include "queryBenchmarkSchedule.hpp"
+#include "queryEvaluator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/internationalization.hpp"
+#include <sstream>
+#include <stdexcept>
+
+using namespace strus;
+
+void QueryBenchmarkProcessor::run()
+{
+	std::size_t evalidx;
+	double arrivalTime;
+	while (m_schedule->fetch( evalidx, arrivalTime))
+	{
+		QueryBenchmarkSample sample;
+		sample.evalidx = evalidx;
+		sample.queryidx = evalidx % m_queries->size();
+		if (arrivalTime > 0.0)
+		{
+			QueryBenchmarkSchedule::waitUntil( arrivalTime);
+		}
+		double startTime = QueryTiming::timestamp();
+		// Open loop: the time a query waits for a thread after its arrival is part of its latency
+		sample.waitTime = (arrivalTime > 0.0 && startTime > arrivalTime) ? startTime - arrivalTime : 0.0;
+		std::ostringstream out;
+		try
+		{
+			m_evaluator->evaluate( out, (*m_queries)[ sample.queryidx], &sample.timing);
+		}
+		catch (const std::bad_alloc&)
+		{
+			sample.failed = true;
+			if (m_firstError.empty()) m_firstError = _TXT("out of memory");
+		}
+		catch (const std::exception& err)
+		{
+			sample.failed = true;
+			if (m_firstError.empty()) m_firstError = err.what();
+		}
+		catch (...)
+		{
+			sample.failed = true;
+			if (m_firstError.empty()) m_firstError = _TXT("unknown exception");
+		}
+		if (m_errorhnd->hasError())
+		{
+			(void)m_errorhnd->fetchError();
+		}
+		m_samples.push_back( sample);
+	}
+	m_errorhnd->releaseContext();
+}
+
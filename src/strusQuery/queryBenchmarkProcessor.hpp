@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_BENCHMARK_PROCESSOR_HPP_INCLUDED
+#define _STRUS_QUERY_BENCHMARK_PROCESSOR_HPP_INCLUDED
+#include "queryBenchmarkResult.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class QueryEvaluator;
+/// \brief Forward declaration
+class QueryBenchmarkSchedule;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Thread of strusBenchmarkQuery evaluating the queries fetched from the schedule at their arrival time
+class QueryBenchmarkProcessor
+{
+public:
+	/// \brief Constructor
+	/// \param[in] evaluator_ evaluator of the queries
+	/// \param[in] queries_ list of the queries replayed, the evaluation with index i evaluates the query with index i modulo the number of queries
+	/// \param[in] schedule_ schedule handing out the queries to evaluate
+	/// \param[in] errorhnd_ error buffer interface
+	QueryBenchmarkProcessor(
+			const QueryEvaluator* evaluator_,
+			const std::vector<std::string>* queries_,
+			QueryBenchmarkSchedule* schedule_,
+			ErrorBufferInterface* errorhnd_)
+		:m_evaluator(evaluator_),m_queries(queries_),m_schedule(schedule_),m_errorhnd(errorhnd_),m_samples(),m_firstError(){}
+
+	/// \brief Thread main function
+	void run();
+
+	/// \brief Measurements of the queries evaluated by this thread
+	const std::vector<QueryBenchmarkSample>& samples() const
+	{
+		return m_samples;
+	}
+	/// \brief Error message of the first query failed in this thread, empty if none
+	const std::string& firstError() const
+	{
+		return m_firstError;
+	}
+
+private:
+	const QueryEvaluator* m_evaluator;
+	const std::vector<std::string>* m_queries;
+	QueryBenchmarkSchedule* m_schedule;
+	ErrorBufferInterface* m_errorhnd;
+	std::vector<QueryBenchmarkSample> m_samples;
+	std::string m_firstError;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryBenchmarkResult.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/fileio.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include <algorithm>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+using namespace strus;
+
+QueryBenchmarkResult::QueryBenchmarkResult(
+		const std::vector<std::string>& queries_,
+		const std::vector<QueryBenchmarkSample>& samples_,
+		double duration_,
+		int nofThreads_,
+		double rate_)
+	:m_samples(samples_),m_queries(),m_duration(duration_),m_nofThreads(nofThreads_),m_rate(rate_)
+{
+	// Queries are stored as single lines, so that they can be saved line by line and identified in a comparison:
+	std::vector<std::string>::const_iterator qi = queries_.begin(), qe = queries_.end();
+	for (; qi != qe; ++qi)
+	{
+		std::string line;
+		std::string::const_iterator ci = qi->begin(), ce = qi->end();
+		for (; ci != ce; ++ci)
+		{
+			if ((unsigned char)*ci <= 32)
+			{
+				if (!line.empty() && line[ line.size()-1] != ' ') line.push_back( ' ');
+			}
+			else
+			{
+				line.push_back( *ci);
+			}
+		}
+		if (!line.empty() && line[ line.size()-1] == ' ') line.resize( line.size()-1);
+		m_queries.push_back( line);
+	}
+}
+
+enum SamplePart {PartLatency, PartWait, PartParse, PartEval};
+
+static double samplePart( const QueryBenchmarkSample& sample, SamplePart part)
+{
+	switch (part)
+	{
+		case PartLatency: return sample.latency();
+		case PartWait: return sample.waitTime;
+		case PartParse: return sample.timing.parseTime;
+		case PartEval: return sample.timing.evalTime;
+	}
+	return 0.0;
+}
+
+/// \brief Summary of the latencies of the queries succeeded in milliseconds
+struct LatencySummary
+{
+	std::size_t count;
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+	double p999;
+	double max;
+
+	LatencySummary( const std::vector<QueryBenchmarkSample>& samples, SamplePart part)
+		:count(0),mean(0.0),p50(0.0),p90(0.0),p99(0.0),p999(0.0),max(0.0)
+	{
+		std::vector<double> values;
+		values.reserve( samples.size());
+		double sum = 0.0;
+		std::vector<QueryBenchmarkSample>::const_iterator si = samples.begin(), se = samples.end();
+		for (; si != se; ++si)
+		{
+			if (si->failed) continue;
+			double value = samplePart( *si, part) * 1000.0;
+			values.push_back( value);
+			sum += value;
+		}
+		if (values.empty()) return;
+		std::sort( values.begin(), values.end());
+		count = values.size();
+		mean = sum / count;
+		p50 = latencyPercentile( values, 0.5);
+		p90 = latencyPercentile( values, 0.9);
+		p99 = latencyPercentile( values, 0.99);
+		p999 = latencyPercentile( values, 0.999);
+		max = values.back();
+	}
+};
+
+static void printSummaryLine( std::ostream& out, const char* name, const LatencySummary& summary)
+{
+	out << strus::string_format( "%-10s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f",
+			name, summary.mean, summary.p50, summary.p90, summary.p99, summary.p999, summary.max) << std::endl;
+}
+
+static std::size_t countFailed( const std::vector<QueryBenchmarkSample>& samples)
+{
+	std::size_t rt = 0;
+	std::vector<QueryBenchmarkSample>::const_iterator si = samples.begin(), se = samples.end();
+	for (; si != se; ++si) if (si->failed) ++rt;
+	return rt;
+}
+
+double QueryBenchmarkResult::throughput() const
+{
+	if (m_duration <= 0.0) return 0.0;
+	return (double)(m_samples.size() - countFailed( m_samples)) / m_duration;
+}
+
+std::size_t QueryBenchmarkResult::nofFailed() const
+{
+	return countFailed( m_samples);
+}
+
+static bool compareSampleLatencyDesc( const QueryBenchmarkSample& a, const QueryBenchmarkSample& b)
+{
+	return a.latency() > b.latency();
+}
+
+void QueryBenchmarkResult::printReport( std::ostream& out, std::size_t nofOutliers) const
+{
+	std::size_t nofFailed = countFailed( m_samples);
+	out << strus::string_format( _TXT("evaluated %u queries (%u failed) in %.4f seconds with %d threads"),
+					(unsigned int)m_samples.size(), (unsigned int)nofFailed, m_duration, m_nofThreads) << std::endl;
+	if (m_rate > 0.0)
+	{
+		out << strus::string_format( _TXT("throughput: %.2f queries/second (arrival rate %.2f queries/second)"), throughput(), m_rate) << std::endl;
+	}
+	else
+	{
+		out << strus::string_format( _TXT("throughput: %.2f queries/second (closed loop)"), throughput()) << std::endl;
+	}
+	if (m_samples.size() == nofFailed) return;
+
+	out << _TXT("query latency in milliseconds:") << std::endl;
+	out << strus::string_format( "%-10s %10s %10s %10s %10s %10s %10s", "", "mean", "p50", "p90", "p99", "p99.9", "max") << std::endl;
+	printSummaryLine( out, "latency", LatencySummary( m_samples, PartLatency));
+	if (m_rate > 0.0)
+	{
+		printSummaryLine( out, "wait", LatencySummary( m_samples, PartWait));
+	}
+	printSummaryLine( out, "parse", LatencySummary( m_samples, PartParse));
+	printSummaryLine( out, "evaluate", LatencySummary( m_samples, PartEval));
+
+	if (nofOutliers)
+	{
+		std::vector<QueryBenchmarkSample> sorted( m_samples);
+		std::size_t nofSorted = std::min( nofOutliers, sorted.size());
+		std::partial_sort( sorted.begin(), sorted.begin() + nofSorted, sorted.end(), compareSampleLatencyDesc);
+		out << strus::string_format( _TXT("slowest %u queries (latency in milliseconds, query number, source):"), (unsigned int)nofSorted) << std::endl;
+		std::vector<QueryBenchmarkSample>::const_iterator si = sorted.begin(), se = sorted.begin() + nofSorted;
+		for (; si != se; ++si)
+		{
+			out << strus::string_format( "%10.3f %6u %s%s", si->latency() * 1000.0, (unsigned int)(si->queryidx+1),
+						si->failed ? "(failed) " : "", m_queries[ si->queryidx].c_str()) << std::endl;
+		}
+	}
+}
+
+void QueryBenchmarkResult::save( const std::string& filename) const
+{
+	FILE* out = ::fopen( filename.c_str(), "w");
+	if (!out) throw strus::runtime_error( _TXT("failed to open benchmark result file '%s' for writing: %s"), filename.c_str(), ::strerror(errno));
+
+	::fprintf( out, "# strusBenchmarkQuery result\n");
+	::fprintf( out, "duration\t%.9f\n", m_duration);
+	::fprintf( out, "threads\t%d\n", m_nofThreads);
+	::fprintf( out, "rate\t%.9f\n", m_rate);
+	std::vector<std::string>::const_iterator qi = m_queries.begin(), qe = m_queries.end();
+	for (; qi != qe; ++qi)
+	{
+		::fprintf( out, "query\t%s\n", qi->c_str());
+	}
+	std::vector<QueryBenchmarkSample>::const_iterator si = m_samples.begin(), se = m_samples.end();
+	for (; si != se; ++si)
+	{
+		::fprintf( out, "sample\t%u\t%u\t%.9f\t%.9f\t%.9f\t%d\n",
+				(unsigned int)si->evalidx, (unsigned int)si->queryidx,
+				si->waitTime, si->timing.parseTime, si->timing.evalTime, si->failed ? 1:0);
+	}
+	if (::fclose( out) != 0)
+	{
+		throw strus::runtime_error( _TXT("failed to write benchmark result file '%s': %s"), filename.c_str(), ::strerror(errno));
+	}
+}
+
+static std::vector<std::string> splitTabs( const std::string& line)
+{
+	std::vector<std::string> rt;
+	std::string::size_type start = 0, end;
+	while ((end = line.find( '\t', start)) != std::string::npos)
+	{
+		rt.push_back( std::string( line, start, end - start));
+		start = end + 1;
+	}
+	rt.push_back( std::string( line, start));
+	return rt;
+}
+
+void QueryBenchmarkResult::load( const std::string& filename)
+{
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec) throw strus::runtime_error( _TXT("failed to read benchmark result file '%s': %s"), filename.c_str(), ::strerror(ec));
+
+	m_samples.clear();
+	m_queries.clear();
+	m_duration = 0.0;
+	m_nofThreads = 0;
+	m_rate = 0.0;
+
+	std::string::size_type start = 0;
+	int lineno = 0;
+	while (start < content.size())
+	{
+		std::string::size_type end = content.find( '\n', start);
+		if (end == std::string::npos) end = content.size();
+		std::string line( content, start, end - start);
+		start = end + 1;
+		++lineno;
+
+		if (line.empty() || line[0] == '#') continue;
+		std::vector<std::string> cols = splitTabs( line);
+		if (cols[0] == "duration" && cols.size() == 2)
+		{
+			m_duration = std::atof( cols[1].c_str());
+		}
+		else if (cols[0] == "threads" && cols.size() == 2)
+		{
+			m_nofThreads = std::atoi( cols[1].c_str());
+		}
+		else if (cols[0] == "rate" && cols.size() == 2)
+		{
+			m_rate = std::atof( cols[1].c_str());
+		}
+		else if (cols[0] == "query" && cols.size() == 2)
+		{
+			m_queries.push_back( cols[1]);
+		}
+		else if (cols[0] == "sample" && cols.size() == 7)
+		{
+			QueryBenchmarkSample sample;
+			sample.evalidx = std::atoi( cols[1].c_str());
+			sample.queryidx = std::atoi( cols[2].c_str());
+			sample.waitTime = std::atof( cols[3].c_str());
+			sample.timing = QueryTiming( std::atof( cols[4].c_str()), std::atof( cols[5].c_str()));
+			sample.failed = (cols[6] == "1");
+			if (sample.queryidx >= m_queries.size())
+			{
+				throw strus::runtime_error( _TXT("undefined query referenced in benchmark result file '%s' on line %d"), filename.c_str(), lineno);
+			}
+			m_samples.push_back( sample);
+		}
+		else
+		{
+			throw strus::runtime_error( _TXT("syntax error in benchmark result file '%s' on line %d"), filename.c_str(), lineno);
+		}
+	}
+}
+
+static double relativeChange( double baseline, double current)
+{
+	return baseline > 0.0 ? (current - baseline) / baseline : 0.0;
+}
+
+static void printCompareLine( std::ostream& out, const char* name, double baseline, double current)
+{
+	out << strus::string_format( "%-12s %12.3f %12.3f %+9.1f%%", name, baseline, current, relativeChange( baseline, current) * 100.0) << std::endl;
+}
+
+/// \brief Mean latency of every query succeeded at least once, identified by its source
+typedef std::map<std::string,std::pair<double,unsigned int> > QueryLatencyMap;
+
+static QueryLatencyMap queryLatencyMap( const std::vector<QueryBenchmarkSample>& samples, const std::vector<std::string>& queries)
+{
+	QueryLatencyMap rt;
+	std::vector<QueryBenchmarkSample>::const_iterator si = samples.begin(), se = samples.end();
+	for (; si != se; ++si)
+	{
+		if (si->failed) continue;
+		std::pair<double,unsigned int>& entry = rt[ queries[ si->queryidx]];
+		entry.first += si->latency();
+		entry.second += 1;
+	}
+	return rt;
+}
+
+struct QuerySlowDown
+{
+	double change;
+	double baseline;
+	double current;
+	std::string query;
+
+	QuerySlowDown( double change_, double baseline_, double current_, const std::string& query_)
+		:change(change_),baseline(baseline_),current(current_),query(query_){}
+
+	bool operator < (const QuerySlowDown& o) const
+	{
+		return change > o.change;
+	}
+};
+
+bool QueryBenchmarkResult::compare( std::ostream& out, const QueryBenchmarkResult& baseline, double threshold, std::size_t nofOutliers) const
+{
+	LatencySummary base( baseline.m_samples, PartLatency);
+	LatencySummary cur( m_samples, PartLatency);
+
+	out << _TXT("comparison with baseline (throughput in queries/second, latency in milliseconds):") << std::endl;
+	out << strus::string_format( "%-12s %12s %12s %10s", "", "baseline", "current", "change") << std::endl;
+	printCompareLine( out, "throughput", baseline.throughput(), throughput());
+	printCompareLine( out, "mean", base.mean, cur.mean);
+	printCompareLine( out, "p50", base.p50, cur.p50);
+	printCompareLine( out, "p90", base.p90, cur.p90);
+	printCompareLine( out, "p99", base.p99, cur.p99);
+	printCompareLine( out, "p99.9", base.p999, cur.p999);
+	printCompareLine( out, "max", base.max, cur.max);
+
+	if (baseline.m_nofThreads != m_nofThreads || baseline.m_rate != m_rate)
+	{
+		out << strus::string_format( _TXT("warning: baseline run with %d threads and arrival rate %.2f, current run with %d threads and arrival rate %.2f"),
+						baseline.m_nofThreads, baseline.m_rate, m_nofThreads, m_rate) << std::endl;
+	}
+	bool regression =
+		relativeChange( baseline.throughput(), throughput()) < -threshold
+		|| relativeChange( base.mean, cur.mean) > threshold
+		|| relativeChange( base.p99, cur.p99) > threshold;
+
+	// List the queries with a mean latency grown by more than the threshold:
+	QueryLatencyMap baseMap = queryLatencyMap( baseline.m_samples, baseline.m_queries);
+	QueryLatencyMap curMap = queryLatencyMap( m_samples, m_queries);
+	std::vector<QuerySlowDown> slowdowns;
+	QueryLatencyMap::const_iterator ci = curMap.begin(), ce = curMap.end();
+	for (; ci != ce; ++ci)
+	{
+		QueryLatencyMap::const_iterator bi = baseMap.find( ci->first);
+		if (bi == baseMap.end()) continue;
+		double baseMean = bi->second.first / bi->second.second;
+		double curMean = ci->second.first / ci->second.second;
+		double change = relativeChange( baseMean, curMean);
+		if (change > threshold)
+		{
+			slowdowns.push_back( QuerySlowDown( change, baseMean * 1000.0, curMean * 1000.0, ci->first));
+		}
+	}
+	if (!slowdowns.empty() && nofOutliers)
+	{
+		std::sort( slowdowns.begin(), slowdowns.end());
+		out << strus::string_format( _TXT("%u queries slower than the baseline by more than %.1f%% (change, baseline and current mean latency in milliseconds, source):"),
+						(unsigned int)slowdowns.size(), threshold * 100.0) << std::endl;
+		std::vector<QuerySlowDown>::const_iterator si = slowdowns.begin(), se = slowdowns.begin() + std::min( nofOutliers, slowdowns.size());
+		for (; si != se; ++si)
+		{
+			out << strus::string_format( "%+9.1f%% %10.3f %10.3f %s", si->change * 100.0, si->baseline, si->current, si->query.c_str()) << std::endl;
+		}
+	}
+	if (regression)
+	{
+		out << strus::string_format( _TXT("REGRESSION: throughput, mean or p99 latency worse than the baseline by more than %.1f%%"), threshold * 100.0) << std::endl;
+	}
+	else
+	{
+		out << _TXT("no regression") << std::endl;
+	}
+	return regression;
+}
+
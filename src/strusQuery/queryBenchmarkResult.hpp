@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_BENCHMARK_RESULT_HPP_INCLUDED
+#define _STRUS_QUERY_BENCHMARK_RESULT_HPP_INCLUDED
+#include "queryLatencyStatistics.hpp"
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Measurement of one query evaluated in a benchmark run
+struct QueryBenchmarkSample
+{
+	std::size_t evalidx;	///< index of the evaluation in the run
+	std::size_t queryidx;	///< index of the query in the list of queries replayed
+	double waitTime;	///< time in seconds between the scheduled arrival of the query and the start of its evaluation, 0.0 in a closed loop
+	QueryTiming timing;	///< time spent for parsing and evaluating the query
+	bool failed;		///< true, if the evaluation of the query failed
+
+	QueryBenchmarkSample()
+		:evalidx(0),queryidx(0),waitTime(0.0),timing(),failed(false){}
+
+	/// \brief Latency of the query as seen by a client in seconds
+	double latency() const
+	{
+		return waitTime + timing.totalTime();
+	}
+};
+
+/// \brief Result of a benchmark run, printed as report, saved to a file and compared with the result of another run
+class QueryBenchmarkResult
+{
+public:
+	QueryBenchmarkResult()
+		:m_samples(),m_queries(),m_duration(0.0),m_nofThreads(0),m_rate(0.0){}
+
+	/// \brief Constructor
+	/// \param[in] queries_ list of the queries replayed
+	/// \param[in] samples_ measurements of the queries evaluated
+	/// \param[in] duration_ wall clock time of the run in seconds
+	/// \param[in] nofThreads_ number of threads used
+	/// \param[in] rate_ arrival rate in queries per second, 0.0 for a closed loop
+	QueryBenchmarkResult(
+			const std::vector<std::string>& queries_,
+			const std::vector<QueryBenchmarkSample>& samples_,
+			double duration_,
+			int nofThreads_,
+			double rate_);
+
+	/// \brief Number of queries evaluated per second
+	double throughput() const;
+
+	/// \brief Number of query evaluations in the run
+	std::size_t nofEvaluated() const
+	{
+		return m_samples.size();
+	}
+
+	/// \brief Number of query evaluations failed in the run
+	std::size_t nofFailed() const;
+
+	/// \brief Print the throughput, the latency percentiles in milliseconds and the slowest queries
+	/// \param[in] out where to print the report to
+	/// \param[in] nofOutliers number of the slowest queries to list
+	void printReport( std::ostream& out, std::size_t nofOutliers) const;
+
+	/// \brief Save the result of the run to a file for a later comparison
+	/// \param[in] filename name of the file to write
+	void save( const std::string& filename) const;
+
+	/// \brief Load the result of a run from a file written with save
+	/// \param[in] filename name of the file to read
+	void load( const std::string& filename);
+
+	/// \brief Print the comparison of this result with the result of a previous run
+	/// \param[in] out where to print the comparison to
+	/// \param[in] baseline result of the previous run
+	/// \param[in] threshold relative change (e.g. 0.1 for 10%) considered as regression
+	/// \param[in] nofOutliers maximum number of queries slowed down to list
+	/// \return true, if the throughput, the mean or the p99 latency is worse than the baseline by more than the threshold
+	bool compare( std::ostream& out, const QueryBenchmarkResult& baseline, double threshold, std::size_t nofOutliers) const;
+
+private:
+	std::vector<QueryBenchmarkSample> m_samples;
+	std::vector<std::string> m_queries;
+	double m_duration;
+	int m_nofThreads;
+	double m_rate;
+};
+
+}//namespace
+#endif
+
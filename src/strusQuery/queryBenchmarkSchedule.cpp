@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryBenchmarkSchedule.hpp"
+#include "queryLatencyStatistics.hpp"
+#include <cmath>
+#include <cerrno>
+#include <time.h>
+
+using namespace strus;
+
+/// \brief Pseudo random number generator (xorshift64) returning values in the open interval (0,1)
+class UniformRandom
+{
+public:
+	UniformRandom()
+		:m_state(0x2545F4914F6CDD1DULL){}
+
+	double next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 7;
+		m_state ^= m_state << 17;
+		return ((double)(m_state >> 11) + 0.5) / 9007199254740992.0/*2^53*/;
+	}
+
+private:
+	unsigned long long m_state;
+};
+
+QueryBenchmarkSchedule::QueryBenchmarkSchedule( std::size_t nofEvaluations_, Arrival arrival_, double rate_)
+	:m_nofEvaluations(nofEvaluations_),m_arrival(arrival_),m_rate(rate_),m_arrivals()
+	,m_startTime(0.0),m_next(0)
+{
+	if (m_arrival == ClosedLoop) return;
+	m_arrivals.reserve( m_nofEvaluations);
+	UniformRandom rnd;
+	double offset = 0.0;
+	for (std::size_t ei = 0; ei < m_nofEvaluations; ++ei)
+	{
+		m_arrivals.push_back( offset);
+		offset += (m_arrival == PoissonRate) ? -std::log( rnd.next()) / m_rate : 1.0 / m_rate;
+	}
+}
+
+void QueryBenchmarkSchedule::start()
+{
+	strus::scoped_lock lock( m_mutex);
+	m_startTime = QueryTiming::timestamp();
+	m_next = 0;
+}
+
+bool QueryBenchmarkSchedule::fetch( std::size_t& evalidx, double& arrivalTime)
+{
+	strus::scoped_lock lock( m_mutex);
+	if (m_next >= m_nofEvaluations) return false;
+	evalidx = m_next++;
+	arrivalTime = (m_arrival == ClosedLoop) ? 0.0 : m_startTime + m_arrivals[ evalidx];
+	return true;
+}
+
+void QueryBenchmarkSchedule::waitUntil( double timestamp)
+{
+	struct timespec ts;
+	ts.tv_sec = (time_t)timestamp;
+	ts.tv_nsec = (long)((timestamp - (double)ts.tv_sec) * 1000000000.0);
+	if (ts.tv_nsec >= 1000000000L) ts.tv_nsec = 999999999L;
+	while (::clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR){}
+}
+
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_BENCHMARK_SCHEDULE_HPP_INCLUDED
+#define _STRUS_QUERY_BENCHMARK_SCHEDULE_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Hands out the queries of a benchmark run to the benchmark threads with the time they are scheduled to arrive
+class QueryBenchmarkSchedule
+{
+public:
+	/// \brief How the arrival times of the queries are determined
+	enum Arrival
+	{
+		ClosedLoop,		///< no arrival times, a thread evaluates the next query as soon as it is finished with the last one
+		FixedRate,		///< open loop, queries arrive at a fixed interval of 1/rate seconds
+		PoissonRate		///< open loop, queries arrive with exponentially distributed intervals with mean 1/rate seconds
+	};
+
+	/// \brief Constructor
+	/// \param[in] nofEvaluations_ number of queries to evaluate in the run
+	/// \param[in] arrival_ how the arrival times of the queries are determined
+	/// \param[in] rate_ arrival rate in queries per second, ignored for ClosedLoop
+	/// \note The arrival times for PoissonRate are generated with a fixed seed, so that runs with the same parameters are comparable
+	QueryBenchmarkSchedule( std::size_t nofEvaluations_, Arrival arrival_, double rate_);
+
+	/// \brief Define the start of the run, the arrival times are relative to it
+	void start();
+
+	/// \brief Get the next query to evaluate
+	/// \param[out] evalidx index of the evaluation in the run
+	/// \param[out] arrivalTime time stamp (QueryTiming::timestamp) of the scheduled arrival of the query, 0.0 for ClosedLoop
+	/// \return false if there are no queries left
+	bool fetch( std::size_t& evalidx, double& arrivalTime);
+
+	/// \brief Wait till a time stamp (QueryTiming::timestamp) is reached
+	static void waitUntil( double timestamp);
+
+	Arrival arrival() const		{return m_arrival;}
+	double rate() const		{return m_rate;}
+
+private:
+	std::size_t m_nofEvaluations;
+	Arrival m_arrival;
+	double m_rate;
+	std::vector<double> m_arrivals;		///< offsets of the arrival times to the start of the run in seconds
+	double m_startTime;
+	std::size_t m_next;
+	strus::mutex m_mutex;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryEvalProcessor.hpp"
+#include "queryEvaluator.hpp"
+#include "private/orderedResultBuffer.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/internationalization.hpp"
+#include <sstream>
+#include <stdexcept>
+
+using namespace strus;
+
+void QueryEvalProcessor::run()
+{
+	std::size_t queryidx;
+	while (m_buffer->fetch( queryidx))
+	{
+		std::ostringstream out;
+		//... every thread writes the timing of the queries it fetched only, the result is read after the push
+		QueryTiming* timing = m_timings ? &(*m_timings)[ queryidx] : 0;
+		std::string error;
+		try
+		{
+			m_evaluator->evaluate( out, (*m_queries)[ queryidx], timing);
+		}
+		catch (const std::bad_alloc&)
+		{
+			error = _TXT("out of memory");
+		}
+		catch (const std::exception& err)
+		{
+			error = err.what();
+		}
+		catch (...)
+		{
+			error = _TXT("unknown exception");
+		}
+		if (m_errorhnd->hasError())
+		{
+			(void)m_errorhnd->fetchError();
+		}
+		// A result is pushed for every query fetched, otherwise the thread popping the results would wait forever:
+		if (error.empty())
+		{
+			m_buffer->push( queryidx, out.str(), error);
+		}
+		else
+		{
+			m_buffer->push( queryidx, std::string(), error);
+		}
+	}
+	m_errorhnd->releaseContext();
+}
+
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_EVAL_PROCESSOR_HPP_INCLUDED
+#define _STRUS_QUERY_EVAL_PROCESSOR_HPP_INCLUDED
+#include "queryLatencyStatistics.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class QueryEvaluator;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+namespace utils {
+/// \brief Forward declaration
+class OrderedResultBuffer;
+}
+
+/// \brief Thread of strusQuery evaluating the queries fetched from a buffer returning the results in the order of the queries
+/// \note Every query is evaluated with its own query object, the storage client and the programs loaded are shared
+class QueryEvalProcessor
+{
+public:
+	/// \brief Constructor
+	/// \param[in] evaluator_ evaluator of the queries
+	/// \param[in] queries_ list of all queries to evaluate
+	/// \param[in] buffer_ buffer handing out the indices of the queries to evaluate and collecting the results
+	/// \param[out] timings_ where to write the time spent on each query to (indexed like queries_), NULL if not measured
+	/// \param[in] errorhnd_ error buffer interface
+	QueryEvalProcessor(
+			const QueryEvaluator* evaluator_,
+			const std::vector<std::string>* queries_,
+			utils::OrderedResultBuffer* buffer_,
+			std::vector<QueryTiming>* timings_,
+			ErrorBufferInterface* errorhnd_)
+		:m_evaluator(evaluator_),m_queries(queries_),m_buffer(buffer_),m_timings(timings_),m_errorhnd(errorhnd_){}
+
+	/// \brief Thread main function
+	void run();
+
+private:
+	const QueryEvaluator* m_evaluator;
+	const std::vector<std::string>* m_queries;
+	utils::OrderedResultBuffer* m_buffer;
+	std::vector<QueryTiming>* m_timings;
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
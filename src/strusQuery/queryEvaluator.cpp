@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryEvaluator.hpp"
+#include "queryLatencyStatistics.hpp"
+#include "queryResultCache.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/queryAnalyzerInstanceInterface.hpp"
+#include "strus/queryEvalInterface.hpp"
+#include "strus/queryProcessorInterface.hpp"
+#include "strus/queryInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "private/programLoader.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace strus;
+
+QueryEvaluator::QueryEvaluator(
+		StorageClientInterface* storage_,
+		const QueryAnalyzerInstanceInterface* analyzer_,
+		const QueryEvalInterface* qeval_,
+		const QueryProcessorInterface* qproc_,
+		const std::string& username_,
+		std::size_t firstRank_,
+		std::size_t nofRanks_,
+		bool quiet_,
+		bool verbose_,
+		QueryResultCache* cache_,
+		QueryPlanCacheInterface* planCache_,
+		ErrorBufferInterface* errorhnd_)
+	:m_storage(storage_),m_analyzer(analyzer_),m_qeval(qeval_),m_qproc(qproc_)
+	,m_selectionFeatureSet(),m_weightingFeatureSet(),m_username(username_)
+	,m_firstRank(firstRank_),m_nofRanks(nofRanks_),m_quiet(quiet_),m_verbose(verbose_),m_cache(cache_),m_planCache(planCache_),m_errorhnd(errorhnd_)
+{
+	std::vector<std::string> selfset = m_qeval->getSelectionFeatureSets();
+	if (!selfset.empty()) m_selectionFeatureSet = selfset[0];
+	std::vector<std::string> weightset = m_qeval->getWeightingFeatureSets();
+	if (!weightset.empty()) m_weightingFeatureSet = weightset[0];
+}
+
+void QueryEvaluator::evaluate( std::ostream& out, const std::string& querysource, QueryTiming* timing) const
+{
+	if (!m_cache)
+	{
+		evaluateQuery( out, querysource, timing);
+		return;
+	}
+	double startTime = timing ? QueryTiming::timestamp() : 0.0;
+	Index maxDocno = m_storage->maxDocumentNumber();
+	Index nofDocuments = m_storage->nofDocumentsInserted();
+	if (m_errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT("failed to get storage revision for the query result cache: %s"), m_errorhnd->fetchError());
+	}
+	m_cache->checkRevision( maxDocno, nofDocuments);
+
+	std::string cachekey = QueryResultCache::key( querysource, m_firstRank, m_nofRanks, m_username);
+	std::string result;
+	if (m_cache->get( cachekey, result))
+	{
+		if (timing)
+		{
+			*timing = QueryTiming( 0.0, QueryTiming::timestamp() - startTime);
+		}
+		out << result;
+		return;
+	}
+	std::ostringstream resultbuf;
+	evaluateQuery( resultbuf, querysource, timing);
+	result = resultbuf.str();
+	m_cache->put( cachekey, result);
+	out << result;
+}
+
+void QueryEvaluator::evaluateQuery( std::ostream& out, const std::string& querysource, QueryTiming* timing) const
+{
+	double startTime = timing ? QueryTiming::timestamp() : 0.0;
+	strus::local_ptr<strus::QueryInterface> query( m_qeval->createQuery( m_storage));
+	if (!query.get()) throw strus::runtime_error(_TXT("failed to create query object: %s"), m_errorhnd->fetchError());
+
+	if (!strus::loadQuery( *query, m_analyzer, m_selectionFeatureSet, m_weightingFeatureSet, m_qproc, querysource, m_planCache, m_errorhnd))
+	{
+		throw strus::runtime_error(_TXT("failed to load query from source: %s"), m_errorhnd->fetchError());
+	}
+	if (!m_username.empty())
+	{
+		query->addAccess( m_username);
+	}
+	double parseEndTime = timing ? QueryTiming::timestamp() : 0.0;
+	if (m_verbose)
+	{
+		std::cerr << "Query:" << std::endl;
+		std::cerr << query->view().tostring() << std::endl;
+	}
+	double evalStartTime = timing ? QueryTiming::timestamp() : 0.0;
+	strus::QueryResult result = query->evaluate( m_firstRank, m_nofRanks);
+	if (m_errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT("failed to evaluate query: %s"), m_errorhnd->fetchError());
+	}
+	if (timing)
+	{
+		*timing = QueryTiming( parseEndTime - startTime, QueryTiming::timestamp() - evalStartTime);
+	}
+	if (m_quiet) return;
+
+	out << strus::string_format( _TXT("evaluated till pass %u, got %u ranks (%u without restrictions applied):"), result.evaluationPass(), result.nofRanked(), result.nofVisited()) << std::endl;
+	out << strus::string_format( _TXT("ranked list (starting with rank %u, maximum %u results):"), (unsigned int)m_firstRank, (unsigned int)m_nofRanks) << std::endl;
+
+	std::vector<strus::ResultDocument>::const_iterator wi = result.ranks().begin(), we = result.ranks().end();
+	for (int widx=1; wi != we; ++wi,++widx)
+	{
+		if (wi->field().defined())
+		{
+			out << strus::string_format( _TXT( "[%u] field [%d,%d] score %f"), widx, (int)wi->field().start(), (int)wi->field().end(), wi->weight()) << std::endl;
+		}
+		else
+		{
+			out << strus::string_format( _TXT( "[%u] score %f"), widx, wi->weight()) << std::endl;
+		}
+		std::vector<strus::SummaryElement>::const_iterator
+			ai = wi->summaryElements().begin(),
+			ae = wi->summaryElements().end();
+		for (; ai != ae; ++ai)
+		{
+			out << "\t" << ai->name();
+			if (ai->index() >= 0)
+			{
+				out << "[" << ai->index() << "]";
+			}
+			out << " = '" << ai->value() << "'";
+			out << " " << ai->weight() << std::endl;
+		}
+	}
+}
+
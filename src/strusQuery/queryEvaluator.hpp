@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_EVALUATOR_HPP_INCLUDED
+#define _STRUS_QUERY_EVALUATOR_HPP_INCLUDED
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Forward declaration
+class StorageClientInterface;
+/// \brief Forward declaration
+class QueryAnalyzerInstanceInterface;
+/// \brief Forward declaration
+class QueryEvalInterface;
+/// \brief Forward declaration
+class QueryProcessorInterface;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+struct QueryTiming;
+/// \brief Forward declaration
+class QueryResultCache;
+/// \brief Forward declaration
+class QueryPlanCacheInterface;
+
+/// \brief Evaluates queries with objects initialized once and shared by all queries evaluated
+class QueryEvaluator
+{
+public:
+	/// \brief Constructor
+	/// \param[in] storage_ storage client to query
+	/// \param[in] analyzer_ query analyzer with the query analyzer program loaded
+	/// \param[in] qeval_ query evaluation with the query evaluation program loaded
+	/// \param[in] qproc_ query processor
+	/// \param[in] username_ user name for the access restriction of the queries, empty if none
+	/// \param[in] firstRank_ index of the first rank to return
+	/// \param[in] nofRanks_ maximum number of ranks to return
+	/// \param[in] quiet_ true, if no results should be printed
+	/// \param[in] verbose_ true, if the query structure should be printed to stderr
+	/// \param[in] cache_ cache of query results or NULL if results are not cached
+	/// \param[in] planCache_ cache of parsed queries or NULL if every query is parsed
+	/// \param[in] errorhnd_ error buffer interface
+	QueryEvaluator(
+			StorageClientInterface* storage_,
+			const QueryAnalyzerInstanceInterface* analyzer_,
+			const QueryEvalInterface* qeval_,
+			const QueryProcessorInterface* qproc_,
+			const std::string& username_,
+			std::size_t firstRank_,
+			std::size_t nofRanks_,
+			bool quiet_,
+			bool verbose_,
+			QueryResultCache* cache_,
+			QueryPlanCacheInterface* planCache_,
+			ErrorBufferInterface* errorhnd_);
+
+	/// \brief Evaluate a query and print its result
+	/// \param[out] out where to print the result to
+	/// \param[in] querysource source of the query to evaluate
+	/// \param[out] timing where to write the time spent on parsing and evaluating the query to, NULL if not measured
+	/// \note throws a runtime error if the evaluation fails
+	/// \note the result of a query found in the cache is printed without evaluating the query, the time measured is the cache lookup
+	void evaluate( std::ostream& out, const std::string& querysource, QueryTiming* timing=0) const;
+
+private:
+	void evaluateQuery( std::ostream& out, const std::string& querysource, QueryTiming* timing) const;
+
+private:
+	StorageClientInterface* m_storage;
+	const QueryAnalyzerInstanceInterface* m_analyzer;
+	const QueryEvalInterface* m_qeval;
+	const QueryProcessorInterface* m_qproc;
+	std::string m_selectionFeatureSet;
+	std::string m_weightingFeatureSet;
+	std::string m_username;
+	std::size_t m_firstRank;
+	std::size_t m_nofRanks;
+	bool m_quiet;
+	bool m_verbose;
+	QueryResultCache* m_cache;
+	QueryPlanCacheInterface* m_planCache;
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
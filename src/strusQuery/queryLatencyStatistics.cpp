@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryLatencyStatistics.hpp"
+#include "strus/base/string_format.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include "private/jsonUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <time.h>
+
+using namespace strus;
+
+double QueryTiming::timestamp()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+void QueryLatencyStatistics::add( const QueryTiming& timing, const std::string& querysource)
+{
+	m_timings.push_back( timing);
+	m_queries.push_back( querysource);
+}
+
+double strus::latencyPercentile( const std::vector<double>& sorted, double pp)
+{
+	// Ceiling of pp * n, tolerant to rounding errors of the multiplication:
+	std::size_t rank = (std::size_t)std::ceil( pp * sorted.size() - 1E-9);
+	if (rank == 0) rank = 1;
+	if (rank > sorted.size()) rank = sorted.size();
+	return sorted[ rank-1];
+}
+
+enum TimingPart {PartTotal, PartParse, PartEval};
+
+static void printReportLine( std::ostream& out, const char* name, const std::vector<QueryTiming>& timings, TimingPart part)
+{
+	std::vector<double> values;
+	values.reserve( timings.size());
+	double sum = 0.0;
+	std::vector<QueryTiming>::const_iterator ti = timings.begin(), te = timings.end();
+	for (; ti != te; ++ti)
+	{
+		double value = (part == PartParse) ? ti->parseTime : (part == PartEval) ? ti->evalTime : ti->totalTime();
+		values.push_back( value * 1000.0);
+		sum += value * 1000.0;
+	}
+	std::sort( values.begin(), values.end());
+	out << strus::string_format( "%-10s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f",
+			name, sum / values.size(),
+			latencyPercentile( values, 0.5), latencyPercentile( values, 0.9), latencyPercentile( values, 0.99), latencyPercentile( values, 0.999),
+			values.back()) << std::endl;
+}
+
+void QueryLatencyStatistics::printReport( std::ostream& out) const
+{
+	if (m_timings.empty()) return;
+	out << _TXT("query latency in milliseconds:") << std::endl;
+	out << strus::string_format( "%-10s %10s %10s %10s %10s %10s %10s", "", "mean", "p50", "p90", "p99", "p99.9", "max") << std::endl;
+	printReportLine( out, "total", m_timings, PartTotal);
+	printReportLine( out, "parse", m_timings, PartParse);
+	printReportLine( out, "evaluate", m_timings, PartEval);
+}
+
+static void printCsvString( FILE* out, const std::string& str)
+{
+	::fputc( '"', out);
+	std::string::const_iterator ci = str.begin(), ce = str.end();
+	for (; ci != ce; ++ci)
+	{
+		if (*ci == '"')
+		{
+			::fputc( '"', out);
+			::fputc( '"', out);
+		}
+		else if (*ci == '\n' || *ci == '\r')
+		{
+			::fputc( ' ', out);
+		}
+		else
+		{
+			::fputc( *ci, out);
+		}
+	}
+	::fputc( '"', out);
+}
+
+static std::string trimQuery( const std::string& querysource)
+{
+	std::string::const_iterator start = querysource.begin(), end = querysource.end();
+	for (; start != end && (unsigned char)*start <= 32; ++start){}
+	for (; end != start && (unsigned char)*(end-1) <= 32; --end){}
+	return std::string( start, end);
+}
+
+void QueryLatencyStatistics::writeQueryTimes( const std::string& outputfile) const
+{
+	FILE* out = stderr;
+	if (outputfile != "-")
+	{
+		out = ::fopen( outputfile.c_str(), "w");
+		if (!out) throw strus::runtime_error( _TXT("failed to open query time output file '%s' for writing: %s"), outputfile.c_str(), ::strerror(errno));
+	}
+	static const char jsonext[] = ".json";
+	bool json = outputfile.size() > sizeof(jsonext)-1
+		&& 0==std::strcmp( outputfile.c_str() + outputfile.size() - (sizeof(jsonext)-1), jsonext);
+	if (!json)
+	{
+		::fprintf( out, "query,total_ms,parse_ms,evaluate_ms,source\n");
+	}
+	std::size_t qi = 0, qe = m_timings.size();
+	for (; qi != qe; ++qi)
+	{
+		const QueryTiming& timing = m_timings[ qi];
+		if (json)
+		{
+			::fprintf( out, "{\"query\":%u,\"total_ms\":%.3f,\"parse_ms\":%.3f,\"evaluate_ms\":%.3f,\"source\":",
+					(unsigned int)(qi+1), timing.totalTime() * 1000.0, timing.parseTime * 1000.0, timing.evalTime * 1000.0);
+			utils::printJsonString( out, trimQuery( m_queries[ qi]));
+			::fprintf( out, "}\n");
+		}
+		else
+		{
+			::fprintf( out, "%u,%.3f,%.3f,%.3f,",
+					(unsigned int)(qi+1), timing.totalTime() * 1000.0, timing.parseTime * 1000.0, timing.evalTime * 1000.0);
+			printCsvString( out, trimQuery( m_queries[ qi]));
+			::fprintf( out, "\n");
+		}
+	}
+	if (out == stderr)
+	{
+		::fflush( out);
+	}
+	else if (::fclose( out) != 0)
+	{
+		throw strus::runtime_error( _TXT("failed to write query time output file '%s': %s"), outputfile.c_str(), ::strerror(errno));
+	}
+}
+
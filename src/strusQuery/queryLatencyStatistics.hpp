@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_LATENCY_STATISTICS_HPP_INCLUDED
+#define _STRUS_QUERY_LATENCY_STATISTICS_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace strus {
+
+/// \brief Time spent for the evaluation of a single query in seconds
+struct QueryTiming
+{
+	double parseTime;	///< time spent creating the query and loading it from its source (loadQuery)
+	double evalTime;	///< time spent in the evaluation of the query (QueryInterface::evaluate)
+
+	QueryTiming()
+		:parseTime(0.0),evalTime(0.0){}
+	QueryTiming( double parseTime_, double evalTime_)
+		:parseTime(parseTime_),evalTime(evalTime_){}
+
+	double totalTime() const
+	{
+		return parseTime + evalTime;
+	}
+
+	/// \brief Get a monotonic time stamp in seconds for measuring durations
+	static double timestamp();
+};
+
+/// \brief Percentile with the nearest rank method
+/// \param[in] sorted list of values sorted in ascending order, not empty
+/// \param[in] pp percentile as fraction (e.g. 0.99 for p99)
+double latencyPercentile( const std::vector<double>& sorted, double pp);
+
+/// \brief Collects the latencies of the queries evaluated for a report of percentiles and an export per query
+class QueryLatencyStatistics
+{
+public:
+	QueryLatencyStatistics()
+		:m_timings(),m_queries(){}
+
+	/// \brief Add the timing of a query
+	/// \param[in] timing the times measured
+	/// \param[in] querysource source of the query for the export per query
+	void add( const QueryTiming& timing, const std::string& querysource);
+
+	/// \brief Number of queries added
+	std::size_t size() const
+	{
+		return m_timings.size();
+	}
+
+	/// \brief Print a table of the latency percentiles (p50, p90, p99, p99.9, max) in milliseconds, split into parse and evaluation
+	void printReport( std::ostream& out) const;
+
+	/// \brief Write the timing of every query to a file
+	/// \param[in] outputfile name of the file to write, "-" for stderr. The format is JSON (one object per line) if the name ends with ".json", CSV otherwise
+	void writeQueryTimes( const std::string& outputfile) const;
+
+private:
+	std::vector<QueryTiming> m_timings;
+	std::vector<std::string> m_queries;
+};
+
+}//namespace
+#endif
+
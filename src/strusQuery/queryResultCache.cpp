@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryResultCache.hpp"
+#include "strus/base/string_format.hpp"
+#include "private/internationalization.hpp"
+
+using namespace strus;
+
+QueryResultCache::QueryResultCache( std::size_t maxNofEntries_)
+	:m_maxNofEntries(maxNofEntries_ ? maxNofEntries_ : 1),m_entries(),m_entryMap()
+	,m_maxDocno(0),m_nofDocuments(0)
+	,m_nofHits(0),m_nofMisses(0),m_nofEvictions(0),m_nofInvalidations(0)
+{}
+
+std::string QueryResultCache::key( const std::string& querysource, std::size_t firstRank, std::size_t nofRanks, const std::string& username)
+{
+	std::string rt( strus::string_format( "%u %u ", (unsigned int)firstRank, (unsigned int)nofRanks));
+	rt.append( username);
+	rt.push_back( '\n');
+
+	char quote = 0;
+	bool space = false;
+	std::string::const_iterator si = querysource.begin(), se = querysource.end();
+	for (; si != se; ++si)
+	{
+		if (quote)
+		{
+			rt.push_back( *si);
+			if (*si == '\\' && si+1 != se)
+			{
+				rt.push_back( *++si);
+			}
+			else if (*si == quote)
+			{
+				quote = 0;
+			}
+		}
+		else if ((unsigned char)*si <= 32)
+		{
+			space = true;
+		}
+		else
+		{
+			// Whitespace sequences are collapsed to one space, leading and trailing whitespace is dropped:
+			if (space && rt[ rt.size()-1] != '\n') rt.push_back( ' ');
+			space = false;
+			rt.push_back( *si);
+			if (*si == '\'' || *si == '"') quote = *si;
+		}
+	}
+	return rt;
+}
+
+void QueryResultCache::checkRevision( Index maxDocno, Index nofDocuments)
+{
+	strus::scoped_lock lock( m_mutex);
+	if (maxDocno != m_maxDocno || nofDocuments != m_nofDocuments)
+	{
+		if (!m_entries.empty()) ++m_nofInvalidations;
+		m_entries.clear();
+		m_entryMap.clear();
+		m_maxDocno = maxDocno;
+		m_nofDocuments = nofDocuments;
+	}
+}
+
+bool QueryResultCache::get( const std::string& key, std::string& result)
+{
+	strus::scoped_lock lock( m_mutex);
+	EntryMap::iterator mi = m_entryMap.find( key);
+	if (mi == m_entryMap.end())
+	{
+		++m_nofMisses;
+		return false;
+	}
+	++m_nofHits;
+	m_entries.splice( m_entries.begin(), m_entries, mi->second);
+	result = mi->second->result;
+	return true;
+}
+
+void QueryResultCache::put( const std::string& key, const std::string& result)
+{
+	strus::scoped_lock lock( m_mutex);
+	EntryMap::iterator mi = m_entryMap.find( key);
+	if (mi != m_entryMap.end())
+	{
+		// Inserted by another thread evaluating the same query:
+		m_entries.splice( m_entries.begin(), m_entries, mi->second);
+		return;
+	}
+	m_entries.push_front( Entry( key, result));
+	m_entryMap[ key] = m_entries.begin();
+	if (m_entryMap.size() > m_maxNofEntries)
+	{
+		m_entryMap.erase( m_entries.back().key);
+		m_entries.pop_back();
+		++m_nofEvictions;
+	}
+}
+
+void QueryResultCache::printStatistics( std::ostream& out) const
+{
+	strus::scoped_lock lock( m_mutex);
+	unsigned int nofLookups = m_nofHits + m_nofMisses;
+	double hitRate = nofLookups ? (double)m_nofHits / nofLookups : 0.0;
+	out << strus::string_format( _TXT("query result cache: %u hits, %u misses (hit rate %.4f), %u evictions, %u invalidations"),
+					m_nofHits, m_nofMisses, hitRate, m_nofEvictions, m_nofInvalidations) << std::endl;
+}
+
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_RESULT_CACHE_HPP_INCLUDED
+#define _STRUS_QUERY_RESULT_CACHE_HPP_INCLUDED
+#include "strus/storage/index.hpp"
+#include "strus/base/thread.hpp"
+#include <map>
+#include <list>
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Cache of the printed results of queries with least recently used eviction
+/// \note Thread safe. All entries are dropped if the storage revision changes
+class QueryResultCache
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofEntries_ maximum number of query results cached
+	explicit QueryResultCache( std::size_t maxNofEntries_);
+
+	/// \brief Get the key of a query result
+	/// \param[in] querysource source of the query, normalized for the key by trimming and collapsing whitespace sequences outside of quoted strings
+	/// \param[in] firstRank index of the first rank returned
+	/// \param[in] nofRanks maximum number of ranks returned
+	/// \param[in] username user name for the access restriction of the query, empty if none
+	static std::string key( const std::string& querysource, std::size_t firstRank, std::size_t nofRanks, const std::string& username);
+
+	/// \brief Drop all entries if the storage has changed since the last call
+	/// \param[in] maxDocno maximum document number of the storage
+	/// \param[in] nofDocuments number of documents inserted into the storage
+	/// \note The revision of the storage is identified by the maximum document number and the number of documents inserted
+	void checkRevision( Index maxDocno, Index nofDocuments);
+
+	/// \brief Get a cached result and mark it as most recently used
+	/// \param[in] key key of the query as returned by key(..)
+	/// \param[out] result the result cached
+	/// \return true if found
+	bool get( const std::string& key, std::string& result);
+
+	/// \brief Insert a result, evicting the least recently used entry if the cache is full
+	/// \param[in] key key of the query as returned by key(..)
+	/// \param[in] result the result to cache
+	void put( const std::string& key, const std::string& result);
+
+	/// \brief Print the hit and miss statistics
+	void printStatistics( std::ostream& out) const;
+
+private:
+	struct Entry
+	{
+		std::string key;
+		std::string result;
+
+		Entry( const std::string& key_, const std::string& result_)
+			:key(key_),result(result_){}
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string,EntryList::iterator> EntryMap;
+
+	std::size_t m_maxNofEntries;
+	EntryList m_entries;			///< entries ordered from the most recently to the least recently used
+	EntryMap m_entryMap;			///< map of the keys to the entries
+	Index m_maxDocno;			///< maximum document number of the storage revision cached
+	Index m_nofDocuments;			///< number of documents of the storage revision cached
+	unsigned int m_nofHits;
+	unsigned int m_nofMisses;
+	unsigned int m_nofEvictions;
+	unsigned int m_nofInvalidations;
+	mutable strus::mutex m_mutex;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryServer.hpp"
+#include "queryEvaluator.hpp"
+#include "queryLatencyStatistics.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace strus;
+
+static void stripLine( std::string& line)
+{
+	if (!line.empty() && line[ line.size()-1] == '\r') line.resize( line.size()-1);
+}
+
+static bool isEmptyLine( const std::string& line)
+{
+	std::string::const_iterator li = line.begin(), le = line.end();
+	for (; li != le; ++li)
+	{
+		if ((unsigned char)*li > 32) return false;
+	}
+	return true;
+}
+
+std::string QueryServer::answer( const std::string& line)
+{
+	std::ostringstream out;
+	++m_nofQueries;
+	try
+	{
+		QueryTiming timing;
+		m_evaluator->evaluate( out, line, m_statistics ? &timing : 0);
+		if (m_statistics) m_statistics->add( timing, line);
+	}
+	catch (const std::bad_alloc&)
+	{
+		++m_nofErrors;
+		out.str( std::string());
+		out << _TXT("ERROR ") << _TXT("out of memory") << std::endl;
+	}
+	catch (const std::exception& err)
+	{
+		++m_nofErrors;
+		// The answer of a failed query is a single line, the result printed before the error is dropped:
+		std::string msg( err.what());
+		std::string::iterator mi = msg.begin(), me = msg.end();
+		for (; mi != me; ++mi) if (*mi == '\n' || *mi == '\r') *mi = ' ';
+		out.str( std::string());
+		out << _TXT("ERROR ") << msg << std::endl;
+	}
+	if (m_errorhnd->hasError())
+	{
+		(void)m_errorhnd->fetchError();
+	}
+	out << "." << std::endl;
+	return out.str();
+}
+
+void QueryServer::runStdin()
+{
+	std::string line;
+	while (std::getline( std::cin, line))
+	{
+		stripLine( line);
+		if (isEmptyLine( line)) continue;
+		std::cout << answer( line) << std::flush;
+	}
+}
+
+static bool writeAll( int fd, const std::string& content)
+{
+	const char* ptr = content.c_str();
+	std::size_t size = content.size();
+	while (size)
+	{
+		ssize_t nn = ::write( fd, ptr, size);
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+		ptr += nn;
+		size -= nn;
+	}
+	return true;
+}
+
+static volatile sig_atomic_t g_stopRequested = 0;
+static int g_stopPipe[2] = {-1,-1};
+
+static void stopSignalHandler( int)
+{
+	g_stopRequested = 1;
+	if (g_stopPipe[1] >= 0)
+	{
+		// Wake up the server waiting in poll:
+		char ch = 0;
+		ssize_t nn = ::write( g_stopPipe[1], &ch, 1);
+		(void)nn;
+	}
+}
+
+/// \brief Handler of SIGINT and SIGTERM stopping the socket server, installed for the lifetime of this object
+class StopSignalScope
+{
+public:
+	StopSignalScope()
+	{
+		g_stopRequested = 0;
+		if (::pipe( g_stopPipe) != 0)
+		{
+			throw strus::runtime_error(_TXT("failed to create pipe for signal handling: %s"), ::strerror(errno));
+		}
+		(void)::fcntl( g_stopPipe[1], F_SETFL, ::fcntl( g_stopPipe[1], F_GETFL) | O_NONBLOCK);
+
+		struct sigaction act;
+		std::memset( &act, 0, sizeof(act));
+		act.sa_handler = &stopSignalHandler;
+		sigemptyset( &act.sa_mask);
+		act.sa_flags = 0;
+		::sigaction( SIGINT, &act, &m_oldIntAction);
+		::sigaction( SIGTERM, &act, &m_oldTermAction);
+	}
+	~StopSignalScope()
+	{
+		::sigaction( SIGINT, &m_oldIntAction, NULL);
+		::sigaction( SIGTERM, &m_oldTermAction, NULL);
+		::close( g_stopPipe[0]);
+		::close( g_stopPipe[1]);
+		g_stopPipe[0] = -1;
+		g_stopPipe[1] = -1;
+	}
+
+private:
+	struct sigaction m_oldIntAction;
+	struct sigaction m_oldTermAction;
+};
+
+/// \brief Listening socket, closed and its file removed when leaving the scope
+class ListenSocketScope
+{
+public:
+	ListenSocketScope( int fd_, const std::string& path_)
+		:m_fd(fd_),m_path(path_){}
+	~ListenSocketScope()
+	{
+		::close( m_fd);
+		(void)::unlink( m_path.c_str());
+	}
+
+private:
+	int m_fd;
+	std::string m_path;
+};
+
+/// \brief Wait till a file descriptor is readable or the server is stopped
+/// \return true if readable, false if stopped
+static bool waitReadable( int fd)
+{
+	for (;;)
+	{
+		if (g_stopRequested) return false;
+		struct pollfd fds[2];
+		fds[0].fd = fd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		fds[1].fd = g_stopPipe[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+		int nn = ::poll( fds, g_stopPipe[0] >= 0 ? 2 : 1, -1);
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			throw strus::runtime_error(_TXT("failed to wait for input: %s"), ::strerror(errno));
+		}
+		if (g_stopRequested || fds[1].revents) return false;
+		if (fds[0].revents) return true;
+	}
+}
+
+/// \brief Remove a file left over from a previous run of the server at the path of the socket
+/// \note A socket is only removed if nobody is listening on it anymore, otherwise we would steal the path of a running server
+static void removeStaleSocket( const std::string& path, const struct sockaddr_un& addr)
+{
+	struct stat st;
+	if (::lstat( path.c_str(), &st) != 0)
+	{
+		if (errno == ENOENT) return;
+		throw strus::runtime_error(_TXT("failed to stat socket path '%s': %s"), path.c_str(), ::strerror(errno));
+	}
+	if (!S_ISSOCK( st.st_mode))
+	{
+		throw strus::runtime_error(_TXT("file '%s' exists and is not a socket"), path.c_str());
+	}
+	int probefd = ::socket( AF_UNIX, SOCK_STREAM, 0);
+	if (probefd < 0) throw strus::runtime_error(_TXT("failed to create socket: %s"), ::strerror(errno));
+	int ec = (::connect( probefd, (const struct sockaddr*)&addr, sizeof(addr)) == 0) ? 0 : errno;
+	::close( probefd);
+	if (ec == 0)
+	{
+		throw strus::runtime_error(_TXT("socket '%s' in use by another server"), path.c_str());
+	}
+	if (ec != ECONNREFUSED)
+	{
+		throw strus::runtime_error(_TXT("socket '%s' in use or not accessible: %s"), path.c_str(), ::strerror(ec));
+	}
+	if (::unlink( path.c_str()) != 0)
+	{
+		throw strus::runtime_error(_TXT("failed to remove stale socket '%s': %s"), path.c_str(), ::strerror(errno));
+	}
+}
+
+void QueryServer::serveConnection( int fd)
+{
+	std::string buf;
+	char chunk[ 4096];
+	for (;;)
+	{
+		std::size_t eolpos;
+		while ((eolpos = buf.find( '\n')) != std::string::npos)
+		{
+			std::string line( buf, 0, eolpos);
+			buf.erase( 0, eolpos+1);
+			stripLine( line);
+			if (isEmptyLine( line)) continue;
+			if (!writeAll( fd, answer( line))) return;
+		}
+		if (!waitReadable( fd)) return;
+		ssize_t nn = ::read( fd, chunk, sizeof(chunk));
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			return;
+		}
+		if (nn == 0)
+		{
+			// Connection closed, a last line without end of line is a query too:
+			stripLine( buf);
+			if (!isEmptyLine( buf)) (void)writeAll( fd, answer( buf));
+			return;
+		}
+		buf.append( chunk, nn);
+	}
+}
+
+void QueryServer::runSocket( const std::string& path)
+{
+	struct sockaddr_un addr;
+	std::memset( &addr, 0, sizeof(addr));
+	if (path.size() >= sizeof(addr.sun_path))
+	{
+		throw strus::runtime_error(_TXT("socket path '%s' too long"), path.c_str());
+	}
+	addr.sun_family = AF_UNIX;
+	std::memcpy( addr.sun_path, path.c_str(), path.size());
+
+	// Do not get killed by clients closing their connection before reading the answer:
+	::signal( SIGPIPE, SIG_IGN);
+	StopSignalScope stopSignalScope;
+
+	removeStaleSocket( path, addr);
+	int listenfd = ::socket( AF_UNIX, SOCK_STREAM, 0);
+	if (listenfd < 0) throw strus::runtime_error(_TXT("failed to create socket: %s"), ::strerror(errno));
+	if (::bind( listenfd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		int ec = errno;
+		::close( listenfd);
+		throw strus::runtime_error(_TXT("failed to bind socket to '%s': %s"), path.c_str(), ::strerror(ec));
+	}
+	ListenSocketScope listenSocketScope( listenfd, path);
+	if (::listen( listenfd, 16) != 0)
+	{
+		throw strus::runtime_error(_TXT("failed to listen on socket '%s': %s"), path.c_str(), ::strerror(errno));
+	}
+	while (waitReadable( listenfd))
+	{
+		int fd = ::accept( listenfd, NULL, NULL);
+		if (fd < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) continue;
+			throw strus::runtime_error(_TXT("failed to accept connection on socket '%s': %s"), path.c_str(), ::strerror(errno));
+		}
+		serveConnection( fd);
+		::close( fd);
+	}
+}
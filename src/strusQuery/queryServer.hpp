@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERY_SERVER_HPP_INCLUDED
+#define _STRUS_QUERY_SERVER_HPP_INCLUDED
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class QueryEvaluator;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class QueryLatencyStatistics;
+
+/// \brief Resident query server answering queries with objects initialized only once
+/// \note Every non empty input line is a query. The answer of a query is its result as printed by strusQuery,
+///	or a line starting with "ERROR " if the query failed. Each answer is terminated by a line with a single dot '.'
+class QueryServer
+{
+public:
+	/// \brief Constructor
+	/// \param[in] evaluator_ evaluator of the queries
+	/// \param[in] statistics_ where to collect the latencies of the queries answered, NULL if not measured
+	/// \param[in] errorhnd_ error buffer interface
+	QueryServer( const QueryEvaluator* evaluator_, QueryLatencyStatistics* statistics_, ErrorBufferInterface* errorhnd_)
+		:m_evaluator(evaluator_),m_statistics(statistics_),m_errorhnd(errorhnd_),m_nofQueries(0),m_nofErrors(0){}
+
+	/// \brief Answer the queries read from stdin on stdout till end of file
+	void runStdin();
+
+	/// \brief Answer the queries of the connections to a local (UNIX domain) socket, one connection after the other
+	/// \param[in] path file system path of the socket, a socket file left over from a previous run is removed
+	/// \note Returns when the process receives SIGINT or SIGTERM, the socket file is removed on return
+	void runSocket( const std::string& path);
+
+	/// \brief Number of queries answered
+	unsigned int nofQueries() const		{return m_nofQueries;}
+	/// \brief Number of queries answered with an error
+	unsigned int nofErrors() const		{return m_nofErrors;}
+
+private:
+	/// \brief Get the answer of a query including the terminating line
+	std::string answer( const std::string& line);
+	void serveConnection( int fd);
+
+private:
+	const QueryEvaluator* m_evaluator;
+	QueryLatencyStatistics* m_statistics;
+	ErrorBufferInterface* m_errorhnd;
+	unsigned int m_nofQueries;
+	unsigned int m_nofErrors;
+};
+
+}//namespace
+#endif
+
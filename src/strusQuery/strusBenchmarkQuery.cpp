@@ -0,0 +1,662 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/storage_objbuild.hpp"
+#include "strus/lib/rpc_client.hpp"
+#include "strus/lib/rpc_client_socket.hpp"
+#include "strus/lib/analyzer_prgload_std.hpp"
+#include "strus/lib/storage_prgload_std.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/reference.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/rpcClientInterface.hpp"
+#include "strus/rpcClientMessagingInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/queryAnalyzerInstanceInterface.hpp"
+#include "strus/queryAnalyzerContextInterface.hpp"
+#include "strus/databaseInterface.hpp"
+#include "strus/databaseClientInterface.hpp"
+#include "strus/storageInterface.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/queryEvalInterface.hpp"
+#include "strus/queryProcessorInterface.hpp"
+#include "strus/queryInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/programOptions.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/cmdLineOpt.hpp"
+#include "strus/base/configParser.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "private/programLoader.hpp"
+#include "strus/versionStorage.hpp"
+#include "strus/versionModule.hpp"
+#include "strus/versionRpc.hpp"
+#include "strus/versionTrace.hpp"
+#include "strus/versionAnalyzer.hpp"
+#include "strus/versionBase.hpp"
+#include "private/versionUtilities.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include "private/traceUtils.hpp"
+#include "queryEvaluator.hpp"
+#include "queryBenchmarkSchedule.hpp"
+#include "queryBenchmarkProcessor.hpp"
+#include "queryBenchmarkResult.hpp"
+#include "strus/base/thread.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+static void printStorageConfigOptions( std::ostream& out, const strus::ModuleLoaderInterface* moduleLoader, const std::string& config, strus::ErrorBufferInterface* errorhnd)
+{
+	std::string configstr( config);
+	std::string dbname;
+	(void)strus::extractStringFromConfigString( dbname, configstr, "database", errorhnd);
+	if (errorhnd->hasError()) throw strus::runtime_error(_TXT("cannot evaluate database: %s"), errorhnd->fetchError());
+
+	strus::local_ptr<strus::StorageObjectBuilderInterface>
+		storageBuilder( moduleLoader->createStorageObjectBuilder());
+	if (!storageBuilder.get()) throw std::runtime_error( _TXT("failed to create storage object builder"));
+
+	const strus::DatabaseInterface* dbi = storageBuilder->getDatabase( dbname);
+	if (!dbi) throw std::runtime_error( _TXT("failed to get database interface"));
+	const strus::StorageInterface* sti = storageBuilder->getStorage();
+	if (!sti) throw std::runtime_error( _TXT("failed to get storage interface"));
+
+	strus::printIndentMultilineString(
+				out, 12, dbi->getConfigDescription(
+					strus::DatabaseInterface::CmdCreateClient), errorhnd);
+	strus::printIndentMultilineString(
+				out, 12, sti->getConfigDescription(
+					strus::StorageInterface::CmdCreateClient), errorhnd);
+}
+
+static std::string getFileArg( const std::string& filearg, strus::ModuleLoaderInterface* moduleLoader)
+{
+	std::string programFileName = filearg;
+	std::string programDir;
+	int ec;
+
+	if (strus::isExplicitPath( programFileName))
+	{
+		ec = strus::getParentPath( programFileName, programDir);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file directory from explicit path '%s': %s"), programFileName.c_str(), ::strerror(ec)); 
+		moduleLoader->addResourcePath( programDir);
+	}
+	else
+	{
+		std::string filedir;
+		std::string filenam;
+		ec = strus::getFileName( programFileName, filenam);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file name from absolute path '%s': %s"), programFileName.c_str(), ::strerror(ec)); 
+		ec = strus::getParentPath( programFileName, filedir);
+		if (ec) throw strus::runtime_error( _TXT("failed to get program file directory from absolute path '%s': %s"), programFileName.c_str(), ::strerror(ec)); 
+		programDir = filedir;
+		programFileName = filenam;
+		moduleLoader->addResourcePath( programDir);
+	}
+	return programFileName;
+}
+
+int main( int argc_, const char* argv_[])
+{
+	int rt = 0;
+	strus::DebugTraceInterface* dbgtrace = strus::createDebugTrace_standard( 2);
+	if (!dbgtrace)
+	{
+		std::cerr << _TXT("failed to create debug trace") << std::endl;
+		return -1;
+	}
+	strus::local_ptr<strus::ErrorBufferInterface> errorBuffer( strus::createErrorBuffer_standard( 0, 2, dbgtrace/*passed with ownership*/));
+	if (!errorBuffer.get())
+	{
+		delete dbgtrace;
+		std::cerr << _TXT("failed to create error buffer") << std::endl;
+		return -1;
+	}
+	try
+	{
+		bool printUsageAndExit = false;
+
+		strus::ProgramOptions opt(
+				errorBuffer.get(), argc_, argv_, 24,
+				"h,help", "v,version", "license",
+				"G,debug:", "u,user:", "N,nofranks:",
+				"m,module:", "M,moduledir:", "R,resourcedir:",
+				"s,storage:", "S,configfile:", "r,rpc:", "T,trace:",
+				"t,threads:", "rate:", "poisson", "n,repeat:", "w,warmup:",
+				"O,outliers:", "o,output:", "c,compare:", "threshold:", "plancache:", "q,quiet");
+		if (errorBuffer->hasError())
+		{
+			throw strus::runtime_error(_TXT("failed to parse program arguments"));
+		}
+		if (opt( "help")) printUsageAndExit = true;
+
+		int nofThreads = 1;
+		if (opt("threads"))
+		{
+			nofThreads = opt.asUint( "threads");
+			if (nofThreads == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--threads");
+		}
+		if (!errorBuffer->setMaxNofThreads( nofThreads+2))
+		{
+			std::cerr << _TXT("failed to set number of threads for error buffer (option --threads)") << std::endl;
+			return -1;
+		}
+
+		strus::local_ptr<strus::ModuleLoaderInterface> moduleLoader( strus::createModuleLoader( errorBuffer.get()));
+		if (!moduleLoader.get()) throw std::runtime_error( _TXT("failed to create module loader"));
+		if (opt("moduledir"))
+		{
+			if (opt("rpc")) throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), "--moduledir", "--rpc");
+			std::vector<std::string> modirlist( opt.list("moduledir"));
+			std::vector<std::string>::const_iterator mi = modirlist.begin(), me = modirlist.end();
+			for (; mi != me; ++mi)
+			{
+				moduleLoader->addModulePath( *mi);
+			}
+			moduleLoader->addSystemModulePath();
+		}
+		if (opt("module"))
+		{
+			if (opt("rpc")) throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), "--module", "--rpc");
+			std::vector<std::string> modlist( opt.list("module"));
+			std::vector<std::string>::const_iterator mi = modlist.begin(), me = modlist.end();
+			for (; mi != me; ++mi)
+			{
+				if (!moduleLoader->loadModule( *mi))
+				{
+					throw strus::runtime_error(_TXT("error failed to load module %s"), mi->c_str());
+				}
+			}
+		}
+		if (opt("license"))
+		{
+			std::vector<std::string> licenses_3rdParty = moduleLoader->get3rdPartyLicenseTexts();
+			std::vector<std::string>::const_iterator ti = licenses_3rdParty.begin(), te = licenses_3rdParty.end();
+			if (ti != te) std::cout << _TXT("3rd party licenses:") << std::endl;
+			for (; ti != te; ++ti)
+			{
+				std::cout << *ti << std::endl;
+			}
+			std::cout << std::endl;
+			if (!printUsageAndExit) return 0;
+		}
+		if (opt( "version"))
+		{
+			std::cout << _TXT("Strus utilities version ") << STRUS_UTILITIES_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus module version ") << STRUS_MODULE_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus rpc version ") << STRUS_RPC_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus trace version ") << STRUS_TRACE_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus analyzer version ") << STRUS_ANALYZER_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus storage version ") << STRUS_STORAGE_VERSION_STRING << std::endl;
+			std::cout << _TXT("Strus base version ") << STRUS_BASE_VERSION_STRING << std::endl;
+			std::vector<std::string> versions_3rdParty = moduleLoader->get3rdPartyVersionTexts();
+			std::vector<std::string>::const_iterator vi = versions_3rdParty.begin(), ve = versions_3rdParty.end();
+			if (vi != ve) std::cout << _TXT("3rd party versions:") << std::endl;
+			for (; vi != ve; ++vi)
+			{
+				std::cout << *vi << std::endl;
+			}
+			if (!printUsageAndExit) return 0;
+		}
+		else if (!printUsageAndExit)
+		{
+			if (opt.nofargs() > 3)
+			{
+				std::cerr << _TXT("too many arguments") << std::endl;
+				printUsageAndExit = true;
+				rt = 1;
+			}
+			if (opt.nofargs() < 3)
+			{
+				std::cerr << _TXT("too few arguments") << std::endl;
+				printUsageAndExit = true;
+				rt = 2;
+			}
+		}
+		if (printUsageAndExit)
+		{
+			std::cout << _TXT("usage:") << " strusBenchmarkQuery [options] <anprg> <qeprg> <queries>" << std::endl;
+			std::cout << "<anprg>   = " << _TXT("path of query analyzer program") << std::endl;
+			std::cout << "<qeprg>   = " << _TXT("path of query eval program") << std::endl;
+			std::cout << "<queries> = " << _TXT("file with the queries to replay or '-' for stdin") << std::endl;
+			std::cout << "            " << _TXT("(queries separated by a line with a single dot '.' like for strusQuery -F)") << std::endl;
+			std::cout << _TXT("description: Replays a list of queries against a storage and reports") << std::endl;
+			std::cout << "             " << _TXT("the throughput, the latency percentiles and the slowest queries.") << std::endl;
+			std::cout << "             " << _TXT("Compares the result with the result of a previous run saved with -o.") << std::endl;
+			std::cout << "             " << _TXT("The exit code is 4 if the evaluation of a query failed and 3 if a") << std::endl;
+			std::cout << "             " << _TXT("regression against the baseline is detected.") << std::endl;
+			std::cout << _TXT("options:") << std::endl;
+			std::cout << "-h|--help" << std::endl;
+			std::cout << "    " << _TXT("Print this usage and do nothing else") << std::endl;
+			std::cout << "-v|--version" << std::endl;
+			std::cout << "    " << _TXT("Print the program version and do nothing else") << std::endl;
+			std::cout << "--license" << std::endl;
+			std::cout << "    " << _TXT("Print 3rd party licences requiring reference") << std::endl;
+			std::cout << "-s|--storage <CONFIG>" << std::endl;
+			std::cout << "    " << _TXT("Define the storage configuration string as <CONFIG>") << std::endl;
+			if (!opt("rpc"))
+			{
+				std::cout << _TXT("    <CONFIG> is a semicolon ';' separated list of assignments:") << std::endl;
+				printStorageConfigOptions( std::cout, moduleLoader.get(), (opt("storage")?opt["storage"]:""), errorBuffer.get());
+			}
+			std::cout << "-S|--configfile <FILENAME>" << std::endl;
+			std::cout << "    " << _TXT("Define the storage configuration file as <FILENAME>") << std::endl;
+			std::cout << "    " << _TXT("<FILENAME> is a file containing the configuration string") << std::endl;
+			std::cout << "-u|--user <NAME>" << std::endl;
+			std::cout << "    " << _TXT("Use user name <NAME> for the queries") << std::endl;
+			std::cout << "-N|--nofranks <N>" << std::endl;
+			std::cout << "    " << _TXT("Evaluate maximum <N> ranks per query (default 20)") << std::endl;
+			std::cout << "-t|--threads <N>" << std::endl;
+			std::cout << "    " << _TXT("Evaluate the queries with <N> threads (default 1)") << std::endl;
+			std::cout << "--rate <QPS>" << std::endl;
+			std::cout << "    " << _TXT("Open loop: Let the queries arrive at a fixed rate of <QPS> queries") << std::endl;
+			std::cout << "    " << _TXT("per second, independent of the queries finished. The latency of a") << std::endl;
+			std::cout << "    " << _TXT("query includes the time it waits for a thread after its arrival.") << std::endl;
+			std::cout << "    " << _TXT("Without this option the queries are evaluated in a closed loop, every") << std::endl;
+			std::cout << "    " << _TXT("thread evaluates the next query as soon as it is finished.") << std::endl;
+			std::cout << "--poisson" << std::endl;
+			std::cout << "    " << _TXT("Let the queries arrive with exponentially distributed intervals") << std::endl;
+			std::cout << "    " << _TXT("with the mean rate specified with --rate (Poisson process)") << std::endl;
+			std::cout << "-n|--repeat <N>" << std::endl;
+			std::cout << "    " << _TXT("Replay the list of queries <N> times (default 1)") << std::endl;
+			std::cout << "-w|--warmup <N>" << std::endl;
+			std::cout << "    " << _TXT("Evaluate the first <N> queries before the measurement without") << std::endl;
+			std::cout << "    " << _TXT("measuring them (default 0)") << std::endl;
+			std::cout << "-O|--outliers <N>" << std::endl;
+			std::cout << "    " << _TXT("List the <N> slowest queries (default 10)") << std::endl;
+			std::cout << "-o|--output <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Save the result of the run to <FILE> for a later comparison") << std::endl;
+			std::cout << "-c|--compare <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Compare the result with the result of a previous run saved in <FILE>") << std::endl;
+			std::cout << "--threshold <PERCENT>" << std::endl;
+			std::cout << "    " << _TXT("Report a regression if the throughput, the mean or the p99 latency") << std::endl;
+			std::cout << "    " << _TXT("is worse than the baseline by more than <PERCENT> (default 10)") << std::endl;
+			std::cout << "-q|--quiet" << std::endl;
+			std::cout << "    " << _TXT("Print only the number of queries evaluated and failed instead of the") << std::endl;
+			std::cout << "    " << _TXT("report and the comparison with the baseline") << std::endl;
+			std::cout << "--plancache <N>" << std::endl;
+			std::cout << "    " << _TXT("Cache the parsed structure of the last <N> distinct queries loaded") << std::endl;
+			std::cout << "-G|--debug <COMP>" << std::endl;
+			std::cout << "    " << _TXT("Print debug messages for component <COMP> to stderr") << std::endl;
+			std::cout << "-m|--module <MOD>" << std::endl;
+			std::cout << "    " << _TXT("Load components from module <MOD>") << std::endl;
+			std::cout << "-M|--moduledir <DIR>" << std::endl;
+			std::cout << "    " << _TXT("Search modules to load first in <DIR>") << std::endl;
+			std::cout << "-R|--resourcedir <DIR>" << std::endl;
+			std::cout << "    " << _TXT("Search resource files for analyzer first in <DIR>") << std::endl;
+			std::cout << "-r|--rpc <ADDR>" << std::endl;
+			std::cout << "    " << _TXT("Execute the command on the RPC server specified by <ADDR>") << std::endl;
+			std::cout << "-T|--trace <CONFIG>" << std::endl;
+			std::cout << "    " << _TXT("Print method call traces configured with <CONFIG>") << std::endl;
+			std::cout << "    " << strus::string_format( _TXT("Example: %s"), "-T \"log=dump;file=stdout\"") << std::endl;
+			return rt;
+		}
+		// Parse arguments:
+		std::string username;
+		std::size_t nofRanks = 20;
+		std::string storagecfg;
+		double rate = 0.0;
+		std::size_t nofRepeats = 1;
+		std::size_t nofWarmup = 0;
+		std::size_t nofOutliers = 10;
+		double threshold = 0.1;
+		std::size_t planCacheSize = 0;
+		std::string outputfile;
+		std::string comparefile;
+
+		if (opt("user"))
+		{
+			username = opt[ "user"];
+		}
+		if (opt("nofranks"))
+		{
+			nofRanks = opt.asUint( "nofranks");
+		}
+		if (opt("rate"))
+		{
+			rate = opt.asDouble( "rate");
+			if (rate <= 0.0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--rate");
+		}
+		if (opt("poisson") && !opt("rate"))
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--poisson", "--rate");
+		}
+		if (opt("repeat"))
+		{
+			nofRepeats = opt.asUint( "repeat");
+			if (nofRepeats == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--repeat");
+		}
+		if (opt("warmup"))
+		{
+			nofWarmup = opt.asUint( "warmup");
+		}
+		if (opt("outliers"))
+		{
+			nofOutliers = opt.asUint( "outliers");
+		}
+		if (opt("output"))
+		{
+			outputfile = opt[ "output"];
+		}
+		if (opt("compare"))
+		{
+			comparefile = opt[ "compare"];
+		}
+		if (opt("threshold"))
+		{
+			if (!opt("compare")) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--threshold", "--compare");
+			threshold = opt.asDouble( "threshold") / 100.0;
+			if (threshold < 0.0) throw strus::runtime_error(_TXT("value of option %s must not be negative"), "--threshold");
+		}
+		if (opt("plancache"))
+		{
+			planCacheSize = opt.asUint( "plancache");
+			if (planCacheSize == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--plancache");
+		}
+		if (opt("configfile"))
+		{
+			if (opt("storage")) throw strus::runtime_error(_TXT("conflicting configuration options specified: '%s' and '%s'"), "--storage", "--configfile");
+			std::string configfile = opt[ "configfile"];
+			int ec = strus::readFile( configfile, storagecfg);
+			if (ec) throw strus::runtime_error(_TXT("failed to read configuration file %s (errno %u)"), configfile.c_str(), ec);
+
+			std::string::iterator di = storagecfg.begin(), de = storagecfg.end();
+			for (; di != de; ++di)
+			{
+				if ((unsigned char)*di < 32) *di = ' ';
+			}
+		}
+		if (opt("storage"))
+		{
+			if (opt("configfile")) throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), "--storage", "--configfile");
+			storagecfg = opt["storage"];
+		}
+
+		// Declare trace proxy objects:
+		typedef strus::Reference<strus::TraceProxy> TraceReference;
+		std::vector<TraceReference> trace;
+		if (opt("trace"))
+		{
+			std::vector<std::string> tracecfglist( opt.list("trace"));
+			std::vector<std::string>::const_iterator ti = tracecfglist.begin(), te = tracecfglist.end();
+			for (; ti != te; ++ti)
+			{
+				trace.push_back( new strus::TraceProxy( moduleLoader.get(), *ti, errorBuffer.get()));
+			}
+		}
+		// Enable debugging selected with option 'debug':
+		{
+			std::vector<std::string> dbglist = opt.list( "debug");
+			std::vector<std::string>::const_iterator gi = dbglist.begin(), ge = dbglist.end();
+			for (; gi != ge; ++gi)
+			{
+				if (!dbgtrace->enable( *gi))
+				{
+					throw strus::runtime_error(_TXT("failed to enable debug '%s'"), gi->c_str());
+				}
+			}
+		}
+		// Set paths for locating resources:
+		if (opt("resourcedir"))
+		{
+			std::vector<std::string> pathlist( opt.list("resourcedir"));
+			std::vector<std::string>::const_iterator
+				pi = pathlist.begin(), pe = pathlist.end();
+			for (; pi != pe; ++pi)
+			{
+				moduleLoader->addResourcePath( *pi);
+			}
+		}
+		std::string analyzerprg = getFileArg( opt[0], moduleLoader.get());
+		std::string queryprg = getFileArg( opt[1], moduleLoader.get());
+		std::string queryfile = opt[2];
+
+		if (errorBuffer->hasError())
+		{
+			throw std::runtime_error( _TXT("error in initialization"));
+		}
+
+		// Load the baseline first, not to run the benchmark for nothing if it cannot be read:
+		strus::QueryBenchmarkResult baseline;
+		if (!comparefile.empty())
+		{
+			baseline.load( comparefile);
+		}
+
+		// Create objects for query evaluation:
+		strus::local_ptr<strus::RpcClientMessagingInterface> messaging;
+		strus::local_ptr<strus::RpcClientInterface> rpcClient;
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> analyzerBuilder;
+		strus::local_ptr<strus::StorageObjectBuilderInterface> storageBuilder;
+		if (opt("rpc"))
+		{
+			messaging.reset( strus::createRpcClientMessaging( opt[ "rpc"], errorBuffer.get()));
+			if (!messaging.get()) throw std::runtime_error( _TXT("failed to create rpc client messaging"));
+			rpcClient.reset( strus::createRpcClient( messaging.get(), errorBuffer.get()));
+			if (!rpcClient.get()) throw std::runtime_error( _TXT("failed to create rpc client"));
+			(void)messaging.release();
+			analyzerBuilder.reset( rpcClient->createAnalyzerObjectBuilder());
+			if (!analyzerBuilder.get()) throw std::runtime_error( _TXT("failed to create rpc analyzer object builder"));
+			storageBuilder.reset( rpcClient->createStorageObjectBuilder());
+			if (!storageBuilder.get()) throw std::runtime_error( _TXT("failed to create rpc storage object builder"));
+		}
+		else
+		{
+			analyzerBuilder.reset( moduleLoader->createAnalyzerObjectBuilder());
+			if (!analyzerBuilder.get()) throw std::runtime_error( _TXT("failed to create analyzer object builder"));
+			storageBuilder.reset( moduleLoader->createStorageObjectBuilder());
+			if (!storageBuilder.get()) throw std::runtime_error( _TXT("failed to create storage object builder"));
+		}
+
+		// Create proxy objects if tracing enabled:
+		std::vector<TraceReference>::const_iterator ti = trace.begin(), te = trace.end();
+		for (; ti != te; ++ti)
+		{
+			strus::AnalyzerObjectBuilderInterface* aproxy = (*ti)->createProxy( analyzerBuilder.get());
+			analyzerBuilder.release();
+			analyzerBuilder.reset( aproxy);
+			strus::StorageObjectBuilderInterface* sproxy = (*ti)->createProxy( storageBuilder.get());
+			storageBuilder.release();
+			storageBuilder.reset( sproxy);
+		}
+
+		// Create objects:
+		strus::local_ptr<strus::StorageClientInterface>
+			storage( strus::createStorageClient( storageBuilder.get(), errorBuffer.get(), storagecfg));
+		if (!storage.get()) throw strus::runtime_error(_TXT("failed to create storage client: %s"), errorBuffer->fetchError());
+
+		strus::local_ptr<strus::QueryAnalyzerInstanceInterface> analyzer( analyzerBuilder->createQueryAnalyzer());
+		if (!analyzer.get()) throw strus::runtime_error(_TXT("failed to create query analyzer: %s"), errorBuffer->fetchError());
+
+		strus::local_ptr<strus::QueryEvalInterface> qeval( storageBuilder->createQueryEval());
+		if (!qeval.get()) throw strus::runtime_error(_TXT("failed to create query evaluation interface: %s"), errorBuffer->fetchError());
+
+		const strus::QueryProcessorInterface* qproc = storageBuilder->getQueryProcessor();
+		if (!qproc) throw strus::runtime_error(_TXT("failed to get query processor: %s"), errorBuffer->fetchError());
+		const strus::TextProcessorInterface* textproc = analyzerBuilder->getTextProcessor();
+		if (!textproc) throw strus::runtime_error(_TXT("failed to get text processor: %s"), errorBuffer->fetchError());
+		if (errorBuffer->hasError()) throw strus::runtime_error(_TXT("error in initialization: %s"), errorBuffer->fetchError());
+
+		// Load query analyzer program:
+		if (!strus::load_QueryAnalyzer_programfile_std( analyzer.get(), textproc, analyzerprg, errorBuffer.get()))
+		{
+			throw strus::runtime_error(_TXT("failed to load query analyzer program: %s"), errorBuffer->fetchError());
+		}
+		// Load query evaluation program:
+		std::string qevalProgramSource;
+		std::string queryprgpath = strus::isExplicitPath( queryprg) ? queryprg : textproc->getResourceFilePath( queryprg);
+
+		int ec = strus::readFile( queryprgpath, qevalProgramSource);
+		if (ec) throw strus::runtime_error(_TXT("failed to load query eval program %s (errno %u)"), queryprg.c_str(), ec);
+
+		if (!strus::load_queryeval_program( *qeval, analyzer->queryTermTypes(), qproc, qevalProgramSource, errorBuffer.get()))
+		{
+			throw strus::runtime_error(_TXT("failed to load query evaluation program: %s"), errorBuffer->fetchError());
+		}
+		strus::local_ptr<strus::QueryPlanCacheInterface> planCache;
+		if (planCacheSize)
+		{
+			planCache.reset( strus::createQueryPlanCache( planCacheSize, errorBuffer.get()));
+			if (!planCache.get()) throw strus::runtime_error(_TXT("failed to create query plan cache: %s"), errorBuffer->fetchError());
+		}
+		// Results are not printed, the time measured is the time spent for loading and evaluating the queries:
+		strus::QueryEvaluator evaluator(
+				storage.get(), analyzer.get(), qeval.get(), qproc,
+				username, 0/*firstRank*/, nofRanks, true/*quiet*/, false/*verbose*/, 0/*result cache*/, planCache.get(), errorBuffer.get());
+
+		// Load the queries:
+		std::string querysource;
+		if (queryfile == "-")
+		{
+			ec = strus::readStdin( querysource);
+			if (ec) throw strus::runtime_error( _TXT("failed to read queries from stdin (errno %u)"), ec);
+		}
+		else
+		{
+			ec = strus::readFile( queryfile, querysource);
+			if (ec) throw strus::runtime_error(_TXT("failed to read queries from file %s (errno %u)"), queryfile.c_str(), ec);
+		}
+		std::vector<std::string> queries;
+		{
+			std::string::const_iterator si = querysource.begin(), se = querysource.end();
+			std::string qs;
+			while (strus::scanNextProgram( qs, si, se, errorBuffer.get()))
+			{
+				queries.push_back( qs);
+			}
+			if (errorBuffer->hasError()) throw strus::runtime_error(_TXT("failed to scan queries: %s"), errorBuffer->fetchError());
+		}
+		if (queries.empty()) throw strus::runtime_error(_TXT("no queries defined in %s"), queryfile.c_str());
+
+		// Warm up the caches of the storage:
+		for (std::size_t wi = 0; wi < nofWarmup; ++wi)
+		{
+			std::ostringstream out;
+			evaluator.evaluate( out, queries[ wi % queries.size()]);
+		}
+
+		// Run the benchmark:
+		strus::QueryBenchmarkSchedule::Arrival arrival = strus::QueryBenchmarkSchedule::ClosedLoop;
+		if (rate > 0.0)
+		{
+			arrival = opt("poisson") ? strus::QueryBenchmarkSchedule::PoissonRate : strus::QueryBenchmarkSchedule::FixedRate;
+		}
+		strus::QueryBenchmarkSchedule schedule( queries.size() * nofRepeats, arrival, rate);
+		std::vector<strus::Reference<strus::QueryBenchmarkProcessor> > processorList;
+		processorList.reserve( nofThreads);
+		for (int ti = 0; ti<nofThreads; ++ti)
+		{
+			processorList.push_back( new strus::QueryBenchmarkProcessor( &evaluator, &queries, &schedule, errorBuffer.get()));
+		}
+		double startTime = strus::QueryTiming::timestamp();
+		schedule.start();
+		{
+			std::vector<strus::Reference<strus::thread> > threadGroup;
+			for (int ti=0; ti<nofThreads; ++ti)
+			{
+				strus::QueryBenchmarkProcessor* tc = processorList[ ti].get();
+				strus::Reference<strus::thread> th( new strus::thread( &strus::QueryBenchmarkProcessor::run, tc));
+				threadGroup.push_back( th);
+			}
+			std::vector<strus::Reference<strus::thread> >::iterator
+				gi = threadGroup.begin(), ge = threadGroup.end();
+			for (; gi != ge; ++gi) (*gi)->join();
+		}
+		double duration = strus::QueryTiming::timestamp() - startTime;
+
+		std::vector<strus::QueryBenchmarkSample> samples;
+		std::vector<strus::Reference<strus::QueryBenchmarkProcessor> >::const_iterator
+			pi = processorList.begin(), pe = processorList.end();
+		for (; pi != pe; ++pi)
+		{
+			samples.insert( samples.end(), (*pi)->samples().begin(), (*pi)->samples().end());
+			if (!(*pi)->firstError().empty())
+			{
+				std::cerr << _TXT("error in query: ") << (*pi)->firstError() << std::endl;
+			}
+		}
+		strus::QueryBenchmarkResult result( queries, samples, duration, nofThreads, rate);
+		if (opt("quiet"))
+		{
+			std::cout << strus::string_format( _TXT("evaluated %u queries (%u failed)"),
+							(unsigned int)result.nofEvaluated(), (unsigned int)result.nofFailed()) << std::endl;
+		}
+		else
+		{
+			result.printReport( std::cout, nofOutliers);
+		}
+		if (planCache.get())
+		{
+			std::cout << strus::string_format( _TXT("query plan cache: %u hits, %u misses, %u bypassed"),
+							planCache->nofHits(), planCache->nofMisses(), planCache->nofBypassed()) << std::endl;
+		}
+		if (!outputfile.empty())
+		{
+			result.save( outputfile);
+		}
+		if (!comparefile.empty())
+		{
+			std::ostringstream comparison;
+			if (result.compare( opt("quiet") ? comparison : std::cout, baseline, threshold, nofOutliers))
+			{
+				rt = 3;
+			}
+		}
+		if (result.nofFailed())
+		{
+			rt = 4;
+		}
+		if (errorBuffer->hasError())
+		{
+			throw strus::runtime_error(_TXT("unhandled error in query benchmark: %s"), errorBuffer->fetchError());
+		}
+		std::cerr << _TXT("done.") << std::endl;
+		if (!dumpDebugTrace( dbgtrace, NULL/*filename ~ NULL = stderr*/))
+		{
+			std::cerr << _TXT("failed to dump debug trace to file") << std::endl;
+		}
+		return rt;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << _TXT("ERROR ") << _TXT("out of memory") << std::endl;
+		return -2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		const char* errormsg = errorBuffer->fetchError();
+		if (errormsg)
+		{
+			std::cerr << _TXT("ERROR ") << e.what() << ": " << errormsg << std::endl;
+		}
+		else
+		{
+			std::cerr << _TXT("ERROR ") << e.what() << std::endl;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << _TXT("EXCEPTION ") << e.what() << std::endl;
+	}
+	if (!dumpDebugTrace( dbgtrace, NULL/*filename ~ NULL = stderr*/))
+	{
+		std::cerr << _TXT("failed to dump debug trace to file") << std::endl;
+	}
+	return -1;
+}
+
@@ -48,6 +48,13 @@
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
+#include "queryEvaluator.hpp"
+#include "queryServer.hpp"
+#include "queryEvalProcessor.hpp"
+#include "private/orderedResultBuffer.hpp"
+#include "queryLatencyStatistics.hpp"
+#include "queryResultCache.hpp"
+#include "strus/base/thread.hpp"
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -138,17 +145,29 @@ int main( int argc_, const char* argv_[])
 		bool printUsageAndExit = false;
 
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc_, argv_, 18,
+				errorBuffer.get(), argc_, argv_, 25,
 				"h,help", "v,version", "license",
 				"G,debug:", "Q,quiet", "u,user:", "N,nofranks:", "I,firstrank:", "F,fileinput",
 				"D,time", "m,module:", "M,moduledir:", "R,resourcedir:",
-				"s,storage:", "S,configfile:", "r,rpc:", "T,trace:", "V,verbose");
+				"s,storage:", "S,configfile:", "r,rpc:", "T,trace:", "V,verbose",
+				"server", "socket:", "t,threads:", "timefile:", "cache:", "plancache:", "cachestats");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
 		}
 		if (opt( "help")) printUsageAndExit = true;
 
+		int nofThreads = 0;
+		if (opt("threads"))
+		{
+			nofThreads = opt.asUint( "threads");
+			if (!errorBuffer->setMaxNofThreads( nofThreads+2))
+			{
+				std::cerr << _TXT("failed to set number of threads for error buffer (option --threads)") << std::endl;
+				return -1;
+			}
+		}
+
 		// Enable debugging selected with option 'debug':
 		{
 			std::vector<std::string> dbglist = opt.list( "debug");
@@ -220,13 +239,15 @@ int main( int argc_, const char* argv_[])
 		}
 		else if (!printUsageAndExit)
 		{
-			if (opt.nofargs() > 3)
+			// In server mode the queries are read from stdin or the socket:
+			int nofargs = (opt("server") || opt("socket")) ? 2 : 3;
+			if (opt.nofargs() > nofargs)
 			{
 				std::cerr << _TXT("too many arguments") << std::endl;
 				printUsageAndExit = true;
 				rt = 1;
 			}
-			if (opt.nofargs() < 3)
+			if (opt.nofargs() < nofargs)
 			{
 				std::cerr << _TXT("too few arguments") << std::endl;
 				printUsageAndExit = true;
@@ -236,11 +257,13 @@ int main( int argc_, const char* argv_[])
 		if (printUsageAndExit)
 		{
 			std::cout << _TXT("usage:") << " strusQuery [options] <anprg> <qeprg> <query>" << std::endl;
+			std::cout << "       strusQuery [options] --server <anprg> <qeprg>" << std::endl;
 			std::cout << "<anprg>   = " << _TXT("path of query analyzer program") << std::endl;
 			std::cout << "<qeprg>   = " << _TXT("path of query eval program") << std::endl;
 			std::cout << "<query>    = " << _TXT("query string") << std::endl;
 			std::cout << "             " << _TXT("file or '-' for stdin if option -F is specified)") << std::endl;
 			std::cout << _TXT("description: Executes a query or a list of queries from a file.") << std::endl;
+			std::cout << "             " << _TXT("In server mode it answers queries read line by line.") << std::endl;
 			std::cout << _TXT("options:") << std::endl;
 			std::cout << "-h|--help" << std::endl;
 			std::cout << "    " << _TXT("Print this usage and do nothing else") << std::endl;
@@ -267,9 +290,33 @@ int main( int argc_, const char* argv_[])
 			std::cout << "-Q|--quiet" << std::endl;
 			std::cout << "    " << _TXT("No output of results") << std::endl;
 			std::cout << "-D|--time" << std::endl;
-			std::cout << "    " << _TXT("Do print duration of pure query evaluation") << std::endl;
+			std::cout << "    " << _TXT("Do print duration of pure query evaluation and a table of the") << std::endl;
+			std::cout << "    " << _TXT("query latency percentiles split into parsing and evaluation") << std::endl;
+			std::cout << "--timefile <FILE>" << std::endl;
+			std::cout << "    " << _TXT("Write the latency of every query to <FILE> ('-' for stderr)") << std::endl;
+			std::cout << "    " << _TXT("as JSON (one object per line) if <FILE> ends with '.json', else as CSV") << std::endl;
+			std::cout << "-t|--threads <N>" << std::endl;
+			std::cout << "    " << _TXT("Evaluate the queries with <N> threads, the results are printed") << std::endl;
+			std::cout << "    " << _TXT("in the order of the queries. Default is 0 (no threads)") << std::endl;
+			std::cout << "--cache <N>" << std::endl;
+			std::cout << "    " << _TXT("Cache the results of the last <N> distinct queries evaluated") << std::endl;
+			std::cout << "    " << _TXT("Queries are identified by their source with whitespace normalized") << std::endl;
+			std::cout << "    " << _TXT("The cache is cleared if the number of documents in the storage changes") << std::endl;
+			std::cout << "--plancache <N>" << std::endl;
+			std::cout << "    " << _TXT("Cache the parsed structure of the last <N> distinct queries loaded") << std::endl;
+			std::cout << "    " << _TXT("Queries differing only in their terms and metadata values share one entry") << std::endl;
+			std::cout << "--cachestats" << std::endl;
+			std::cout << "    " << _TXT("Print the statistics of the caches to stdout instead of stderr") << std::endl;
 			std::cout << "-F|--fileinput" << std::endl;
 			std::cout << "    " << _TXT("Interpret query argument as a file name containing the input") << std::endl;
+			std::cout << "--server" << std::endl;
+			std::cout << "    " << _TXT("Run as server answering queries read line by line from stdin") << std::endl;
+			std::cout << "    " << _TXT("Each answer is terminated by a line with a single dot '.'") << std::endl;
+			std::cout << "    " << _TXT("A query failing is answered with a line starting with 'ERROR '") << std::endl;
+			std::cout << "--socket <PATH>" << std::endl;
+			std::cout << "    " << _TXT("Run as server answering queries from connections to the") << std::endl;
+			std::cout << "    " << _TXT("local (UNIX domain) socket <PATH>, one connection after the other") << std::endl;
+			std::cout << "    " << _TXT("The server stops on SIGINT or SIGTERM and removes the socket file") << std::endl;
 			std::cout << "-G|--debug <COMP>" << std::endl;
 			std::cout << "    " << _TXT("Print debug messages for component <COMP> to stderr") << std::endl;
 			std::cout << "-m|--module <MOD>" << std::endl;
@@ -290,12 +337,17 @@ int main( int argc_, const char* argv_[])
 		// Parse arguments:
 		bool quiet = opt( "quiet");
 		bool doMeasureDuration = opt( "time");
+		std::string timefile;
 		bool verbose = opt("verbose");
 		std::string username;
 		std::size_t nofRanks = 20;
 		std::size_t firstRank = 0;
 		std::string storagecfg;
 		bool queryIsFile = opt("fileinput");
+		bool serverMode = opt("server") || opt("socket");
+		std::size_t cacheSize = 0;
+		std::size_t planCacheSize = 0;
+		std::string socketPath;
 
 		if (opt("user"))
 		{
@@ -309,6 +361,37 @@ int main( int argc_, const char* argv_[])
 		{
 			firstRank = opt.asUint( "firstrank");
 		}
+		if (opt("socket"))
+		{
+			socketPath = opt[ "socket"];
+		}
+		if (opt("cache"))
+		{
+			cacheSize = opt.asUint( "cache");
+			if (cacheSize == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--cache");
+		}
+		if (opt("plancache"))
+		{
+			planCacheSize = opt.asUint( "plancache");
+			if (planCacheSize == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--plancache");
+		}
+		if (opt("cachestats") && !opt("cache") && !opt("plancache"))
+		{
+			throw strus::runtime_error(_TXT("option %s specified without option %s"), "--cachestats", "--cache");
+		}
+		if (opt("timefile"))
+		{
+			if (!doMeasureDuration) throw strus::runtime_error(_TXT("option %s specified without option %s"), "--timefile", "--time");
+			timefile = opt[ "timefile"];
+		}
+		if (serverMode && queryIsFile)
+		{
+			throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), opt("socket") ? "--socket" : "--server", "--fileinput");
+		}
+		if (serverMode && nofThreads)
+		{
+			throw strus::runtime_error(_TXT("specified mutual exclusive options %s and %s"), opt("socket") ? "--socket" : "--server", "--threads");
+		}
 		if (opt("configfile"))
 		{
 			if (opt("storage")) throw strus::runtime_error(_TXT("conflicting configuration options specified: '%s' and '%s'"), "--storage", "--configfile");
@@ -365,7 +448,7 @@ int main( int argc_, const char* argv_[])
 		}
 		std::string analyzerprg = getFileArg( opt[0], moduleLoader.get());
 		std::string queryprg = getFileArg( opt[1], moduleLoader.get());
-		std::string querystring = opt[2];
+		std::string querystring = serverMode ? std::string() : std::string( opt[2]);
 
 		if (errorBuffer->hasError())
 		{
@@ -443,88 +526,125 @@ int main( int argc_, const char* argv_[])
 			throw strus::runtime_error(_TXT("failed to load query evaluation program: %s"), errorBuffer->fetchError());
 		}
 
-		// Load query:
-		if (queryIsFile)
+		strus::local_ptr<strus::QueryResultCache> resultCache;
+		if (cacheSize)
 		{
-			std::string qs;
-			if (querystring == "-")
-			{
-				ec = strus::readStdin( qs);
-				if (ec) throw strus::runtime_error( _TXT("failed to read query from stdin (errno %u)"), ec);
-			}
-			else
-			{
-				ec = strus::readFile( querystring, qs);
-				if (ec) throw strus::runtime_error(_TXT("failed to read query from file %s (errno %u)"), querystring.c_str(), ec);
-			}
-			querystring = qs;
+			resultCache.reset( new strus::QueryResultCache( cacheSize));
 		}
-		unsigned int nofQueries = 0;
-		double startTime = 0.0;
-		if (doMeasureDuration)
+		strus::local_ptr<strus::QueryPlanCacheInterface> planCache;
+		if (planCacheSize)
 		{
-			startTime = getTimeStamp();
+			planCache.reset( strus::createQueryPlanCache( planCacheSize, errorBuffer.get()));
+			if (!planCache.get()) throw strus::runtime_error(_TXT("failed to create query plan cache: %s"), errorBuffer->fetchError());
 		}
-		std::string::const_iterator si = querystring.begin(), se = querystring.end();
-		std::string qs;
-		while (strus::scanNextProgram( qs, si, se, errorBuffer.get()))
-		{
-			++nofQueries;
-			strus::local_ptr<strus::QueryInterface> query( qeval->createQuery( storage.get()));
-			if (!query.get()) throw strus::runtime_error(_TXT("failed to create query object: %s"), errorBuffer->fetchError());
+		strus::QueryEvaluator evaluator(
+				storage.get(), analyzer.get(), qeval.get(), qproc,
+				username, firstRank, nofRanks, quiet, verbose, resultCache.get(), planCache.get(), errorBuffer.get());
 
-			std::string selectionFeatureSet;
-			std::string weightingFeatureSet;
-			std::vector<std::string> selfset = qeval->getSelectionFeatureSets();
-			if (!selfset.empty()) selectionFeatureSet = selfset[0];
-			std::vector<std::string> weightset = qeval->getWeightingFeatureSets();
-			if (!weightset.empty()) weightingFeatureSet = weightset[0];
-
-			if (!strus::loadQuery( *query, analyzer.get(), selectionFeatureSet, weightingFeatureSet, qproc, qs, errorBuffer.get()))
+		unsigned int nofQueries = 0;
+		double startTime = 0.0;
+		strus::QueryLatencyStatistics latencyStatistics;
+		strus::QueryLatencyStatistics* statistics = doMeasureDuration ? &latencyStatistics : 0;
+		if (serverMode)
+		{
+			if (doMeasureDuration)
 			{
-				throw strus::runtime_error(_TXT("failed to load query from source: %s"), errorBuffer->fetchError());
+				startTime = getTimeStamp();
 			}
-			if (!username.empty())
+			strus::QueryServer server( &evaluator, statistics, errorBuffer.get());
+			if (socketPath.empty())
 			{
-				query->addAccess( username);
+				server.runStdin();
 			}
-			if (verbose)
+			else
 			{
-				std::cerr << "Query:" << std::endl;
-				std::cerr << query->view().tostring() << std::endl;
+				server.runSocket( socketPath);
 			}
-			strus::QueryResult result = query->evaluate( firstRank, nofRanks);
-			if (!quiet)
+			nofQueries = server.nofQueries();
+			if (server.nofErrors())
 			{
-				std::cout << strus::string_format( _TXT("evaluated till pass %u, got %u ranks (%u without restrictions applied):"), result.evaluationPass(), result.nofRanked(), result.nofVisited()) << std::endl;
-				std::cout << strus::string_format( _TXT("ranked list (starting with rank %u, maximum %u results):"), (unsigned int)firstRank, (unsigned int)nofRanks) << std::endl;
+				std::cerr << strus::string_format( _TXT("%u of %u queries failed"), server.nofErrors(), server.nofQueries()) << std::endl;
 			}
-			std::vector<strus::ResultDocument>::const_iterator wi = result.ranks().begin(), we = result.ranks().end();
-			if (!quiet)
+		}
+		else
+		{
+			// Load query:
+			if (queryIsFile)
 			{
-				for (int widx=1; wi != we; ++wi,++widx)
+				std::string qs;
+				if (querystring == "-")
 				{
-					if (wi->field().defined())
-					{
-						std::cout << strus::string_format( _TXT( "[%u] field [%d,%d] score %f"), widx, (int)wi->field().start(), (int)wi->field().end(), wi->weight()) << std::endl;
-					}
-					else
+					ec = strus::readStdin( qs);
+					if (ec) throw strus::runtime_error( _TXT("failed to read query from stdin (errno %u)"), ec);
+				}
+				else
+				{
+					ec = strus::readFile( querystring, qs);
+					if (ec) throw strus::runtime_error(_TXT("failed to read query from file %s (errno %u)"), querystring.c_str(), ec);
+				}
+				querystring = qs;
+			}
+			if (doMeasureDuration)
+			{
+				startTime = getTimeStamp();
+			}
+			std::string::const_iterator si = querystring.begin(), se = querystring.end();
+			std::string qs;
+			if (nofThreads)
+			{
+				std::vector<std::string> queries;
+				while (strus::scanNextProgram( qs, si, se, errorBuffer.get()))
+				{
+					queries.push_back( qs);
+				}
+				// Results are buffered till all queries before are printed, the number of results buffered is limited:
+				strus::utils::OrderedResultBuffer reorderBuffer( queries.size(), nofThreads * 16);
+				std::vector<strus::QueryTiming> timings( doMeasureDuration ? queries.size() : 0);
+				std::vector<strus::Reference<strus::QueryEvalProcessor> > processorList;
+				processorList.reserve( nofThreads);
+				for (int ti = 0; ti<nofThreads; ++ti)
+				{
+					processorList.push_back( new strus::QueryEvalProcessor( &evaluator, &queries, &reorderBuffer, doMeasureDuration ? &timings : 0, errorBuffer.get()));
+				}
+				std::string queryerror;
+				{
+					std::vector<strus::Reference<strus::thread> > threadGroup;
+					for (int ti=0; ti<nofThreads; ++ti)
 					{
-						std::cout << strus::string_format( _TXT( "[%u] score %f"), widx, wi->weight()) << std::endl;
+						strus::QueryEvalProcessor* tc = processorList[ ti].get();
+						strus::Reference<strus::thread> th( new strus::thread( &strus::QueryEvalProcessor::run, tc));
+						threadGroup.push_back( th);
 					}
-					std::vector<strus::SummaryElement>::const_iterator
-						ai = wi->summaryElements().begin(),
-						ae = wi->summaryElements().end();
-					for (; ai != ae; ++ai)
+					std::string result;
+					while (reorderBuffer.pop( result, queryerror))
 					{
-						std::cout << "\t" << ai->name();
-						if (ai->index() >= 0)
+						if (!queryerror.empty())
 						{
-							std::cout << "[" << ai->index() << "]";
+							// Stop at the first query failing like the evaluation without threads:
+							reorderBuffer.terminate();
+							break;
 						}
-						std::cout << " = '" << ai->value() << "'";
-						std::cout << " " << ai->weight() << std::endl;
+						if (statistics) statistics->add( timings[ nofQueries], queries[ nofQueries]);
+						++nofQueries;
+						std::cout << result;
 					}
+					std::vector<strus::Reference<strus::thread> >::iterator
+						gi = threadGroup.begin(), ge = threadGroup.end();
+					for (; gi != ge; ++gi) (*gi)->join();
+				}
+				if (!queryerror.empty())
+				{
+					throw strus::runtime_error( "%s", queryerror.c_str());
+				}
+			}
+			else
+			{
+				strus::QueryTiming timing;
+				while (strus::scanNextProgram( qs, si, se, errorBuffer.get()))
+				{
+					++nofQueries;
+					evaluator.evaluate( std::cout, qs, statistics ? &timing : 0);
+					if (statistics) statistics->add( timing, qs);
 				}
 			}
 		}
@@ -533,6 +653,21 @@ int main( int argc_, const char* argv_[])
 			double endTime = getTimeStamp();
 			double duration = endTime - startTime;
 			std::cerr << strus::string_format( _TXT("evaluated %u queries in %.4f seconds"), nofQueries, duration) << std::endl;
+			latencyStatistics.printReport( std::cerr);
+			if (!timefile.empty())
+			{
+				latencyStatistics.writeQueryTimes( timefile);
+			}
+		}
+		std::ostream& cachestatsout = opt("cachestats") ? std::cout : std::cerr;
+		if (resultCache.get())
+		{
+			resultCache->printStatistics( cachestatsout);
+		}
+		if (planCache.get())
+		{
+			cachestatsout << strus::string_format( _TXT("query plan cache: %u hits, %u misses, %u bypassed"),
+							planCache->nofHits(), planCache->nofMisses(), planCache->nofBypassed()) << std::endl;
 		}
 		if (errorBuffer->hasError())
 		{
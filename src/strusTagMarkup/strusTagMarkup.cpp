@@ -42,6 +42,7 @@
 #include "private/internationalization.hpp"
 #include "private/traceUtils.hpp"
 #include "private/parseFunctionDef.hpp"
+#include "private/documentClassCache.hpp"
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -246,6 +247,7 @@ static void writeTagMarkup(
 		const std::string& outputPath,
 		strus::FileCrawlerInterface* crawler,
 		const strus::DocumentClassDetectorInterface* dclassdetector,
+		strus::DocumentClassCache* dclassCache,
 		const strus::TextProcessorInterface* textproc,
 		const strus::analyzer::DocumentClass& dclass,
 		const std::vector<strus::DocumentTagMarkupDef>& markups,
@@ -271,7 +273,8 @@ static void writeTagMarkup(
 			}
 			else
 			{
-				if (!dclassdetector->detect( documentClass, content.c_str(), content.size(), true/*is complete*/))
+				if (!strus::getCachedDocumentClass( dclassCache, documentClass, *ai)
+				&&  !strus::detectDocumentClass( dclassCache, documentClass, *ai, dclassdetector, content.c_str(), content.size(), true/*is complete*/))
 				{
 					const char* errormsg = g_errorBuffer->fetchError();
 					if (!errormsg) errormsg = "unsupported content type";
@@ -334,6 +337,7 @@ public:
 			int threadid_,
 			strus::FileCrawlerInterface* crawler_,
 			const strus::DocumentClassDetectorInterface* dclassdetector_,
+			strus::DocumentClassCache* dclassCache_,
 			const strus::TextProcessorInterface* textproc_,
 			const strus::analyzer::DocumentClass& documentClass_,
 			const std::vector<strus::DocumentTagMarkupDef>& markups_,
@@ -342,7 +346,7 @@ public:
 			strus::ErrorBufferInterface* errorhnd_)
 		:m_errorhnd(errorhnd_)
 		,m_threadid(threadid_),m_inputPath(inputPath_),m_outputPath(outputPath_),m_crawler(crawler_)
-		,m_dclassdetector(dclassdetector_),m_textproc(textproc_),m_documentClass(documentClass_),m_markups(markups_)
+		,m_dclassdetector(dclassdetector_),m_dclassCache(dclassCache_),m_textproc(textproc_),m_documentClass(documentClass_),m_markups(markups_)
 	{
 		if (m_documentClass.defined() && m_documentClass.mimeType() != "application/xml")
 		{
@@ -354,7 +358,7 @@ public:
 	{
 		try
 		{
-			writeTagMarkup( m_inputPath, m_outputPath, m_crawler, m_dclassdetector, m_textproc, m_documentClass, m_markups, m_errorhnd);
+			writeTagMarkup( m_inputPath, m_outputPath, m_crawler, m_dclassdetector, m_dclassCache, m_textproc, m_documentClass, m_markups, m_errorhnd);
 		}
 		catch (const std::bad_alloc& err)
 		{
@@ -377,6 +381,7 @@ private:
 	std::string m_outputPath;
 	strus::FileCrawlerInterface* m_crawler;
 	const strus::DocumentClassDetectorInterface* m_dclassdetector;
+	strus::DocumentClassCache* m_dclassCache;
 	const strus::TextProcessorInterface* m_textproc;
 	strus::analyzer::DocumentClass m_documentClass;
 	std::vector<strus::DocumentTagMarkupDef> m_markups;
@@ -404,13 +409,14 @@ int main( int argc, const char* argv[])
 		bool printUsageAndExit = false;
 
 		strus::ProgramOptions opt(
-				errorBuffer.get(), argc, argv, 19,
+				errorBuffer.get(), argc, argv, 21,
 				"h,help", "v,version", "V,verbose",
 				"license", "G,debug:", "m,module:",
 				"M,moduledir:", "r,rpc:", "T,trace:", "R,resourcedir:",
 				"C,contenttype:", "x,extension:",
 				"e,expression:", "d,delete:", "a,attribute:", "k,markup:", "P,parameter:",
-				"t,threads:", "f,fetch:");
+				"t,threads:", "f,fetch:",
+				"detectcache:", "detectsample:");
 		if (errorBuffer->hasError())
 		{
 			throw strus::runtime_error(_TXT("failed to parse program arguments"));
@@ -542,6 +548,7 @@ int main( int argc, const char* argv[])
 			std::cout << "    " << _TXT("forced definition of the document class of the document processed.") << std::endl;
 			std::cout << "-x|--extension <EXT>" << std::endl;
 			std::cout << "    " << _TXT("extension of the input files processed.") << std::endl;
+			strus::printDocumentClassCacheUsage( std::cout);
 			std::cout << "-e|--expression <XPATH>" << std::endl;
 			std::cout << "    " << _TXT("Use <XPATH> as expression (abbreviated syntax of XPath)") << std::endl;
 			std::cout << "    " << _TXT("to select the tags to add attributes to.") << std::endl;
@@ -720,6 +727,9 @@ int main( int argc, const char* argv[])
 		strus::local_ptr<strus::DocumentClassDetectorInterface> documentClassDetector( analyzerBuilder->createDocumentClassDetector());
 		if (!documentClassDetector.get()) throw std::runtime_error( errorBuffer->fetchError());
 
+		// Create the cache of document classes detected if enabled:
+		strus::local_ptr<strus::DocumentClassCache> dclassCache( strus::createDocumentClassCache( opt));
+
 		// Define entity expression segmenter if selector expressions for entities are defined:
 		if (expressions.empty() && deletes.empty())
 		{
@@ -770,7 +780,7 @@ int main( int argc, const char* argv[])
 		{
 			workers.push_back(
 				new TagMarkupWorker(
-					(instanceIdx+1)/*threadid*/, fileCrawler.get(), documentClassDetector.get(),
+					(instanceIdx+1)/*threadid*/, fileCrawler.get(), documentClassDetector.get(), dclassCache.get(),
 					textproc, documentClass, markupDefInstanceAr[ instanceIdx], docpath, outputpath, g_errorBuffer));
 		}
 		if (g_errorBuffer->hasError())
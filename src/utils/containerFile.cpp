@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Splitting of container files (JSON lines files, tar archives) into records processed as documents of their own
+/// \file containerFile.cpp
+#include "private/containerFile.hpp"
+#include <cerrno>
+#include <cstring>
+#if defined _WIN32
+#define STRUS_FSEEK64 _fseeki64
+#else
+#include <sys/types.h>
+#define STRUS_FSEEK64 fseeko
+#endif
+
+using namespace strus;
+using namespace strus::utils;
+
+static bool hasExtension( const std::string& path, const char* ext)
+{
+	std::size_t extlen = std::strlen( ext);
+	if (path.size() <= extlen) return false;
+	const char* pe = path.c_str() + path.size() - extlen;
+	for (std::size_t ei=0; ei < extlen; ++ei)
+	{
+		char ch = pe[ ei];
+		if (ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+		if (ch != ext[ ei]) return false;
+	}
+	return true;
+}
+
+ContainerType strus::utils::containerFileType( const std::string& path)
+{
+	if (hasExtension( path, ".jsonl") || hasExtension( path, ".ndjson")) return ContainerJsonLines;
+	if (hasExtension( path, ".tar")) return ContainerTar;
+	return ContainerNone;
+}
+
+std::string strus::utils::containerRecordItem( const std::string& path, uint64_t offset, uint64_t size)
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "/%llu+%llu", (unsigned long long)offset, (unsigned long long)size);
+	return path + buf;
+}
+
+static bool parseUint64( uint64_t& res, char const*& si, const char* se)
+{
+	const char* start = si;
+	res = 0;
+	for (; si != se && *si >= '0' && *si <= '9'; ++si)
+	{
+		uint64_t next = res * 10 + (*si - '0');
+		if (next < res) return false;
+		res = next;
+	}
+	return si != start;
+}
+
+bool strus::utils::parseContainerRecordItem( ContainerRecord& record, const std::string& item)
+{
+	std::size_t sep = item.rfind( '/');
+	if (sep == std::string::npos || sep == 0) return false;
+	char const* si = item.c_str() + sep + 1;
+	const char* se = item.c_str() + item.size();
+	uint64_t offset;
+	uint64_t size;
+	if (!parseUint64( offset, si, se) || si == se || *si != '+') return false;
+	++si;
+	if (!parseUint64( size, si, se) || si != se) return false;
+	std::string path( item, 0, sep);
+	if (containerFileType( path) == ContainerNone) return false;
+	record.path.swap( path);
+	record.offset = offset;
+	record.size = size;
+	return true;
+}
+
+ContainerScanner::ContainerScanner( const std::string& path_, ContainerType type_)
+	:m_path(path_),m_type(type_),m_file(0),m_pos(0),m_recordStart(0),m_recordEmpty(true),m_eof(false),m_errno(0)
+{
+	m_file = ::fopen( m_path.c_str(), "rb");
+	if (!m_file)
+	{
+		m_errno = errno;
+		m_eof = true;
+	}
+}
+
+ContainerScanner::~ContainerScanner()
+{
+	if (m_file) ::fclose( m_file);
+}
+
+bool ContainerScanner::next( std::vector<std::string>& items, std::size_t maxNofRecords)
+{
+	if (m_eof) return false;
+	switch (m_type)
+	{
+		case ContainerJsonLines: return nextJsonLines( items, maxNofRecords);
+		case ContainerTar: return nextTar( items, maxNofRecords);
+		case ContainerNone: break;
+	}
+	m_errno = EINVAL;
+	m_eof = true;
+	return false;
+}
+
+bool ContainerScanner::nextJsonLines( std::vector<std::string>& items, std::size_t maxNofRecords)
+{
+	enum {BufSize=1<<16};
+	char buf[ BufSize];
+	std::size_t nofRecords = 0;
+	while (nofRecords < maxNofRecords)
+	{
+		std::size_t nn = ::fread( buf, 1, sizeof(buf), m_file);
+		if (nn == 0)
+		{
+			if (::ferror( m_file))
+			{
+				m_errno = errno ? errno : EIO;
+			}
+			else if (!m_recordEmpty)
+			{
+				// Last line without end of line:
+				items.push_back( containerRecordItem( m_path, m_recordStart, m_pos - m_recordStart));
+				++nofRecords;
+			}
+			m_eof = true;
+			break;
+		}
+		std::size_t bi = 0;
+		for (; bi < nn && nofRecords < maxNofRecords; ++bi)
+		{
+			char ch = buf[ bi];
+			if (ch == '\n')
+			{
+				if (!m_recordEmpty)
+				{
+					items.push_back( containerRecordItem( m_path, m_recordStart, m_pos + bi - m_recordStart));
+					++nofRecords;
+				}
+				m_recordStart = m_pos + bi + 1;
+				m_recordEmpty = true;
+			}
+			else if (m_recordEmpty && ch != ' ' && ch != '\t' && ch != '\r')
+			{
+				m_recordEmpty = false;
+			}
+		}
+		m_pos += bi;
+		if (bi < nn)
+		{
+			// Continue after the last record fetched in the next call:
+			if (0 != STRUS_FSEEK64( m_file, m_pos, SEEK_SET))
+			{
+				m_errno = errno;
+				m_eof = true;
+			}
+			break;
+		}
+	}
+	return nofRecords > 0 || !m_eof;
+}
+
+enum {TarBlockSize=512};
+
+static bool parseTarNumber( uint64_t& res, const unsigned char* field, std::size_t fieldsize)
+{
+	res = 0;
+	if (field[0] & 0x80)
+	{
+		// GNU base-256 encoding for large files:
+		for (std::size_t fi=1; fi<fieldsize; ++fi)
+		{
+			if (res >> 56) return false;
+			res = (res << 8) | field[ fi];
+		}
+		return true;
+	}
+	std::size_t fi = 0;
+	for (; fi < fieldsize && field[fi] == ' '; ++fi){}
+	for (; fi < fieldsize && field[fi] >= '0' && field[fi] <= '7'; ++fi)
+	{
+		if (res >> 61) return false;
+		res = (res << 3) | (field[ fi] - '0');
+	}
+	for (; fi < fieldsize; ++fi)
+	{
+		if (field[ fi] != ' ' && field[ fi] != '\0') return false;
+	}
+	return true;
+}
+
+static bool isValidTarHeader( const unsigned char* hdr)
+{
+	uint64_t checksum;
+	if (!parseTarNumber( checksum, hdr + 148, 8)) return false;
+	uint64_t sum = 0;
+	for (int hi=0; hi<TarBlockSize; ++hi)
+	{
+		sum += (hi >= 148 && hi < 156) ? ' ' : hdr[ hi];
+	}
+	return sum == checksum;
+}
+
+bool ContainerScanner::nextTar( std::vector<std::string>& items, std::size_t maxNofRecords)
+{
+	unsigned char hdr[ TarBlockSize];
+	std::size_t nofRecords = 0;
+	while (nofRecords < maxNofRecords)
+	{
+		if (0 != STRUS_FSEEK64( m_file, m_pos, SEEK_SET))
+		{
+			m_errno = errno;
+			m_eof = true;
+			break;
+		}
+		std::size_t nn = ::fread( hdr, 1, sizeof(hdr), m_file);
+		if (nn < sizeof(hdr))
+		{
+			if (::ferror( m_file))
+			{
+				m_errno = errno ? errno : EIO;
+			}
+			else if (nn > 0)
+			{
+				m_errno = EINVAL;
+				//... truncated archive
+			}
+			m_eof = true;
+			break;
+		}
+		int hi = 0;
+		for (; hi < TarBlockSize && hdr[ hi] == 0; ++hi){}
+		if (hi == TarBlockSize)
+		{
+			// End of archive marker:
+			m_eof = true;
+			break;
+		}
+		uint64_t size;
+		if (!isValidTarHeader( hdr) || !parseTarNumber( size, hdr + 124, 12))
+		{
+			m_errno = EINVAL;
+			m_eof = true;
+			break;
+		}
+		char typeflag = (char)hdr[ 156];
+		if ((typeflag == '0' || typeflag == '\0' || typeflag == '7') && size > 0)
+		{
+			// Regular file, the other entries (directories, links, extended headers) are skipped:
+			items.push_back( containerRecordItem( m_path, m_pos + TarBlockSize, size));
+			++nofRecords;
+		}
+		m_pos += TarBlockSize + ((size + TarBlockSize - 1) / TarBlockSize) * TarBlockSize;
+	}
+	return nofRecords > 0 || !m_eof;
+}
+
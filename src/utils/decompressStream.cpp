@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Stream decompressing gzip or zstd compressed input, optionally in a background thread
+/// \file decompressStream.cpp
+#include "private/decompressStream.hpp"
+#include "private/versionUtilities.hpp"
+#include "strus/base/local_ptr.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#if STRUS_ZLIB_ENABLED
+#include <zlib.h>
+#endif
+#if STRUS_ZSTD_ENABLED
+#include <zstd.h>
+#endif
+
+using namespace strus;
+using namespace strus::utils;
+
+CompressionType strus::utils::detectCompression( const char* hdr, std::size_t hdrsize)
+{
+	const unsigned char* uh = (const unsigned char*)hdr;
+	if (hdrsize >= 2 && uh[0] == 0x1F && uh[1] == 0x8B) return CompressionGzip;
+	if (hdrsize >= 4 && uh[0] == 0x28 && uh[1] == 0xB5 && uh[2] == 0x2F && uh[3] == 0xFD) return CompressionZstd;
+	return CompressionNone;
+}
+
+/// \brief Decoder of a compressed file, reading the input in blocks
+class strus::utils::Decoder
+{
+public:
+	Decoder( FILE* file_, uint64_t size_, CompressionType type_)
+		:m_file(file_),m_remaining(size_),m_type(type_),m_inputEnd(false),m_streamOpen(false),m_eof(false),m_errno(0)
+	{
+		switch (m_type)
+		{
+			case CompressionNone:
+				break;
+			case CompressionGzip:
+#if STRUS_ZLIB_ENABLED
+				std::memset( &m_zs, 0, sizeof(m_zs));
+				// window bits 15 + 16 for decoding gzip headers:
+				if (Z_OK != ::inflateInit2( &m_zs, 15 + 16))
+				{
+					m_errno = ENOMEM;
+					m_eof = true;
+				}
+				return;
+#else
+				break;
+#endif
+			case CompressionZstd:
+#if STRUS_ZSTD_ENABLED
+				m_inpos = 0;
+				m_insize = 0;
+				m_zds = ::ZSTD_createDStream();
+				if (!m_zds || ::ZSTD_isError( ::ZSTD_initDStream( m_zds)))
+				{
+					m_errno = ENOMEM;
+					m_eof = true;
+				}
+				return;
+#else
+				break;
+#endif
+		}
+		m_errno = ENOTSUP;
+		m_eof = true;
+	}
+
+	~Decoder()
+	{
+#if STRUS_ZLIB_ENABLED
+		if (m_type == CompressionGzip) ::inflateEnd( &m_zs);
+#endif
+#if STRUS_ZSTD_ENABLED
+		if (m_type == CompressionZstd && m_zds) ::ZSTD_freeDStream( m_zds);
+#endif
+		::fclose( m_file);
+	}
+
+	/// \brief Decompress data
+	/// \return the number of bytes written to out, less than outsize only at the end of the data or on error
+	std::size_t decode( char* out, std::size_t outsize)
+	{
+		if (m_eof) return 0;
+		switch (m_type)
+		{
+			case CompressionNone: break;
+			case CompressionGzip: return decodeGzip( out, outsize);
+			case CompressionZstd: return decodeZstd( out, outsize);
+		}
+		return 0;
+	}
+
+	int error() const
+	{
+		return m_errno;
+	}
+
+private:
+	std::size_t fillInput()
+	{
+		std::size_t toread = m_remaining < (uint64_t)sizeof(m_inbuf) ? (std::size_t)m_remaining : sizeof(m_inbuf);
+		std::size_t nn = toread ? ::fread( m_inbuf, 1, toread, m_file) : 0;
+		if (nn < toread && ::ferror( m_file))
+		{
+			m_errno = errno ? errno : EIO;
+		}
+		m_remaining -= nn;
+		return nn;
+	}
+
+	std::size_t decodeGzip( char* out, std::size_t outsize)
+	{
+#if STRUS_ZLIB_ENABLED
+		m_zs.next_out = (Bytef*)out;
+		m_zs.avail_out = outsize;
+		while (m_zs.avail_out > 0)
+		{
+			if (m_zs.avail_in == 0 && !m_inputEnd)
+			{
+				std::size_t nn = fillInput();
+				if (nn == 0)
+				{
+					m_inputEnd = true;
+				}
+				else
+				{
+					m_zs.next_in = (Bytef*)m_inbuf;
+					m_zs.avail_in = nn;
+				}
+			}
+			if (m_errno || (m_inputEnd && m_zs.avail_in == 0 && !m_streamOpen))
+			{
+				m_eof = true;
+				break;
+			}
+			int rc = ::inflate( &m_zs, Z_NO_FLUSH);
+			if (rc == Z_STREAM_END)
+			{
+				// Continue with the next member of the file, if there is one:
+				m_streamOpen = false;
+				::inflateReset( &m_zs);
+			}
+			else if (rc == Z_OK || (rc == Z_BUF_ERROR && !m_inputEnd))
+			{
+				m_streamOpen = true;
+			}
+			else
+			{
+				// Corrupt or truncated data:
+				m_errno = (rc == Z_MEM_ERROR) ? ENOMEM : EINVAL;
+				m_eof = true;
+				break;
+			}
+		}
+		return outsize - m_zs.avail_out;
+#else
+		return 0;
+#endif
+	}
+
+	std::size_t decodeZstd( char* out, std::size_t outsize)
+	{
+#if STRUS_ZSTD_ENABLED
+		ZSTD_outBuffer ob;
+		ob.dst = out;
+		ob.size = outsize;
+		ob.pos = 0;
+		while (ob.pos < ob.size)
+		{
+			if (m_inpos == m_insize && !m_inputEnd)
+			{
+				m_insize = fillInput();
+				m_inpos = 0;
+				if (m_insize == 0) m_inputEnd = true;
+			}
+			if (m_errno || (m_inputEnd && m_inpos == m_insize && !m_streamOpen))
+			{
+				m_eof = true;
+				break;
+			}
+			ZSTD_inBuffer ib;
+			ib.src = m_inbuf;
+			ib.size = m_insize;
+			ib.pos = m_inpos;
+			std::size_t prevpos = ob.pos;
+			std::size_t rc = ::ZSTD_decompressStream( m_zds, &ob, &ib);
+			if (::ZSTD_isError( rc) || (m_inputEnd && ob.pos == prevpos && rc != 0))
+			{
+				// Corrupt or truncated data:
+				m_errno = EINVAL;
+				m_eof = true;
+				break;
+			}
+			m_inpos = ib.pos;
+			m_streamOpen = (rc != 0);
+			//... rc is 0 at the end of a frame, continue with the next frame, if there is one
+		}
+		return ob.pos;
+#else
+		return 0;
+#endif
+	}
+
+private:
+	FILE* m_file;
+	uint64_t m_remaining;
+	CompressionType m_type;
+	char m_inbuf[ 1<<16];
+	bool m_inputEnd;		///< true, if all compressed data has been read from the file
+	bool m_streamOpen;		///< true, if a gzip member or zstd frame has been started and not finished
+	bool m_eof;
+	int m_errno;
+#if STRUS_ZLIB_ENABLED
+	z_stream m_zs;
+#endif
+#if STRUS_ZSTD_ENABLED
+	ZSTD_DStream* m_zds;
+	std::size_t m_inpos;
+	std::size_t m_insize;
+#endif
+};
+
+DecompressStream::DecompressStream( FILE* file, uint64_t size, CompressionType type, bool background)
+	:m_decoder(0),m_blocks(),m_blockpos(0),m_finished(false),m_terminated(false),m_errno(0),m_thread()
+{
+	strus::local_ptr<Decoder> decoder;
+	try
+	{
+		decoder.reset( new Decoder( file, size, type));
+	}
+	catch (const std::bad_alloc&)
+	{
+		::fclose( file);
+		m_errno = ENOMEM;
+		return;
+	}
+	// The decoder is owned by the local pointer till the construction cannot fail anymore:
+	m_decoder = decoder.get();
+	if (m_decoder->error())
+	{
+		m_errno = m_decoder->error();
+	}
+	else if (background)
+	{
+		m_thread.reset( new strus::thread( &DecompressStream::decoderThreadMain, this));
+	}
+	decoder.release();
+}
+
+DecompressStream::~DecompressStream()
+{
+	if (m_thread.get())
+	{
+		{
+			strus::scoped_lock lock( m_mutex);
+			m_terminated = true;
+		}
+		m_cond_notFull.notify_all();
+		m_thread->join();
+	}
+	delete m_decoder;
+}
+
+void DecompressStream::decoderThreadMain()
+{
+	try
+	{
+		std::size_t nn = BlockSize;
+		while (nn == BlockSize)
+		{
+			std::string block( BlockSize, '\0');
+			nn = m_decoder->decode( const_cast<char*>(block.c_str()), BlockSize);
+			block.resize( nn);
+			{
+				strus::unique_lock lock( m_mutex);
+				while (m_blocks.size() >= MaxNofBlocks && !m_terminated)
+				{
+					m_cond_notFull.wait( lock);
+				}
+				if (m_terminated) break;
+				if (nn)
+				{
+					m_blocks.push_back( std::string());
+					m_blocks.back().swap( block);
+				}
+				if (nn < BlockSize)
+				{
+					m_errno = m_decoder->error();
+					m_finished = true;
+				}
+			}
+			m_cond_notEmpty.notify_one();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		{
+			strus::scoped_lock lock( m_mutex);
+			m_errno = ENOMEM;
+			m_finished = true;
+		}
+		m_cond_notEmpty.notify_one();
+	}
+}
+
+std::size_t DecompressStream::read( char* buf, std::size_t bufsize)
+{
+	if (!m_thread.get())
+	{
+		if (!m_decoder || m_errno) return 0;
+		std::size_t rt = m_decoder->decode( buf, bufsize);
+		m_errno = m_decoder->error();
+		return rt;
+	}
+	std::size_t rt = 0;
+	{
+		strus::unique_lock lock( m_mutex);
+		while (rt < bufsize)
+		{
+			while (m_blocks.empty() && !m_finished)
+			{
+				m_cond_notEmpty.wait( lock);
+			}
+			if (m_blocks.empty()) break;
+
+			const std::string& block = m_blocks.front();
+			std::size_t nn = block.size() - m_blockpos;
+			if (nn > bufsize - rt) nn = bufsize - rt;
+			std::memcpy( buf + rt, block.c_str() + m_blockpos, nn);
+			rt += nn;
+			m_blockpos += nn;
+			if (m_blockpos == block.size())
+			{
+				m_blocks.pop_front();
+				m_blockpos = 0;
+				m_cond_notFull.notify_one();
+			}
+		}
+	}
+	return rt;
+}
+
+int DecompressStream::error() const
+{
+	if (!m_thread.get()) return m_errno;
+	strus::scoped_lock lock( m_mutex);
+	return m_blocks.empty() ? m_errno : 0;
+	//... an error of the background thread is reported after the data decompressed before has been read
+}
+
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache of the document classes detected per directory and file extension
+/// \file documentClassCache.cpp
+#include "private/documentClassCache.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/documentClassDetectorInterface.hpp"
+#include "strus/base/programOptions.hpp"
+
+using namespace strus;
+
+DocumentClassCache::DocumentClassCache( int stableCount_, int sampleRate_)
+	:m_map(),m_stableCount(stableCount_ > 0 ? stableCount_ : 1),m_sampleRate(sampleRate_ > 0 ? sampleRate_ : 0)
+	,m_nofHits(0),m_nofDetections(0)
+{}
+
+std::string DocumentClassCache::key( const std::string& filename)
+{
+#if defined _WIN32
+	std::size_t dirend = filename.find_last_of( "/\\");
+#else
+	std::size_t dirend = filename.rfind( '/');
+#endif
+	std::size_t namestart = dirend == std::string::npos ? 0 : dirend+1;
+	std::size_t extstart = filename.rfind( '.');
+	std::string rt( filename, 0, namestart);
+	rt.push_back( '\0');
+	if (extstart != std::string::npos && extstart > namestart)
+	{
+		rt.append( filename, extstart, std::string::npos);
+	}
+	return rt;
+}
+
+static bool isEqualDocumentClass( const analyzer::DocumentClass& a, const analyzer::DocumentClass& b)
+{
+	return a.mimeType() == b.mimeType() && a.schema() == b.schema() && a.encoding() == b.encoding();
+}
+
+bool DocumentClassCache::get( analyzer::DocumentClass& dclass, const std::string& filename)
+{
+	std::string kk( key( filename));
+	strus::scoped_lock lock( m_mutex);
+	std::map<std::string,Entry>::iterator ei = m_map.find( kk);
+	if (ei == m_map.end() || ei->second.count < m_stableCount) return false;
+	++ei->second.hits;
+	if (m_sampleRate && ei->second.hits % m_sampleRate == 0)
+	{
+		//... validate the class cached by detecting this file
+		return false;
+	}
+	dclass = ei->second.dclass;
+	++m_nofHits;
+	return true;
+}
+
+void DocumentClassCache::put( const std::string& filename, const analyzer::DocumentClass& dclass)
+{
+	std::string kk( key( filename));
+	strus::scoped_lock lock( m_mutex);
+	++m_nofDetections;
+	Entry& entry = m_map[ kk];
+	if (entry.count && isEqualDocumentClass( entry.dclass, dclass))
+	{
+		if (entry.count < m_stableCount) ++entry.count;
+	}
+	else
+	{
+		// New class or a validation failed, start counting again:
+		entry.dclass = dclass;
+		entry.count = 1;
+		entry.hits = 0;
+	}
+}
+
+void DocumentClassCache::invalidate( const std::string& filename)
+{
+	std::string kk( key( filename));
+	strus::scoped_lock lock( m_mutex);
+	++m_nofDetections;
+	std::map<std::string,Entry>::iterator ei = m_map.find( kk);
+	if (ei != m_map.end())
+	{
+		m_map.erase( ei);
+	}
+}
+
+DocumentClassCache* strus::createDocumentClassCache( const ProgramOptions& opt)
+{
+	if (opt("detectcache"))
+	{
+		int stableCount = opt.asUint( "detectcache");
+		if (stableCount == 0) throw strus::runtime_error(_TXT("value of option %s must be greater than 0"), "--detectcache");
+		int sampleRate = opt("detectsample") ? opt.asUint( "detectsample") : 100;
+		return new DocumentClassCache( stableCount, sampleRate);
+	}
+	else if (opt("detectsample"))
+	{
+		throw strus::runtime_error(_TXT("option %s specified without option %s"), "--detectsample", "--detectcache");
+	}
+	return 0;
+}
+
+void strus::printDocumentClassCacheUsage( std::ostream& out)
+{
+	out << "--detectcache <K>" << std::endl;
+	out << "    " << _TXT("Cache the document class detected per directory and file extension and") << std::endl;
+	out << "    " << _TXT("skip the detection after <K> files in a row were detected with the same class") << std::endl;
+	out << "--detectsample <N>" << std::endl;
+	out << "    " << _TXT("Detect every <N>-th file resolved by the detection cache to validate the") << std::endl;
+	out << "    " << _TXT("class cached (default 100, 0 for no validation, with --detectcache only)") << std::endl;
+}
+
+bool strus::getCachedDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename)
+{
+	return cache && cache->get( dclass, filename);
+}
+
+static bool reportDetection( DocumentClassCache* cache, bool detected, const analyzer::DocumentClass& dclass, const std::string& filename)
+{
+	if (cache)
+	{
+		if (detected)
+		{
+			cache->put( filename, dclass);
+		}
+		else
+		{
+			cache->invalidate( filename);
+		}
+	}
+	return detected;
+}
+
+bool strus::detectDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename,
+				const TextProcessorInterface* textproc, const char* content, std::size_t contentsize, bool isComplete)
+{
+	bool detected = textproc->detectDocumentClass( dclass, content, contentsize, isComplete);
+	return reportDetection( cache, detected, dclass, filename);
+}
+
+bool strus::detectDocumentClass( DocumentClassCache* cache, analyzer::DocumentClass& dclass, const std::string& filename,
+				const DocumentClassDetectorInterface* detector, const char* content, std::size_t contentsize, bool isComplete)
+{
+	bool detected = detector->detect( dclass, content, contentsize, isComplete);
+	return reportDetection( cache, detected, dclass, filename);
+}
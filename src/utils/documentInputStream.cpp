@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Input stream for reading a document from a file or from a record of a container file, decompressing gzip or zstd compressed input
+/// \file documentInputStream.cpp
+#include "private/documentInputStream.hpp"
+#include <cerrno>
+#include <cstring>
+#if defined _WIN32
+#define STRUS_FSEEK64 _fseeki64
+#define STRUS_FTELL64 _ftelli64
+#else
+#include <sys/types.h>
+#define STRUS_FSEEK64 fseeko
+#define STRUS_FTELL64 ftello
+#endif
+
+using namespace strus;
+using namespace strus::utils;
+
+DocumentInputStream::DocumentInputStream( const std::string& item, bool containerItems)
+	:m_input(),m_file(0),m_decompress(),m_remaining(0),m_ahead(),m_errno(0)
+{
+	ContainerRecord record;
+	if (!containerItems || !parseContainerRecordItem( record, item))
+	{
+		m_input.reset( new strus::InputStream( item));
+		if (item == "-") return;
+		//... compressed input from stdin is not supported
+
+		char hdr[ CompressionMagicSize];
+		std::size_t hdrsize = m_input->readAhead( hdr, sizeof(hdr));
+		CompressionType compression = detectCompression( hdr, hdrsize);
+		if (compression == CompressionNone) return;
+
+		// Reopen the compressed file for decompressing it:
+		m_input.reset();
+		m_file = ::fopen( item.c_str(), "rb");
+		if (!m_file)
+		{
+			m_errno = errno;
+			return;
+		}
+		uint64_t filesize = 0;
+		if (0 == STRUS_FSEEK64( m_file, 0, SEEK_END))
+		{
+			filesize = STRUS_FTELL64( m_file);
+		}
+		if (0 != STRUS_FSEEK64( m_file, 0, SEEK_SET))
+		{
+			m_errno = errno;
+			return;
+		}
+		openDecompressStream( filesize, compression);
+		return;
+	}
+	m_file = ::fopen( record.path.c_str(), "rb");
+	if (!m_file)
+	{
+		m_errno = errno;
+		return;
+	}
+	if (0 != STRUS_FSEEK64( m_file, record.offset, SEEK_SET))
+	{
+		m_errno = errno;
+		return;
+	}
+	m_remaining = record.size;
+
+	// Check if the record is compressed (e.g. a compressed file in a tar archive):
+	char hdr[ CompressionMagicSize];
+	std::size_t hdrsize = readRecord( hdr, sizeof(hdr));
+	if (m_errno) return;
+	CompressionType compression = detectCompression( hdr, hdrsize);
+	if (compression == CompressionNone)
+	{
+		m_ahead.append( hdr, hdrsize);
+		return;
+	}
+	if (0 != STRUS_FSEEK64( m_file, record.offset, SEEK_SET))
+	{
+		m_errno = errno;
+		return;
+	}
+	openDecompressStream( record.size, compression);
+}
+
+DocumentInputStream::~DocumentInputStream()
+{
+	if (m_file) ::fclose( m_file);
+}
+
+void DocumentInputStream::openDecompressStream( uint64_t size, CompressionType compression)
+{
+	FILE* file = m_file;
+	m_file = 0;
+	m_decompress.reset( new DecompressStream( file/*ownership*/, size, compression, size >= (uint64_t)BackgroundDecompressMinSize));
+}
+
+int DocumentInputStream::error() const
+{
+	if (m_input.get()) return m_input->error();
+	if (m_errno) return m_errno;
+	return m_decompress.get() ? m_decompress->error() : 0;
+}
+
+std::size_t DocumentInputStream::readRecord( char* buf, std::size_t bufsize)
+{
+	if (m_errno) return 0;
+	std::size_t toread = m_remaining < (uint64_t)bufsize ? (std::size_t)m_remaining : bufsize;
+	if (toread == 0) return 0;
+	std::size_t nn = ::fread( buf, 1, toread, m_file);
+	if (nn < toread)
+	{
+		m_errno = ::ferror( m_file) ? (errno ? errno : EIO) : EINVAL;
+		//... EINVAL if the record exceeds the end of the file
+	}
+	m_remaining -= nn;
+	return nn;
+}
+
+std::size_t DocumentInputStream::readSource( char* buf, std::size_t bufsize)
+{
+	if (m_decompress.get()) return m_decompress->read( buf, bufsize);
+	return readRecord( buf, bufsize);
+}
+
+std::size_t DocumentInputStream::readAhead( char* buf, std::size_t bufsize)
+{
+	if (m_input.get()) return m_input->readAhead( buf, bufsize);
+	if (m_ahead.size() < bufsize)
+	{
+		std::size_t aheadsize = m_ahead.size();
+		m_ahead.resize( bufsize);
+		std::size_t nn = readSource( const_cast<char*>(m_ahead.c_str()) + aheadsize, bufsize - aheadsize);
+		m_ahead.resize( aheadsize + nn);
+	}
+	std::size_t rt = m_ahead.size() < bufsize ? m_ahead.size() : bufsize;
+	std::memcpy( buf, m_ahead.c_str(), rt);
+	return rt;
+}
+
+std::size_t DocumentInputStream::read( char* buf, std::size_t bufsize)
+{
+	if (m_input.get()) return m_input->read( buf, bufsize);
+	std::size_t rt = 0;
+	if (!m_ahead.empty())
+	{
+		rt = m_ahead.size() < bufsize ? m_ahead.size() : bufsize;
+		std::memcpy( buf, m_ahead.c_str(), rt);
+		m_ahead.erase( 0, rt);
+	}
+	if (rt < bufsize)
+	{
+		rt += readSource( buf + rt, bufsize - rt);
+	}
+	return rt;
+}
+
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "private/jsonUtils.hpp"
+
+using namespace strus;
+using namespace strus::utils;
+
+void strus::utils::printJsonString( FILE* out, const std::string& str)
+{
+	::fputc( '"', out);
+	std::string::const_iterator ci = str.begin(), ce = str.end();
+	for (; ci != ce; ++ci)
+	{
+		if (*ci == '"' || *ci == '\\')
+		{
+			::fputc( '\\', out);
+			::fputc( *ci, out);
+		}
+		else if ((unsigned char)*ci < 32)
+		{
+			::fprintf( out, "\\u%04x", (unsigned int)(unsigned char)*ci);
+		}
+		else
+		{
+			::fputc( *ci, out);
+		}
+	}
+	::fputc( '"', out);
+}
+
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapped file for reading input files without copying them into buffers
+/// \file mappedFile.cpp
+#include "private/mappedFile.hpp"
+#include <cerrno>
+#if defined _WIN32
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace strus;
+using namespace strus::utils;
+
+#if defined _WIN32
+MappedFile::MappedFile( const std::string& filename)
+	:m_ptr(0),m_size(0),m_errno(ENOSYS)
+{}
+
+MappedFile::~MappedFile()
+{}
+
+#else
+MappedFile::MappedFile( const std::string& filename)
+	:m_ptr(0),m_size(0),m_errno(0)
+{
+	int fd = ::open( filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		m_errno = errno;
+		return;
+	}
+	struct stat st;
+	if (0 != ::fstat( fd, &st))
+	{
+		m_errno = errno;
+		::close( fd);
+		return;
+	}
+	if (!S_ISREG( st.st_mode))
+	{
+		m_errno = EINVAL;
+		::close( fd);
+		return;
+	}
+	m_size = st.st_size;
+	if (m_size)
+	{
+		void* mem = ::mmap( 0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mem == MAP_FAILED)
+		{
+			m_errno = errno;
+			m_size = 0;
+		}
+		else
+		{
+			m_ptr = (const char*)mem;
+#if defined(MADV_SEQUENTIAL)
+			(void)::madvise( mem, m_size, MADV_SEQUENTIAL);
+			//... only a hint, failure does not matter
+#endif
+		}
+	}
+	::close( fd);
+	//... the mapping stays valid after closing the file descriptor
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_ptr)
+	{
+		::munmap( (void*)const_cast<char*>(m_ptr), m_size);
+	}
+}
+#endif
+
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "private/orderedResultBuffer.hpp"
+
+using namespace strus;
+using namespace strus::utils;
+
+OrderedResultBuffer::OrderedResultBuffer( std::size_t nofItems_, std::size_t maxNofPending_)
+	:m_nofItems(nofItems_),m_maxNofPending(maxNofPending_ ? maxNofPending_ : 1)
+	,m_nextFetch(0),m_nextPop(0),m_results(),m_terminated(false)
+{}
+
+bool OrderedResultBuffer::fetch( std::size_t& itemidx)
+{
+	strus::unique_lock lock( m_mutex);
+	while (!m_terminated && m_nextFetch < m_nofItems && m_nextFetch >= m_nextPop + m_maxNofPending)
+	{
+		m_cond_fetch.wait( lock);
+	}
+	if (m_terminated || m_nextFetch >= m_nofItems) return false;
+	itemidx = m_nextFetch++;
+	return true;
+}
+
+void OrderedResultBuffer::push( std::size_t itemidx, const std::string& content, const std::string& error)
+{
+	strus::scoped_lock lock( m_mutex);
+	Result& rs = m_results[ itemidx];
+	rs.content = content;
+	rs.error = error;
+	if (itemidx == m_nextPop) m_cond_pop.notify_one();
+}
+
+bool OrderedResultBuffer::pop( std::string& content, std::string& error)
+{
+	strus::unique_lock lock( m_mutex);
+	if (m_nextPop >= m_nofItems) return false;
+	ResultMap::iterator ri;
+	while (!m_terminated && (ri = m_results.find( m_nextPop)) == m_results.end())
+	{
+		m_cond_pop.wait( lock);
+	}
+	if (m_terminated) return false;
+	content.swap( ri->second.content);
+	error.swap( ri->second.error);
+	m_results.erase( ri);
+	++m_nextPop;
+	m_cond_fetch.notify_all();
+	return true;
+}
+
+void OrderedResultBuffer::terminate()
+{
+	strus::scoped_lock lock( m_mutex);
+	m_terminated = true;
+	m_cond_fetch.notify_all();
+	m_cond_pop.notify_all();
+}
+
@@ -52,6 +52,7 @@ static ProgramPath g_prgpathmap[] =
 	{"StrusDumpStatistics", "strusDumpStatistics"},
 	{"StrusPatternMatcher", "strusPatternMatcher"},
 	{"StrusQuery", "strusQuery"},
+	{"StrusBenchmarkQuery", "strusBenchmarkQuery"},
 	{"StrusCreate", "strusCreate"},
 	{"StrusCheckStorage", "strusCheckStorage"},
 	{"StrusHelp", "strusHelp"},
@@ -63,6 +64,7 @@ static ProgramPath g_prgpathmap[] =
 	{"StrusCreateVectorStorage", "strusCreateVectorStorage"},
 	{"StrusCheckInsert", "strusCheckInsert"},
 	{"StrusGenerateKeyMap", "strusGenerateKeyMap"},
+	{"StrusBenchmarkDocumentAlloc", "strusBenchmarkDocumentAlloc"},
 	{"StrusInsert", "strusInsert"},
 	{"StrusInspect", "strusInspect"},
 	{"StrusSegment", "strusSegment"},